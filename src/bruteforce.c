@@ -16,6 +16,12 @@
 #include <string.h>  // strchr
 #include <stdlib.h>  // atext
 #include <getopt.h>  // getopt_long
+#include <fcntl.h>   // open, O_RDONLY
+#include <unistd.h>  // pread, geteuid
+#include <time.h>    // clock_gettime, CLOCK_MONOTONIC
+#include <signal.h>  // signal, SIGINT, SIGTERM
+#include <errno.h>   // errno, ENOENT
+#include <limits.h>  // PATH_MAX
 
 #include "error.c"        // src
 #include "ec.c"           // src
@@ -24,6 +30,10 @@
 #include "memory.c"       // src
 #include "model_config.c" // src
 #include "nxjson.c"       // src
+#include "log.c"          // src
+#include "stack_memory.c" // src
+#include "trace.c"        // src
+#include "file_utils.c"   // src
 
 static EC_VTable*   ec;
 static volatile int quit;
@@ -35,10 +45,17 @@ static const struct option long_options[] = {
   {"bruteforce-registers",  required_argument, 0, 'b'},
   {"bruteforce-values",     required_argument, 0, 'v'},
   {"sleep",                 required_argument, 0, 's'},
+  {"read-register",         required_argument, 0, 'r'},
+  {"read-word",             no_argument,       0, 'w'},
+  {"hwmon-fan",             required_argument, 0, 'H'},
+  {"min-delta",             required_argument, 0, 'd'},
+  {"timeout",               required_argument, 0, 't'},
+  {"checkpoint",            required_argument, 0, 'c'},
+  {"prune",                 no_argument,       0, 'p'},
   {0,                       0,                 0,  0 }
 };
 
-static const char options_str[] = "e:f:F:b:v:s:";
+static const char options_str[] = "e:f:F:b:v:s:r:wH:d:t:c:p";
 
 static struct {
   float         sleep;
@@ -46,17 +63,46 @@ static struct {
   array_of(int) fan_values;
   array_of(int) bruteforce_registers;
   array_of(int) bruteforce_values;
+  int           read_register;
+  bool          read_word;
+  const char*   hwmon_fan;
+  int           min_delta;
+  float         timeout;
+  const char*   checkpoint;
+  bool          prune;
 } options = {
   0.5,
   -1,
   {NULL, 0},
   {NULL, 0},
-  {NULL, 0}
+  {NULL, 0},
+  -1,
+  false,
+  NULL,
+  -1,
+  3,
+  NULL,
+  false,
+};
+
+// A combination that changed the fan speed reading
+struct BruteforceResult {
+  int register_;
+  int value;
+  int fan_value;
+  int baseline;
+  int reading;
 };
+typedef struct BruteforceResult BruteforceResult;
+declare_array_of(BruteforceResult);
+
+static array_of(BruteforceResult) results = {NULL, 0};
 
 static int  expand_ints(const char*, array_of(int)*);
 static void reset_embedded_controller();
 static void bruteforce();
+static bool Feedback_Enabled();
+static void Handle_Signal(int);
 
 int main(int argc, char* const argv[]) {
   Program_Name_Set(argv[0]);
@@ -115,6 +161,39 @@ int main(int argc, char* const argv[]) {
         return NBFC_EXIT_CMDLINE;
       }
       break;
+    case 'r':
+      options.read_register = parse_number(optarg, 0, 255, &err);
+      if (err) {
+        Log_Error("-r|--read-register: %s\n", err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
+    case 'w':
+      options.read_word = true;
+      break;
+    case 'H':
+      options.hwmon_fan = optarg;
+      break;
+    case 'd':
+      options.min_delta = parse_number(optarg, 1, 65535, &err);
+      if (err) {
+        Log_Error("-d|--min-delta: %s\n", err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
+    case 't':
+      options.timeout = parse_double(optarg, 0.1, 100, &err);
+      if (err) {
+        Log_Error("Invalid value for -t|--timeout: %s\n", optarg);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
+    case 'c':
+      options.checkpoint = optarg;
+      break;
+    case 'p':
+      options.prune = true;
+      break;
     default:
       return NBFC_EXIT_CMDLINE;
     }
@@ -140,6 +219,15 @@ int main(int argc, char* const argv[]) {
     return NBFC_EXIT_CMDLINE;
   }
 
+  if (options.read_register >= 0 && options.hwmon_fan) {
+    Log_Error("Options -r|--read-register and -H|--hwmon-fan are mutually exclusive\n");
+    return NBFC_EXIT_CMDLINE;
+  }
+
+  // RPM readings are noisy, register readings usually are not
+  if (options.min_delta == -1)
+    options.min_delta = (options.hwmon_fan ? 200 : 1);
+
   if (geteuid()) {
     Log_Error("This program must be run as root\n");
     return NBFC_EXIT_FAILURE;
@@ -153,10 +241,17 @@ int main(int argc, char* const argv[]) {
   Error* e = ec->Open();
   e_die();
 
+  signal(SIGINT,  Handle_Signal);
+  signal(SIGTERM, Handle_Signal);
+
   atexit(reset_embedded_controller);
   bruteforce();
 }
 
+static void Handle_Signal(int sig) {
+  quit = sig;
+}
+
 static int expand_ints(const char* s, array_of(int)* array) {
   const char* err;
 
@@ -235,6 +330,363 @@ static void reset_embedded_controller() {
     ec->WriteByte(state.brutefoce_register, state.bruteforce_register_oldvalue);
 }
 
+// ============================================================================
+// Feedback
+// ============================================================================
+
+#define Feedback_PollInterval  100  // Milliseconds
+#define Feedback_SettleTime    1000 // Milliseconds the reading has to stay stable
+
+static int Feedback_Fd = -1;
+
+static bool Feedback_Enabled() {
+  return options.read_register >= 0 || options.hwmon_fan;
+}
+
+static Error* Feedback_Open() {
+  if (options.hwmon_fan) {
+    Feedback_Fd = open(options.hwmon_fan, O_RDONLY);
+    if (Feedback_Fd < 0)
+      return err_stdlib(0, options.hwmon_fan);
+  }
+
+  return err_success();
+}
+
+static Error* Feedback_Read(int* out) {
+  Error* e;
+
+  if (options.hwmon_fan) {
+    char buf[32];
+    const ssize_t nread = pread(Feedback_Fd, buf, sizeof(buf) - 1, 0);
+    if (nread <= 0)
+      return err_stdlib(0, options.hwmon_fan);
+    buf[nread] = '\0';
+    *out = strtol(buf, NULL, 10);
+  }
+  else if (options.read_word) {
+    uint16_t word;
+    e = ec->ReadWord(options.read_register, &word);
+    e_check();
+    *out = word;
+  }
+  else {
+    uint8_t byte;
+    e = ec->ReadByte(options.read_register, &byte);
+    e_check();
+    *out = byte;
+  }
+
+  return err_success();
+}
+
+static uint64_t Feedback_Now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Poll the reading until it stays within `min_delta` for `Feedback_SettleTime`.
+// If `baseline` is given, the reading also has to differ from it by `min_delta`.
+// Gives up after `options.timeout` seconds, `*settled` tells if it succeeded.
+static Error* Feedback_Settle(const int* baseline, int* reading, bool* settled) {
+  const uint64_t deadline = Feedback_Now() + options.timeout * 1000;
+  uint64_t stable_since = 0;
+  int first = 0;
+
+  *settled = false;
+
+  for (;;) {
+    Error* e = Feedback_Read(reading);
+    e_check();
+
+    const uint64_t now = Feedback_Now();
+    const bool responded = (!baseline || abs(*reading - *baseline) >= options.min_delta);
+
+    if (! responded)
+      stable_since = 0;
+    else if (! stable_since || abs(*reading - first) >= options.min_delta) {
+      stable_since = now;
+      first = *reading;
+    }
+    else if (now - stable_since >= Feedback_SettleTime) {
+      *settled = true;
+      return err_success();
+    }
+
+    if (now >= deadline || quit)
+      return err_success();
+
+    sleep_ms(Feedback_PollInterval);
+  }
+}
+
+// ============================================================================
+// Checkpoint
+// ============================================================================
+
+/*
+ * The checkpoint is a text file which is rewritten after every register/value
+ * combination:
+ *
+ *   fan_register 80
+ *   fan_values 10,20
+ *   registers 30,31,32
+ *   values 4,5,6
+ *   read_register 90        (-1 if not given)
+ *   read_word 0
+ *   hwmon_fan /sys/...      (empty if not given)
+ *   min_delta 1
+ *   timeout 3000            (milliseconds)
+ *   prune 1
+ *   position 1 2            (index of the next register and value)
+ *   original 64 12          (original value of the fan register and of the
+ *                            register being bruteforced, -1 if none)
+ *   skip 31                 (only present after a scan)
+ *   result 30 5 10 30 100   (register value fan_value baseline reading)
+ */
+
+static struct {
+  int  next_register;      // Index into options.bruteforce_registers
+  int  next_value;         // Index into options.bruteforce_values
+  int  fan_original;       // Original values from the checkpoint, -1 if unknown.
+  int  register_original;  // After a crash the EC holds bruteforced values.
+  bool scanned;
+  bool skip[256];
+} progress = {0, 0, -1, -1, false, {0}};
+
+static void Checkpoint_WriteInts(FILE* fh, const char* key, const int* values, int size) {
+  fprintf(fh, "%s ", key);
+  for (int i = 0; i < size; ++i)
+    fprintf(fh, i ? ",%d" : "%d", values[i]);
+  fprintf(fh, "\n");
+}
+
+#define Checkpoint_Options 10 // Lines describing the options
+
+static int Checkpoint_Timeout() {
+  return options.timeout * 1000 + 0.5;
+}
+
+static Error* Checkpoint_Save() {
+  char* content = NULL;
+  size_t size = 0;
+
+  FILE* fh = open_memstream(&content, &size);
+  if (! fh)
+    return err_stdlib(0, "open_memstream()");
+
+  fprintf(fh, "fan_register %d\n", options.fan_register);
+  Checkpoint_WriteInts(fh, "fan_values", options.fan_values.data, options.fan_values.size);
+  Checkpoint_WriteInts(fh, "registers", options.bruteforce_registers.data, options.bruteforce_registers.size);
+  Checkpoint_WriteInts(fh, "values", options.bruteforce_values.data, options.bruteforce_values.size);
+  fprintf(fh, "read_register %d\n", options.read_register);
+  fprintf(fh, "read_word %d\n", options.read_word);
+  fprintf(fh, "hwmon_fan %s\n", options.hwmon_fan ? options.hwmon_fan : "");
+  fprintf(fh, "min_delta %d\n", options.min_delta);
+  fprintf(fh, "timeout %d\n", Checkpoint_Timeout());
+  fprintf(fh, "prune %d\n", options.prune);
+  fprintf(fh, "position %d %d\n", progress.next_register, progress.next_value);
+  fprintf(fh, "original %d %d\n", state.fan_register_oldvalue,
+    state.brutefoce_register >= 0 ? state.bruteforce_register_oldvalue : -1);
+
+  if (progress.scanned) {
+    int skip[256], n_skip = 0;
+    for (int i = 0; i < 256; ++i)
+      if (progress.skip[i])
+        skip[n_skip++] = i;
+    Checkpoint_WriteInts(fh, "skip", skip, n_skip);
+  }
+
+  for_each_array(BruteforceResult*, r, results)
+    fprintf(fh, "result %d %d %d %d %d\n", r->register_, r->value, r->fan_value, r->baseline, r->reading);
+
+  // The checkpoint survives a crash of the machine, which is not unlikely
+  // while writing random registers
+  Error* e = NULL;
+  if (fclose(fh))
+    e = err_stdlib(0, "open_memstream()");
+  else if (write_file_atomic(options.checkpoint, 0644, content, size) == -1)
+    e = err_stdlib(0, options.checkpoint);
+
+  free(content);
+  return e;
+}
+
+static bool Checkpoint_IntsEqual(const char* list, const array_of(int)* expected) {
+  array_of(int) values = {NULL, 0};
+  bool equal = expand_ints(list, &values) && values.size == expected->size &&
+    (!values.size || !memcmp(values.data, expected->data, values.size * sizeof(int)));
+  Mem_Free(values.data);
+  return equal;
+}
+
+// Load the checkpoint if it exists. It must have been made with the same options.
+static Error* Checkpoint_Load() {
+  FILE* fh = fopen(options.checkpoint, "r");
+  if (! fh)
+    return (errno == ENOENT) ? err_success() : err_stdlib(0, options.checkpoint);
+
+  char line[4096];
+  char list[4096];
+  bool matches = true;
+  bool valid = true;
+  int option_lines = 0;
+  int value;
+
+  while (matches && valid && fgets(line, sizeof(line), fh)) {
+    BruteforceResult r;
+    line[strcspn(line, "\n")] = '\0';
+
+    // All options that affect the results have to be the same
+    if (sscanf(line, "fan_register %d", &value) == 1)
+      matches = (++option_lines, value == options.fan_register);
+    else if (sscanf(line, "fan_values %4095s", list) == 1)
+      matches = (++option_lines, Checkpoint_IntsEqual(list, &options.fan_values));
+    else if (sscanf(line, "registers %4095s", list) == 1)
+      matches = (++option_lines, Checkpoint_IntsEqual(list, &options.bruteforce_registers));
+    else if (sscanf(line, "values %4095s", list) == 1)
+      matches = (++option_lines, Checkpoint_IntsEqual(list, &options.bruteforce_values));
+    else if (sscanf(line, "read_register %d", &value) == 1)
+      matches = (++option_lines, value == options.read_register);
+    else if (sscanf(line, "read_word %d", &value) == 1)
+      matches = (++option_lines, value == options.read_word);
+    else if (! strncmp(line, "hwmon_fan ", 10))
+      matches = (++option_lines, ! strcmp(line + 10, options.hwmon_fan ? options.hwmon_fan : ""));
+    else if (sscanf(line, "min_delta %d", &value) == 1)
+      matches = (++option_lines, value == options.min_delta);
+    else if (sscanf(line, "timeout %d", &value) == 1)
+      matches = (++option_lines, value == Checkpoint_Timeout());
+    else if (sscanf(line, "prune %d", &value) == 1)
+      matches = (++option_lines, value == options.prune);
+    else if (sscanf(line, "position %d %d", &progress.next_register, &progress.next_value) == 2)
+      valid = (progress.next_register >= 0 && progress.next_register <= options.bruteforce_registers.size &&
+               progress.next_value >= 0 && progress.next_value <= options.bruteforce_values.size);
+    else if (sscanf(line, "original %d %d", &progress.fan_original, &progress.register_original) == 2)
+      valid = (progress.fan_original >= 0 && progress.fan_original <= 255 &&
+               progress.register_original >= -1 && progress.register_original <= 255);
+    else if (!strncmp(line, "skip", 4)) {
+      array_of(int) skip = {NULL, 0};
+      progress.scanned = true;
+      if (line[4] == ' ' && line[5] && ! expand_ints(line + 5, &skip))
+        valid = false;
+      for_each_array(int*, i, skip) {
+        if (*i < 0 || *i >= ARRAY_SSIZE(progress.skip))
+          valid = false;
+        else
+          progress.skip[*i] = true;
+      }
+      Mem_Free(skip.data);
+    }
+    else if (sscanf(line, "result %d %d %d %d %d", &r.register_, &r.value, &r.fan_value, &r.baseline, &r.reading) == 5) {
+      results.data = Mem_Realloc(results.data, (results.size + 1) * sizeof(BruteforceResult));
+      results.data[results.size++] = r;
+    }
+    else if (*line) {
+      fclose(fh);
+      return err_stringf(0, "%s: Invalid line: %s", options.checkpoint, line);
+    }
+  }
+
+  fclose(fh);
+
+  if (! valid)
+    return err_stringf(0, "%s: Invalid value: %s", options.checkpoint, line);
+
+  if (! matches || option_lines != Checkpoint_Options)
+    return err_stringf(0, "%s: Checkpoint was made with different options", options.checkpoint);
+
+  if (progress.next_register >= options.bruteforce_registers.size)
+    printf("Checkpoint %s is already complete\n", options.checkpoint);
+  else
+    printf("Resuming from checkpoint %s (register %d of %zd)\n",
+      options.checkpoint, progress.next_register + 1, options.bruteforce_registers.size);
+
+  return err_success();
+}
+
+// ============================================================================
+// Scan
+// ============================================================================
+
+#define Scan_Samples  10
+#define Scan_Interval 100 // Milliseconds
+
+// Find registers that cannot be fan controls: registers that change on their own
+// (counters, sensors) and registers that do not keep a written value.
+static void Scan_Registers() {
+  uint8_t first[256];
+  bool is_volatile[256] = {0};
+  Error* e;
+
+  printf("Scanning registers ...\n");
+
+  for (int sample = 0; sample < Scan_Samples && !quit; ++sample) {
+    for_each_array(int*, register_, options.bruteforce_registers) {
+      uint8_t byte;
+      e = ec->ReadByte(*register_, &byte);
+      e_die();
+
+      if (! sample)
+        first[*register_] = byte;
+      else if (byte != first[*register_])
+        is_volatile[*register_] = true;
+    }
+
+    sleep_ms(Scan_Interval);
+  }
+
+  for_each_array(int*, register_, options.bruteforce_registers) {
+    if (quit)
+      return;
+
+    if (is_volatile[*register_]) {
+      printf("Skipping register %d (%X): Changes on its own\n", *register_, *register_);
+      progress.skip[*register_] = true;
+      continue;
+    }
+
+    if (*register_ == options.fan_register ||
+        *register_ == options.read_register ||
+        (options.read_word && *register_ == options.read_register + 1)) {
+      printf("Skipping register %d (%X): Used as fan register\n", *register_, *register_);
+      progress.skip[*register_] = true;
+      continue;
+    }
+
+    // Write a value that differs from the current one and read it back
+    const uint8_t old = first[*register_];
+    uint8_t test = old ^ 1;
+    for_each_array(int*, value, options.bruteforce_values)
+      if (*value != old) {
+        test = *value;
+        break;
+      }
+
+    uint8_t readback;
+    state.brutefoce_register = *register_;
+    state.bruteforce_register_oldvalue = old;
+    e = ec->WriteByte(*register_, test);
+    e_die();
+    e = ec->ReadByte(*register_, &readback);
+    e_die();
+    e = ec->WriteByte(*register_, old);
+    e_die();
+    state.brutefoce_register = -1;
+
+    if (readback != test) {
+      printf("Skipping register %d (%X): Read-only\n", *register_, *register_);
+      progress.skip[*register_] = true;
+    }
+  }
+
+  progress.scanned = !quit;
+}
+
+// ============================================================================
+// Bruteforce
+// ============================================================================
+
 static void bruteforce() {
   uint8_t byte;
   Error* e;
@@ -243,27 +695,124 @@ static void bruteforce() {
   e_die();
   state.fan_register_oldvalue = byte;
 
-  for_each_array(int*, register_, options.bruteforce_registers) {
-    state.brutefoce_register = *register_;
-    e = ec->ReadByte(*register_, &byte);
+  if (options.checkpoint) {
+    e = Checkpoint_Load();
+    e_die();
+    if (progress.fan_original >= 0)
+      state.fan_register_oldvalue = progress.fan_original;
+  }
+
+  if (options.prune && !progress.scanned) {
+    Scan_Registers();
+    if (options.checkpoint) {
+      e = Checkpoint_Save();
+      e_die();
+    }
+  }
+
+  if (Feedback_Enabled()) {
+    e = Feedback_Open();
     e_die();
+  }
+
+  for (; !quit && progress.next_register < options.bruteforce_registers.size; progress.next_register++) {
+    const int register_ = options.bruteforce_registers.data[progress.next_register];
+    if (progress.skip[register_]) {
+      progress.next_value = 0;
+      continue;
+    }
+
+    // Resuming within this register, the EC holds a bruteforced value
+    if (progress.register_original >= 0)
+      byte = progress.register_original;
+    else {
+      e = ec->ReadByte(register_, &byte);
+      e_die();
+    }
+    progress.register_original = -1;
+    state.brutefoce_register = register_;
     state.bruteforce_register_oldvalue = byte;
 
-    for_each_array(int*, value, options.bruteforce_values) {
-      e = ec->WriteByte(*register_, *value);
+    for (; !quit && progress.next_value < options.bruteforce_values.size; progress.next_value++) {
+      const int value = options.bruteforce_values.data[progress.next_value];
+      e = ec->WriteByte(register_, value);
       e_die();
 
+      // Let the fan return to its original speed before taking the baseline
+      int baseline = 0;
+      if (Feedback_Enabled()) {
+        bool settled;
+        e = ec->WriteByte(options.fan_register, state.fan_register_oldvalue);
+        e_die();
+        e = Feedback_Settle(NULL, &baseline, &settled);
+        e_die();
+      }
+
       for_each_array(int*, fan_speed_value, options.fan_values) {
+        if (quit)
+          break;
+
         e = ec->WriteByte(options.fan_register, *fan_speed_value);
         e_die();
 
         printf("Register = %d (%X), Value = %d (%X), FanSpeedValue = %d (%X)\n",
-          *register_, *register_, *value, *value, *fan_speed_value, *fan_speed_value);
-        sleep_ms(options.sleep * 1000);
+          register_, register_, value, value, *fan_speed_value, *fan_speed_value);
+
+        if (! Feedback_Enabled()) {
+          sleep_ms(options.sleep * 1000);
+          continue;
+        }
+
+        int reading;
+        bool settled;
+        e = Feedback_Settle(&baseline, &reading, &settled);
+        e_die();
+
+        // The combination is effective, the remaining fan values can be skipped
+        if (settled) {
+          printf("  Fan speed reading changed: %d -> %d\n", baseline, reading);
+          BruteforceResult result = { register_, value, *fan_speed_value, baseline, reading };
+          results.data = Mem_Realloc(results.data, (results.size + 1) * sizeof(BruteforceResult));
+          results.data[results.size++] = result;
+          break;
+        }
+      }
+
+      // An interrupted combination is repeated on resume
+      if (quit)
+        break;
+
+      if (options.checkpoint) {
+        progress.next_value++;
+        e = Checkpoint_Save();
+        progress.next_value--;
+        e_die();
       }
     }
 
-    e = ec->WriteByte(*register_, state.bruteforce_register_oldvalue);
+    if (quit)
+      break;
+
+    e = ec->WriteByte(register_, state.bruteforce_register_oldvalue);
     e_die();
+    state.brutefoce_register = -1;
+
+    progress.next_value = 0;
+    if (options.checkpoint) {
+      progress.next_register++;
+      e = Checkpoint_Save();
+      progress.next_register--;
+      e_die();
+    }
+  }
+
+  if (quit)
+    printf("\nInterrupted%s\n", options.checkpoint ? ", run again with the same options to resume" : "");
+
+  if (Feedback_Enabled()) {
+    printf("\nEffective combinations: %zd\n", results.size);
+    for_each_array(BruteforceResult*, r, results)
+      printf("Register = %d (%X), Value = %d (%X), FanSpeedValue = %d (%X), Reading = %d -> %d\n",
+        r->register_, r->register_, r->value, r->value, r->fan_value, r->fan_value, r->baseline, r->reading);
   }
 }
@@ -6,6 +6,9 @@
 #define NX_JSON_CALLOC(SIZE) ((nx_json*) StackMemory_Calloc(1, SIZE))
 #define NX_JSON_FREE(JSON)   (StackMemory_Free((void*) (JSON)))
 
+// Log messages are written by a separate thread, see Log_StartAsync()
+#define LOG_ASYNC 1
+
 #include "config.h"
 #include "ec.c"
 
@@ -13,6 +16,8 @@
 #include "ec_debug.c"
 #endif
 
+#include "ec_locked.c"
+
 #if ENABLE_EC_DUMMY
 #include "ec_dummy.c"
 #endif
@@ -31,8 +36,12 @@
 #include "trace.c"
 #include "fan.c"
 #include "fan_temperature_control.c"
+#include "critical_watchdog.c"
 #include "fs_sensors.c"
+#include "hwmon.c"
+#include "load_sensor.c"
 #include "file_utils.c"
+#include "flight_recorder.c"
 #include "memory.c"
 #include "stack_memory.c"
 #include "model_config.c"
@@ -41,6 +50,9 @@
 #include "program_name.c"
 #include "protocol.c"
 #include "pidfile.c"
+#include "power_policy.c"
+#include "realtime.c"
+#include "reexec.c"
 #include "reverse_nxjson.c"
 #include "service.c"
 #include "service_config.c"
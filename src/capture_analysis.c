@@ -0,0 +1,340 @@
+#include "capture_analysis.h"
+
+#include "macros.h"
+#include "memory.h"
+
+#include <math.h>   // sqrt, fabsf
+#include <stdlib.h> // qsort
+#include <string.h> // memset
+
+/*
+ * All series are standardized (zero mean, unit length) once, so that the
+ * correlation of two series is just their dot product.
+ * Registers are transposed into columns first, so that every candidate is a
+ * contiguous array.
+ */
+
+struct CaptureAnalysis_Signal {
+  float* values;  // Standardized channel values
+  float* ranks;   // Standardized ranks of the channel values
+};
+typedef struct CaptureAnalysis_Signal CaptureAnalysis_Signal;
+
+struct CaptureAnalysis_IndexedValue {
+  int32_t value;
+  int     index;
+};
+typedef struct CaptureAnalysis_IndexedValue CaptureAnalysis_IndexedValue;
+
+// Subtract the mean and scale to unit length. Returns false if all values are equal.
+static bool CaptureAnalysis_Standardize(float* v, int n) {
+  double sum = 0;
+  for (int i = 0; i < n; ++i)
+    sum += v[i];
+
+  const float mean = sum / n;
+  double sum_sq = 0;
+  for (int i = 0; i < n; ++i) {
+    v[i] -= mean;
+    sum_sq += (double) v[i] * v[i];
+  }
+
+  if (sum_sq <= 0)
+    return false;
+
+  const float scale = 1 / sqrt(sum_sq);
+  for (int i = 0; i < n; ++i)
+    v[i] *= scale;
+
+  return true;
+}
+
+// Four independent accumulators let the compiler keep the loop in vector registers
+static float CaptureAnalysis_Dot(const float* a, const float* b, int n) {
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    s0 += a[i + 0] * b[i + 0];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+
+  for (; i < n; ++i)
+    s0 += a[i] * b[i];
+
+  return (s0 + s1) + (s2 + s3);
+}
+
+static int CaptureAnalysis_CompareIndexedValue(const void* a, const void* b) {
+  const int32_t x = ((const CaptureAnalysis_IndexedValue*) a)->value;
+  const int32_t y = ((const CaptureAnalysis_IndexedValue*) b)->value;
+  return (x > y) - (x < y);
+}
+
+// Ranks of arbitrary values (ties get their average rank)
+static void CaptureAnalysis_RanksBySorting(const int32_t* values, int n, float* ranks) {
+  CaptureAnalysis_IndexedValue* sorted = Mem_Malloc(n * sizeof(*sorted));
+
+  for (int i = 0; i < n; ++i) {
+    sorted[i].value = values[i];
+    sorted[i].index = i;
+  }
+
+  qsort(sorted, n, sizeof(*sorted), CaptureAnalysis_CompareIndexedValue);
+
+  for (int start = 0, end; start < n; start = end) {
+    for (end = start + 1; end < n && sorted[end].value == sorted[start].value; ++end);
+
+    const float rank = (start + end - 1) / 2.0f;
+    for (int i = start; i < end; ++i)
+      ranks[sorted[i].index] = rank;
+  }
+
+  Mem_Free(sorted);
+}
+
+// Ranks of register values (counting sort, ties get their average rank)
+static void CaptureAnalysis_RanksByCounting(const uint16_t* values, int n, int bins, int* counts, float* rank_of, float* ranks) {
+  memset(counts, 0, bins * sizeof(int));
+  for (int i = 0; i < n; ++i)
+    counts[values[i]]++;
+
+  int start = 0;
+  for (int v = 0; v < bins; ++v) {
+    rank_of[v] = start + (counts[v] - 1) / 2.0f;
+    start += counts[v];
+  }
+
+  for (int i = 0; i < n; ++i)
+    ranks[i] = rank_of[values[i]];
+}
+
+static void CaptureAnalysis_LoadCandidate(const uint8_t* columns, int n, CaptureCandidate_Type type, int register_, uint16_t* out) {
+  const uint8_t* a = columns + (size_t) register_ * n;
+  const uint8_t* b = a + n;
+
+  switch (type) {
+  case CaptureCandidate_Byte:
+    for (int i = 0; i < n; ++i)
+      out[i] = a[i];
+    break;
+  case CaptureCandidate_WordLE:
+    for (int i = 0; i < n; ++i)
+      out[i] = a[i] | (b[i] << 8);
+    break;
+  case CaptureCandidate_WordBE:
+    for (int i = 0; i < n; ++i)
+      out[i] = (a[i] << 8) | b[i];
+    break;
+  }
+}
+
+static void CaptureAnalysis_Insert(CaptureAnalysis_Result* self, int top, const CaptureCandidate* candidate) {
+  int i = my.top_size;
+
+  if (i == top) {
+    if (candidate->score <= my.top[top - 1].score)
+      return;
+    --i;
+  }
+  else
+    my.top_size++;
+
+  for (; i > 0 && my.top[i - 1].score < candidate->score; --i)
+    my.top[i] = my.top[i - 1];
+
+  my.top[i] = *candidate;
+}
+
+// Linear correlation with `x` shifted by `lag` samples against `y`
+static float CaptureAnalysis_LaggedCorrelation(const float* x, const float* y, int n, int lag) {
+  const int abs_lag = abs(lag);
+  const float scale = (float) n / (n - abs_lag);
+
+  if (lag >= 0)
+    return CaptureAnalysis_Dot(x + abs_lag, y, n - abs_lag) * scale;
+  else
+    return CaptureAnalysis_Dot(x, y + abs_lag, n - abs_lag) * scale;
+}
+
+// Find the shift between register and channel with the strongest linear correlation.
+// Lags are first scanned with a coarse step which is then refined around the best one.
+static void CaptureAnalysis_FindLag(CaptureCandidate* self, const float* x, const float* y, int n, int max_lag) {
+  const int step = max(1, max_lag / 32);
+
+  my.lagged = my.pearson;
+  my.lag = 0;
+
+  for (int lag = step; lag <= max_lag; lag += step) {
+    for (int sign = -1; sign <= 1; sign += 2) {
+      const float r = CaptureAnalysis_LaggedCorrelation(x, y, n, sign * lag);
+      if (fabsf(r) > fabsf(my.lagged)) {
+        my.lagged = r;
+        my.lag = sign * lag;
+      }
+    }
+  }
+
+  const int coarse = my.lag;
+  for (int lag = max(coarse - step + 1, -max_lag); lag <= min(coarse + step - 1, max_lag); ++lag) {
+    if (lag == coarse)
+      continue;
+
+    const float r = CaptureAnalysis_LaggedCorrelation(x, y, n, lag);
+    if (fabsf(r) > fabsf(my.lagged)) {
+      my.lagged = r;
+      my.lag = lag;
+    }
+  }
+}
+
+// Rank all registers and register pairs by their correlation to every hwmon channel.
+// `results` must hold one entry per channel.
+Error* CaptureAnalysis_Run(const CaptureReader* reader, int top, int max_lag, CaptureAnalysis_Result* results) {
+  const int n = reader->samples_size;
+  const int channels = reader->header->channels;
+
+  top = max(1, min(top, CaptureAnalysis_MaxTop));
+  max_lag = max(0, min(max_lag, n / 2));
+  memset(results, 0, channels * sizeof(*results));
+
+  if (n < 3)
+    return err_string(0, "Capture contains too few samples");
+
+  // Transpose the registers into columns
+  uint8_t* columns = Mem_Malloc((size_t) RegistersSize * n);
+  for (int i = 0; i < n; ++i) {
+    const CaptureFile_Sample* sample = CaptureReader_Sample(reader, i);
+    for (int r = 0; r < RegistersSize; ++r)
+      columns[(size_t) r * n + i] = sample->registers[r];
+  }
+
+  bool varying[RegistersSize];
+  for (int r = 0; r < RegistersSize; ++r) {
+    const uint8_t* column = columns + (size_t) r * n;
+    varying[r] = false;
+    for (int i = 1; i < n && !varying[r]; ++i)
+      varying[r] = (column[i] != column[0]);
+  }
+
+  // Prepare the channels. Unreadable values repeat the last good value.
+  CaptureAnalysis_Signal* signals = Mem_Calloc(channels, sizeof(*signals));
+  int32_t* raw_values = Mem_Malloc(n * sizeof(int32_t));
+  bool have_signal = false;
+
+  for (int c = 0; c < channels; ++c) {
+    int32_t last = INT32_MIN;
+    for (int i = 0; i < n && last == INT32_MIN; ++i)
+      last = CaptureReader_Sample(reader, i)->values[c];
+
+    if (last == INT32_MIN)
+      continue;
+
+    results[c].min = INT32_MAX;
+    results[c].max = INT32_MIN;
+    for (int i = 0; i < n; ++i) {
+      const int32_t value = CaptureReader_Sample(reader, i)->values[c];
+      if (value != INT32_MIN)
+        last = value;
+      raw_values[i] = last;
+      results[c].min = min(results[c].min, last);
+      results[c].max = max(results[c].max, last);
+    }
+
+    if (results[c].min == results[c].max)
+      continue;
+
+    signals[c].values = Mem_Malloc(n * sizeof(float));
+    signals[c].ranks  = Mem_Malloc(n * sizeof(float));
+    for (int i = 0; i < n; ++i)
+      signals[c].values[i] = raw_values[i];
+    CaptureAnalysis_RanksBySorting(raw_values, n, signals[c].ranks);
+    CaptureAnalysis_Standardize(signals[c].values, n);
+    CaptureAnalysis_Standardize(signals[c].ranks, n);
+    results[c].valid = true;
+    have_signal = true;
+  }
+
+  uint16_t* raw     = Mem_Malloc(n * sizeof(uint16_t));
+  float*    x       = Mem_Malloc(n * sizeof(float));
+  float*    x_ranks = Mem_Malloc(n * sizeof(float));
+  int*      counts  = Mem_Malloc(65536 * sizeof(int));
+  float*    rank_of = Mem_Malloc(65536 * sizeof(float));
+
+  for (int type = CaptureCandidate_Byte; have_signal && type <= CaptureCandidate_WordBE; ++type) {
+    for (int r = 0; r < RegistersSize; ++r) {
+      // A pair with a constant byte correlates exactly like the other byte alone
+      if (type == CaptureCandidate_Byte ? !varying[r] : (r + 1 == RegistersSize || !varying[r] || !varying[r + 1]))
+        continue;
+
+      CaptureCandidate candidate = {0};
+      candidate.type = type;
+      candidate.register_ = r;
+
+      CaptureAnalysis_LoadCandidate(columns, n, type, r, raw);
+      candidate.min = 65535;
+      candidate.max = 0;
+      for (int i = 0; i < n; ++i) {
+        x[i] = raw[i];
+        candidate.min = min(candidate.min, raw[i]);
+        candidate.max = max(candidate.max, raw[i]);
+      }
+
+      CaptureAnalysis_RanksByCounting(raw, n, (type == CaptureCandidate_Byte ? 256 : 65536), counts, rank_of, x_ranks);
+      CaptureAnalysis_Standardize(x, n);
+      CaptureAnalysis_Standardize(x_ranks, n);
+
+      for (int c = 0; c < channels; ++c) {
+        if (! results[c].valid)
+          continue;
+
+        candidate.pearson  = CaptureAnalysis_Dot(x, signals[c].values, n);
+        candidate.spearman = CaptureAnalysis_Dot(x_ranks, signals[c].ranks, n);
+        candidate.score    = max(fabsf(candidate.pearson), fabsf(candidate.spearman));
+        CaptureAnalysis_Insert(&results[c], top, &candidate);
+      }
+    }
+  }
+
+  // Lags are only searched for the best candidates
+  for (int c = 0; c < channels; ++c) {
+    for (int i = 0; i < results[c].top_size; ++i) {
+      CaptureCandidate* candidate = &results[c].top[i];
+      CaptureAnalysis_LoadCandidate(columns, n, candidate->type, candidate->register_, raw);
+      for (int j = 0; j < n; ++j)
+        x[j] = raw[j];
+      CaptureAnalysis_Standardize(x, n);
+      CaptureAnalysis_FindLag(candidate, x, signals[c].values, n, max_lag);
+      candidate->score = max(candidate->score, fabsf(candidate->lagged));
+    }
+
+    // Re-sort, a delayed register may now be the best match
+    for (int i = 1; i < results[c].top_size; ++i) {
+      const CaptureCandidate candidate = results[c].top[i];
+      int j = i;
+      for (; j > 0 && results[c].top[j - 1].score < candidate.score; --j)
+        results[c].top[j] = results[c].top[j - 1];
+      results[c].top[j] = candidate;
+    }
+  }
+
+  for (int c = 0; c < channels; ++c) {
+    Mem_Free(signals[c].values);
+    Mem_Free(signals[c].ranks);
+  }
+  Mem_Free(signals);
+  Mem_Free(raw_values);
+  Mem_Free(raw);
+  Mem_Free(x);
+  Mem_Free(x_ranks);
+  Mem_Free(counts);
+  Mem_Free(rank_of);
+  Mem_Free(columns);
+
+  if (! have_signal)
+    return err_string(0, "None of the hwmon channels changed during the capture");
+
+  return err_success();
+}
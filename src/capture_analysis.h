@@ -0,0 +1,40 @@
+#ifndef CAPTURE_ANALYSIS_H_
+#define CAPTURE_ANALYSIS_H_
+
+#include "capture_file.h"
+
+#define CaptureAnalysis_MaxTop 32
+
+enum CaptureCandidate_Type {
+  CaptureCandidate_Byte,
+  CaptureCandidate_WordLE,    // `register_` holds the low byte
+  CaptureCandidate_WordBE,    // `register_` holds the high byte
+};
+typedef enum CaptureCandidate_Type CaptureCandidate_Type;
+
+// A register (or register pair) compared against a hwmon channel
+struct CaptureCandidate {
+  CaptureCandidate_Type type;
+  int                   register_;
+  float                 score;        // max(|pearson|, |spearman|, |lagged|)
+  float                 pearson;      // Linear correlation
+  float                 spearman;     // Rank correlation (monotonicity)
+  float                 lagged;       // Linear correlation at `lag`
+  int                   lag;          // Samples, positive if the register follows the channel
+  int                   min;
+  int                   max;
+};
+typedef struct CaptureCandidate CaptureCandidate;
+
+struct CaptureAnalysis_Result {
+  bool             valid;             // False if the channel never changed
+  int              min;
+  int              max;
+  int              top_size;
+  CaptureCandidate top[CaptureAnalysis_MaxTop];
+};
+typedef struct CaptureAnalysis_Result CaptureAnalysis_Result;
+
+Error* CaptureAnalysis_Run(const CaptureReader*, int, int, CaptureAnalysis_Result*);
+
+#endif
@@ -0,0 +1,243 @@
+#include "capture_file.h"
+
+#include "macros.h"
+#include "memory.h"
+#include "file_utils.h"
+
+#include <dirent.h>       // scandir, alphasort
+#include <errno.h>        // errno
+#include <fcntl.h>        // open, O_RDONLY
+#include <stdio.h>        // snprintf, fopen, fwrite
+#include <stdlib.h>       // strtol
+#include <string.h>       // memcpy, strcmp, strerror
+#include <time.h>         // clock_gettime
+#include <unistd.h>       // pread, close
+#include <sys/mman.h>     // mmap, munmap
+#include <sys/stat.h>     // fstat
+#include <linux/limits.h> // PATH_MAX
+
+#define CaptureFile_MaxChannels 64
+
+static const char HwmonDir[] = "/sys/class/hwmon";
+
+static int CaptureWriter_IsHwmon(const struct dirent* entry) {
+  return !strncmp(entry->d_name, "hwmon", 5);
+}
+
+static int CaptureWriter_IsChannel(const struct dirent* entry) {
+  int index, end = 0;
+
+  if (sscanf(entry->d_name, "temp%d_input%n", &index, &end) == 1 && entry->d_name[end] == '\0')
+    return 1;
+
+  if (sscanf(entry->d_name, "fan%d_input%n", &index, &end) == 1 && entry->d_name[end] == '\0')
+    return 1;
+
+  return 0;
+}
+
+// Add all temperature and fan inputs of a hwmon device
+static void CaptureWriter_AddHwmon(CaptureWriter* self, const char* hwmon) {
+  char dir[512];
+  char file[PATH_MAX];
+  char hwmon_name[32];
+  struct dirent** entries;
+
+  snprintf(dir, sizeof(dir), "%s/%s", HwmonDir, hwmon);
+  snprintf(file, sizeof(file), "%s/name", dir);
+  if (slurp_file(hwmon_name, sizeof(hwmon_name), file) <= 0)
+    snprintf(hwmon_name, sizeof(hwmon_name), "%s", hwmon);
+  hwmon_name[strcspn(hwmon_name, "\n")] = '\0';
+
+  const int n = scandir(dir, &entries, CaptureWriter_IsChannel, alphasort);
+  if (n < 0)
+    return;
+
+  for (int i = 0; i < n; ++i) {
+    const char* input = entries[i]->d_name;
+
+    if (my.channels_size == CaptureFile_MaxChannels) {
+      Log_Warn("Too many hwmon channels, ignoring %s/%s\n", dir, input);
+      continue;
+    }
+
+    snprintf(file, sizeof(file), "%s/%s", dir, input);
+    const int fd = open(file, O_RDONLY);
+    if (fd < 0) {
+      Log_Warn("%s: %s\n", file, strerror(errno));
+      continue;
+    }
+
+    // Use the label if there is one ("temp1_input" -> "temp1_label")
+    const int prefix_len = strcspn(input, "_");
+    char label[31];
+    snprintf(file, sizeof(file), "%s/%.*s_label", dir, prefix_len, input);
+    if (slurp_file(label, sizeof(label), file) <= 0)
+      snprintf(label, sizeof(label), "%.*s", prefix_len, input);
+    label[strcspn(label, "\n")] = '\0';
+
+    CaptureFile_Channel* channel = &my.channels[my.channels_size];
+    channel->type = (input[0] == 't' ? CaptureChannel_Temperature : CaptureChannel_Fan);
+    snprintf(channel->name, sizeof(channel->name), "%s/%s", hwmon_name, label);
+    my.channel_fds[my.channels_size++] = fd;
+  }
+
+  for (int i = 0; i < n; ++i)
+    free(entries[i]);
+  free(entries);
+}
+
+static void CaptureWriter_AddAllHwmon(CaptureWriter* self) {
+  struct dirent** entries;
+
+  const int n = scandir(HwmonDir, &entries, CaptureWriter_IsHwmon, alphasort);
+  if (n < 0) {
+    Log_Warn("%s: %s\n", HwmonDir, strerror(errno));
+    return;
+  }
+
+  for (int i = 0; i < n; ++i) {
+    CaptureWriter_AddHwmon(self, entries[i]->d_name);
+    free(entries[i]);
+  }
+  free(entries);
+}
+
+Error* CaptureWriter_Open(CaptureWriter* self, const char* file, uint32_t interval, bool hwmon) {
+  my.channels_size = 0;
+  my.channels = Mem_Calloc(CaptureFile_MaxChannels, sizeof(CaptureFile_Channel));
+  my.channel_fds = Mem_Malloc(CaptureFile_MaxChannels * sizeof(int));
+
+  if (hwmon)
+    CaptureWriter_AddAllHwmon(self);
+
+  my.sample_size = sizeof(CaptureFile_Sample) + my.channels_size * sizeof(int32_t);
+  my.sample_size = (my.sample_size + 7) & ~7;
+  my.sample = Mem_Calloc(1, my.sample_size);
+
+  my.fh = fopen(file, "wb");
+  if (! my.fh) {
+    Error* e = err_stdlib(0, file);
+    CaptureWriter_Close(self);
+    return e;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  CaptureFile_Header header = {0};
+  memcpy(header.magic, CaptureFile_Magic, sizeof(header.magic));
+  header.interval    = interval;
+  header.channels    = my.channels_size;
+  header.sample_size = my.sample_size;
+  header.start_time  = (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+
+  if (fwrite(&header, sizeof(header), 1, my.fh) != 1 ||
+      fwrite(my.channels, sizeof(CaptureFile_Channel), my.channels_size, my.fh) != (size_t) my.channels_size) {
+    Error* e = err_stdlib(0, file);
+    CaptureWriter_Close(self);
+    return e;
+  }
+
+  return err_success();
+}
+
+// Write a sample. The hwmon channels are read now.
+Error* CaptureWriter_Write(CaptureWriter* self, uint64_t timestamp, const RegisterBuf* regs) {
+  my.sample->timestamp = timestamp;
+  memcpy(my.sample->registers, regs, RegistersSize);
+
+  for (int i = 0; i < my.channels_size; ++i) {
+    char buf[32];
+    const ssize_t nread = pread(my.channel_fds[i], buf, sizeof(buf) - 1, 0);
+    if (nread > 0) {
+      buf[nread] = '\0';
+      my.sample->values[i] = strtol(buf, NULL, 10);
+    }
+    else
+      my.sample->values[i] = INT32_MIN;
+  }
+
+  if (fwrite(my.sample, my.sample_size, 1, my.fh) != 1)
+    return err_stdlib(0, "fwrite()");
+
+  return err_success();
+}
+
+Error* CaptureWriter_Close(CaptureWriter* self) {
+  Error* e = err_success();
+
+  if (my.fh && fclose(my.fh))
+    e = err_stdlib(0, "fclose()");
+
+  for (int i = 0; i < my.channels_size; ++i)
+    close(my.channel_fds[i]);
+
+  Mem_Free(my.channels);
+  Mem_Free(my.channel_fds);
+  Mem_Free(my.sample);
+  my.fh = NULL;
+  my.channels = NULL;
+  my.channel_fds = NULL;
+  my.sample = NULL;
+  my.channels_size = 0;
+  return e;
+}
+
+Error* CaptureReader_Open(CaptureReader* self, const char* file) {
+  Error* e = NULL;
+  struct stat st;
+
+  memset(self, 0, sizeof(*self));
+
+  const int fd = open(file, O_RDONLY);
+  if (fd < 0)
+    return err_stdlib(0, file);
+
+  if (fstat(fd, &st) < 0) {
+    e = err_stdlib(0, file);
+    goto end;
+  }
+
+  if ((size_t) st.st_size < sizeof(CaptureFile_Header)) {
+    e = err_string(0, "File is not a capture file");
+    goto end;
+  }
+
+  my.map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (my.map == MAP_FAILED) {
+    my.map = NULL;
+    e = err_stdlib(0, file);
+    goto end;
+  }
+  my.map_size = st.st_size;
+
+  my.header = my.map;
+  if (memcmp(my.header->magic, CaptureFile_Magic, sizeof(my.header->magic))) {
+    e = err_string(0, "File is not a capture file");
+    goto end;
+  }
+
+  const size_t channels_size = (size_t) my.header->channels * sizeof(CaptureFile_Channel);
+  if (my.header->sample_size < sizeof(CaptureFile_Sample) + my.header->channels * sizeof(int32_t) ||
+      sizeof(CaptureFile_Header) + channels_size > my.map_size) {
+    e = err_string(0, "Invalid capture file header");
+    goto end;
+  }
+
+  my.channels = (const CaptureFile_Channel*) ((const uint8_t*) my.map + sizeof(CaptureFile_Header));
+  my.samples  = (const uint8_t*) my.channels + channels_size;
+  my.samples_size = (my.map_size - sizeof(CaptureFile_Header) - channels_size) / my.header->sample_size;
+
+end:
+  close(fd);
+  if (e)
+    CaptureReader_Close(self);
+  return e;
+}
+
+void CaptureReader_Close(CaptureReader* self) {
+  if (my.map)
+    munmap(my.map, my.map_size);
+  memset(self, 0, sizeof(*self));
+}
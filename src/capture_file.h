@@ -0,0 +1,86 @@
+#ifndef CAPTURE_FILE_H_
+#define CAPTURE_FILE_H_
+
+#include "error.h"
+#include "macros.h"
+#include "register_history.h"
+
+#include <stdbool.h> // bool
+#include <stdint.h>  // uint8_t, uint32_t, uint64_t, int32_t
+#include <stdio.h>   // FILE
+
+/*
+ * Binary capture file written by `ec_probe capture`.
+ *
+ * Layout (native byte order):
+ *   CaptureFile_Header
+ *   CaptureFile_Channel[header.channels]
+ *   CaptureFile_Sample[...]     (header.sample_size bytes each)
+ *
+ * The number of samples is derived from the file size, so a capture that
+ * was interrupted can still be read.
+ */
+
+#define CaptureFile_Magic "NBFCCAP1"
+
+enum CaptureChannel_Type {
+  CaptureChannel_Temperature, // Millidegrees Celsius
+  CaptureChannel_Fan,         // RPM
+};
+typedef enum CaptureChannel_Type CaptureChannel_Type;
+
+struct CaptureFile_Header {
+  char     magic[8];
+  uint32_t interval;          // Sampling interval in milliseconds
+  uint32_t channels;          // Number of hwmon channels
+  uint32_t sample_size;       // Size of a sample in bytes
+  uint32_t reserved;
+  uint64_t start_time;        // Realtime clock at the first sample, in nanoseconds
+};
+typedef struct CaptureFile_Header CaptureFile_Header;
+
+struct CaptureFile_Channel {
+  uint8_t  type;              // CaptureChannel_Type
+  char     name[63];          // "<hwmon name>/<label>", NUL terminated
+};
+typedef struct CaptureFile_Channel CaptureFile_Channel;
+
+struct CaptureFile_Sample {
+  uint64_t    timestamp;      // Monotonic clock, nanoseconds since the first sample
+  RegisterBuf registers;
+  int32_t     values[];       // One value per channel, INT32_MIN if it could not be read
+};
+typedef struct CaptureFile_Sample CaptureFile_Sample;
+
+struct CaptureWriter {
+  FILE*                fh;
+  int                  channels_size;
+  CaptureFile_Channel* channels;
+  int*                 channel_fds;
+  CaptureFile_Sample*  sample;
+  size_t               sample_size;
+};
+typedef struct CaptureWriter CaptureWriter;
+
+struct CaptureReader {
+  const CaptureFile_Header*  header;
+  const CaptureFile_Channel* channels;
+  const uint8_t*             samples;
+  int                        samples_size;    // Number of samples
+  void*                      map;
+  size_t                     map_size;
+};
+typedef struct CaptureReader CaptureReader;
+
+Error* CaptureWriter_Open(CaptureWriter*, const char*, uint32_t, bool);
+Error* CaptureWriter_Write(CaptureWriter*, uint64_t, const RegisterBuf*);
+Error* CaptureWriter_Close(CaptureWriter*);
+
+Error* CaptureReader_Open(CaptureReader*, const char*);
+void   CaptureReader_Close(CaptureReader*);
+
+static inline const CaptureFile_Sample* CaptureReader_Sample(const CaptureReader* self, int i) {
+  return (const CaptureFile_Sample*) (my.samples + (size_t) i * my.header->sample_size);
+}
+
+#endif
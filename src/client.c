@@ -1,4 +1,5 @@
 #define _XOPEN_SOURCE 500 // string.h: strdup
+#define _DEFAULT_SOURCE   // sys/stat.h: st_mtim
 
 #define NX_JSON_CALLOC(SIZE) ((nx_json*) Mem_Calloc(1, SIZE))
 #define NX_JSON_FREE(JSON)   (Mem_Free((void*) (JSON)))
@@ -20,6 +21,7 @@
 #include "log.c"
 #include "error.c"
 #include "file_utils.c"
+#include "flight_recorder.c"
 #include "model_config.c"
 #include "fs_sensors.c"
 #include "nvidia.c"
@@ -36,6 +38,9 @@
 #include "client/dmi.c"
 #include "client/config_files.c"
 #include "client/str_functions.c"
+#include "client/str_set.c"
+#include "client/model_support_index.c"
+#include "client/update_libs.c"
 #include "client/service_control.c"
 
 const cli99_option main_options[] = {
@@ -59,11 +64,12 @@ const cli99_option main_options[] = {
 #include "client/cmd_misc.c"
 #include "client/cmd_warranty.c"
 #include "client/cmd_donate.c"
+#include "client/cmd_dump.c"
 
 #define NBFC_CLIENT_COMMANDS \
   o("start",            Start,            START,            start)         \
   o("stop",             Stop,             STOP,             main)          \
-  o("restart",          Restart,          RESTART,          start)         \
+  o("restart",          Restart,          RESTART,          restart)       \
   o("status",           Status,           STATUS,           status)        \
   o("sensors",          Sensors,          SENSORS,          sensors)       \
   o("config",           Config,           CONFIG,           config)        \
@@ -74,6 +80,7 @@ const cli99_option main_options[] = {
   o("complete-fans",    Complete_Fans,    COMPLETE_FANS,    main)          \
   o("complete-sensors", Complete_Sensors, COMPLETE_SENSORS, main)          \
   o("show-variable",    Show_Variable,    SHOW_VARIABLE,    show_variable) \
+  o("dump",             Dump,             DUMP,             dump)          \
   o("warranty",         Warranty,         WARRANTY,         main)          \
   o("donate",           Donate,           DONATE,           main)          \
   o("help",             Help,             HELP,             main)
@@ -324,6 +331,10 @@ int main(int argc, char *const argv[]) {
       Update_Options.quiet = 1;
       break;
 
+    case Option_Update_Archive:
+      Update_Options.archive = 1;
+      break;
+
     // ========================================================================
     // Start/Restart options
     // ========================================================================
@@ -332,6 +343,10 @@ int main(int argc, char *const argv[]) {
       Start_Options.read_only = 1;
       break;
 
+    case Option_Restart_Live:
+      Start_Options.live = 1;
+      break;
+
     // ========================================================================
     // Show-Variable options
     // ========================================================================
@@ -340,6 +355,30 @@ int main(int argc, char *const argv[]) {
       Show_Variable_Options.variable = p.optarg;
       break;
 
+    // ========================================================================
+    // Dump options
+    // ========================================================================
+
+    case Option_Dump_Count:
+      Dump_Options.count = parse_number(p.optarg, 0, INT_MAX, &err);
+      if (err) {
+        Log_Error("%s: %s: %s\n", "-n|--count", err, p.optarg);
+        return NBFC_EXIT_FAILURE;
+      }
+      break;
+
+    case Option_Dump_Csv:
+      Dump_Options.csv = true;
+      break;
+
+    case Option_Dump_Stats:
+      Dump_Options.stats = true;
+      break;
+
+    case Option_Dump_File:
+      Dump_Options.file = p.optarg;
+      break;
+
     // ========================================================================
     // Error
     // ========================================================================
@@ -362,6 +401,7 @@ int main(int argc, char *const argv[]) {
   case Command_Wait_For_Hwmon:    return Wait_For_Hwmon();
   case Command_Get_Model_Name:    return Get_Model_Name();
   case Command_Show_Variable:     return Show_Variable();
+  case Command_Dump:              return Dump();
   case Command_Complete_Fans:     return Complete_Fans();
   case Command_Complete_Sensors:  return Complete_Sensors();
   case Command_Warranty:          return Warranty();
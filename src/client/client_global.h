@@ -39,13 +39,21 @@ enum Option {
 
   // Start/Restart options
   Option_Start_ReadOnly,
+  Option_Restart_Live,
 
   // Update options
   Option_Update_Parallel,
   Option_Update_Quiet,
+  Option_Update_Archive,
 
   // Show-Variable options
   Option_ShowVariable_Variable,
+
+  // Dump options
+  Option_Dump_Count,
+  Option_Dump_Csv,
+  Option_Dump_Stats,
+  Option_Dump_File,
 };
 
 extern const cli99_option main_options[];
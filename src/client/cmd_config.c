@@ -62,7 +62,7 @@ int List() {
 
 int Recommend() {
   const char* model_name = DMI_Get_Model_Name();
-  array_of(ConfigFile) files = List_Recommended_Configs();
+  array_of(ConfigFile) files = List_All_Configs();
   char* config = Get_Supported_Config(&files, model_name);
 
   if (config) {
@@ -81,15 +81,12 @@ int Recommend() {
     "[!] and configuration names.\n"
     "\n");
 
-  bool have_match = 0;
-  for_each_array(ConfigFile*, file, files) {
-    if (file->diff >= RecommendedConfigMatchThreshold) {
-      have_match = 1;
-      printf("%s\n", file->config_name);
-    }
+  array_of(ConfigFile) recommended = List_Recommended_Configs(&files, model_name);
+  for_each_array(ConfigFile*, file, recommended) {
+    printf("%s\n", file->config_name);
   }
 
-  if (! have_match) {
+  if (! recommended.size) {
     Log_Error("No recommended configuration files found\n");
   }
 
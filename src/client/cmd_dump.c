@@ -0,0 +1,188 @@
+#include <stdio.h>  // printf
+#include <stdlib.h> // qsort
+#include <time.h>   // localtime_r, strftime
+
+#include "client_global.h"
+
+#include "../nbfc.h"
+#include "../fan.h"
+#include "../log.h"
+#include "../memory.h"
+#include "../flight_recorder.h"
+
+const cli99_option dump_options[] = {
+  cli99_include_options(&main_options),
+  {"-n|--count", Option_Dump_Count, 1},
+  {"-c|--csv",   Option_Dump_Csv,   0},
+  {"-s|--stats", Option_Dump_Stats, 0},
+  {"file",       Option_Dump_File,  1},
+  cli99_options_end()
+};
+
+struct {
+  int         count;
+  bool        csv;
+  bool        stats;
+  const char* file;
+} Dump_Options = {
+  -1,
+  false,
+  false,
+  NBFC_FLIGHT_RECORDER_FILE,
+};
+
+static const char* Dump_FormatTime(uint64_t timestamp, char* buf, size_t size) {
+  const time_t seconds = timestamp / 1000000;
+  struct tm tm;
+  char date[32];
+
+  localtime_r(&seconds, &tm);
+  strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm);
+  snprintf(buf, size, "%s.%03d", date, (int) (timestamp % 1000000 / 1000));
+  return buf;
+}
+
+static void Dump_PrintCsvHeader(int fans) {
+  printf("timestamp,total_us,lateness_us,read_speeds_us,register_writes_us,temperatures_us,write_speeds_us,ec_writes,reinit,error,powersave,resume");
+  for (int i = 0; i < fans; ++i)
+    printf(",fan%d_raw_temperature,fan%d_temperature,fan%d_predicted_temperature,fan%d_threshold,fan%d_load_bias,fan%d_target_speed,fan%d_current_speed,fan%d_mode,fan%d_critical",
+      i, i, i, i, i, i, i, i, i);
+  printf("\n");
+}
+
+static void Dump_PrintCsv(const FlightRecorder_Record* r) {
+  printf("%.3f,%u,%u,%u,%u,%u,%u,%u,%d,%d,%d,%d",
+    r->timestamp / 1e6,
+    r->total,
+    r->lateness,
+    r->duration[FlightRecorder_Phase_ReadSpeeds],
+    r->duration[FlightRecorder_Phase_RegisterWrites],
+    r->duration[FlightRecorder_Phase_Temperatures],
+    r->duration[FlightRecorder_Phase_WriteSpeeds],
+    r->ec_writes,
+    !!(r->flags & FlightRecorder_ReInit),
+    !!(r->flags & FlightRecorder_Error),
+    !!(r->flags & FlightRecorder_PowerSave),
+    !!(r->flags & FlightRecorder_Resume));
+
+  for (int i = 0; i < r->fans; ++i) {
+    const FlightRecorder_Fan* f = &r->fan[i];
+    printf(",%.2f,%.2f,%.2f,%d,%.2f,%.2f,%.2f,%s,%d",
+      f->raw_temperature, f->temperature, f->predicted_temperature, f->threshold, f->load_bias, f->target_speed, f->current_speed,
+      f->mode == Fan_ModeAuto ? "auto" : "fixed", f->critical);
+  }
+  printf("\n");
+}
+
+static void Dump_PrintText(const FlightRecorder_Record* r) {
+  char time[64];
+
+  printf("%s  %7.2fms  (%.2f/%.2f/%.2f/%.2f)  late %.2fms  writes=%u%s%s%s%s\n",
+    Dump_FormatTime(r->timestamp, time, sizeof(time)),
+    r->total / 1e3,
+    r->duration[FlightRecorder_Phase_ReadSpeeds] / 1e3,
+    r->duration[FlightRecorder_Phase_RegisterWrites] / 1e3,
+    r->duration[FlightRecorder_Phase_Temperatures] / 1e3,
+    r->duration[FlightRecorder_Phase_WriteSpeeds] / 1e3,
+    r->lateness / 1e3,
+    r->ec_writes,
+    (r->flags & FlightRecorder_ReInit) ? "  REINIT" : "",
+    (r->flags & FlightRecorder_Error)  ? "  ERROR"  : "",
+    (r->flags & FlightRecorder_PowerSave) ? "  POWERSAVE" : "",
+    (r->flags & FlightRecorder_Resume) ? "  RESUME" : "");
+
+  for (int i = 0; i < r->fans; ++i) {
+    const FlightRecorder_Fan* f = &r->fan[i];
+    printf("  Fan #%d: %6.2f°C -> %6.2f°C -> %6.2f°C  threshold %2d  load +%.0f%%  target %6.2f%%  current %6.2f%%  %s%s\n",
+      i, f->raw_temperature, f->temperature, f->predicted_temperature, f->threshold, f->load_bias, f->target_speed, f->current_speed,
+      f->mode == Fan_ModeAuto ? "auto" : "fixed",
+      f->critical ? "  CRITICAL" : "");
+  }
+}
+
+static int Dump_CompareUInt32(const void* a, const void* b) {
+  const uint32_t x = *(const uint32_t*) a;
+  const uint32_t y = *(const uint32_t*) b;
+  return (x > y) - (x < y);
+}
+
+// Sorts `values`
+static void Dump_PrintStats(const char* name, uint32_t* values, size_t count) {
+  double sum = 0;
+  for (size_t i = 0; i < count; ++i)
+    sum += values[i];
+
+  qsort(values, count, sizeof(*values), Dump_CompareUInt32);
+
+  printf("%-10s  %8.3f  %8.3f  %8.3f  %8.3f\n",
+    name,
+    sum / count / 1e3,
+    values[count / 2] / 1e3,
+    values[(count - 1) * 99 / 100] / 1e3,
+    values[count - 1] / 1e3);
+}
+
+static int Dump() {
+  FlightRecorder recorder;
+
+  Error* e = FlightRecorder_OpenRead(&recorder, Dump_Options.file);
+  if (e) {
+    Log_Error("%s\n", err_print_all(e));
+    return NBFC_EXIT_FAILURE;
+  }
+
+  const uint64_t next = __atomic_load_n(&recorder.header->next, __ATOMIC_ACQUIRE);
+  uint64_t first = (next > recorder.header->capacity) ? next - recorder.header->capacity : 0;
+  if (Dump_Options.count >= 0 && next - first > (uint64_t) Dump_Options.count)
+    first = next - Dump_Options.count;
+
+  FlightRecorder_Record* record = Mem_Malloc(recorder.header->record_size);
+  uint32_t* totals    = NULL;
+  uint32_t* lateness  = NULL;
+  size_t    count     = 0;
+  size_t    late_count = 0;
+
+  if (Dump_Options.stats) {
+    totals   = Mem_Malloc((next - first) * sizeof(uint32_t));
+    lateness = Mem_Malloc((next - first) * sizeof(uint32_t));
+  }
+  else if (Dump_Options.csv)
+    Dump_PrintCsvHeader(recorder.header->fans);
+
+  for (uint64_t n = first; n < next; ++n) {
+    // The service may overwrite the oldest records while we are reading
+    if (! FlightRecorder_Read(&recorder, n, record))
+      continue;
+
+    if (record->fans > recorder.header->fans)
+      record->fans = recorder.header->fans;
+
+    if (Dump_Options.stats) {
+      totals[count++] = record->total;
+
+      // The first tick after a resume was delayed by the suspend, not by the service
+      if (! (record->flags & FlightRecorder_Resume))
+        lateness[late_count++] = record->lateness;
+    }
+    else if (Dump_Options.csv)
+      Dump_PrintCsv(record);
+    else
+      Dump_PrintText(record);
+  }
+
+  if (Dump_Options.stats) {
+    printf("%zu ticks\n", count);
+    if (count) {
+      printf("%-10s  %8s  %8s  %8s  %8s\n", "(ms)", "mean", "p50", "p99", "max");
+      Dump_PrintStats("total", totals, count);
+      if (late_count)
+        Dump_PrintStats("lateness", lateness, late_count);
+    }
+  }
+
+  Mem_Free(totals);
+  Mem_Free(lateness);
+  Mem_Free(record);
+  FlightRecorder_Close(&recorder);
+  return NBFC_EXIT_SUCCESS;
+}
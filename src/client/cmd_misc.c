@@ -69,37 +69,26 @@ static int Complete_Fans() {
 static int Complete_Sensors() {
   FS_Sensors_Init();
 
-  const char* having[4096];
-  ssize_t     having_size = 0;
+  ssize_t* first;
+  ssize_t* next;
+  const ssize_t n_names = Sensors_GroupByName(&first, &next);
 
   printf("%s\t%s\n", "@CPU", "group");
   printf("%s\t%s\n", "@GPU", "group");
 
-  for_each_array(FS_TemperatureSource*, source, FS_Sensors_Sources) {
-    bool sensor_printed = false;
+  for (ssize_t name = 0; name < n_names; ++name) {
+    const char* sensor_name = FS_Sensors_Sources.data[first[name]].name;
+    printf("%s\tsensor\n", sensor_name);
 
-    for (ssize_t i = 0; i < having_size; ++i) {
-      if (! strcmp(having[i], source->name)) {
-        sensor_printed = true;
-        break;
-      }
-    }
-
-    if (sensor_printed)
-      continue;
-
-    having[having_size++] = source->name;
-
-    printf("%s\tsensor\n", source->name);
-
-    for_each_array(FS_TemperatureSource*, source2, FS_Sensors_Sources) {
-      if (! strcmp(source2->file, "none"))
+    for (ssize_t i = first[name]; i != -1; i = next[i]) {
+      if (! strcmp(FS_Sensors_Sources.data[i].file, "none"))
         continue; // nvidia-ml sensor has no file
 
-      if (! strcmp(source->name, source2->name))
-        printf("%s\t%s\n", source2->file, source->name);
+      printf("%s\t%s\n", FS_Sensors_Sources.data[i].file, sensor_name);
     }
   }
 
+  Mem_Free(first);
+  Mem_Free(next);
   return NBFC_EXIT_SUCCESS;
 }
@@ -4,6 +4,7 @@
 #include "service_control.h"
 #include "client_global.h"
 #include "check_root.h"
+#include "str_set.h"
 
 #include "../nbfc.h"
 #include "../memory.h"
@@ -259,35 +260,56 @@ static int Sensors_Show() {
   return NBFC_EXIT_SUCCESS;
 }
 
-static int Sensors_List() {
-  FS_Sensors_Init();
+/*
+ * Group `FS_Sensors_Sources` by sensor name.
+ *
+ * Returns the number of distinct names. `first` receives the index of the
+ * first source of each name (in order of appearance), `next` receives the
+ * index of the next source with the same name (-1 terminated).
+ */
+static ssize_t Sensors_GroupByName(ssize_t** first, ssize_t** next) {
+  const ssize_t n_sources = FS_Sensors_Sources.size;
+  ssize_t* last = Mem_Malloc(n_sources * sizeof(ssize_t));
+  StrSet names;
 
-  const char* having[4096];
-  ssize_t     having_size = 0;
+  *first = Mem_Malloc(n_sources * sizeof(ssize_t));
+  *next  = Mem_Malloc(n_sources * sizeof(ssize_t));
+  StrSet_Init(&names, n_sources);
 
-  for_each_array(FS_TemperatureSource*, source, FS_Sensors_Sources) {
-    bool sensor_printed = false;
+  for_enumerate_array(ssize_t, i, FS_Sensors_Sources) {
+    ssize_t id;
+    (*next)[i] = -1;
 
-    for (ssize_t i = 0; i < having_size; ++i) {
-      if (! strcmp(having[i], source->name)) {
-        sensor_printed = true;
-        break;
-      }
-    }
+    if (StrSet_Add(&names, FS_Sensors_Sources.data[i].name, &id))
+      (*first)[id] = i;
+    else
+      (*next)[last[id]] = i;
 
-    if (sensor_printed)
-      continue;
+    last[id] = i;
+  }
 
-    having[having_size++] = source->name;
+  const ssize_t n_names = names.size;
+  StrSet_Free(&names);
+  Mem_Free(last);
+  return n_names;
+}
 
-    printf("%s:\n", source->name);
+static int Sensors_List() {
+  FS_Sensors_Init();
 
-    for_each_array(FS_TemperatureSource*, source2, FS_Sensors_Sources) {
-      if (! strcmp(source->name, source2->name))
-        printf("\t%s\n", source2->file);
-    }
+  ssize_t* first;
+  ssize_t* next;
+  const ssize_t n_names = Sensors_GroupByName(&first, &next);
+
+  for (ssize_t name = 0; name < n_names; ++name) {
+    printf("%s:\n", FS_Sensors_Sources.data[first[name]].name);
+
+    for (ssize_t i = first[name]; i != -1; i = next[i])
+      printf("\t%s\n", FS_Sensors_Sources.data[i].file);
   }
 
+  Mem_Free(first);
+  Mem_Free(next);
   return NBFC_EXIT_SUCCESS;
 }
 
@@ -8,8 +8,15 @@ const cli99_option start_options[] = {
   cli99_options_end()
 };
 
+const cli99_option restart_options[] = {
+  cli99_include_options(&start_options),
+  {"-l|--live",      Option_Restart_Live,   0},
+  cli99_options_end()
+};
+
 struct {
   bool read_only;
+  bool live;
 } Start_Options = {0};
 
 int Start() {
@@ -24,5 +31,15 @@ int Stop() {
 
 int Restart() {
   check_root();
+
+  if (Start_Options.live) {
+    if (Start_Options.read_only) {
+      Log_Error("%s cannot be combined with %s\n", "-l|--live", "-r|--read-only");
+      return NBFC_EXIT_CMDLINE;
+    }
+
+    return Service_Reexec();
+  }
+
   return Service_Restart(Start_Options.read_only);
 }
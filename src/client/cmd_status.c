@@ -50,6 +50,12 @@ static void print_service_status(const ServiceInfo* service_info) {
     "Selected Config Name     : %s\n",
     bool_to_str(service_info->ReadOnly),
     service_info->SelectedConfigId);
+
+  if (ServiceInfo_IsSet_PowerPolicy(service_info))
+    printf("Power Policy             : %s\n", service_info->PowerPolicy);
+
+  if (ServiceInfo_IsSet_WakeupsPerMinute(service_info))
+    printf("Wakeups per Minute       : %.1f\n", service_info->WakeupsPerMinute);
 }
 
 int Status() {
@@ -1,19 +1,26 @@
-#include <stdio.h>        // snprintf
+#include <stdio.h>        // snprintf, fopen, fgets, fprintf, open_memstream
+#include <stdlib.h>       // getenv, free
 #include <string.h>       // strcmp, memcpy
+#include <strings.h>      // strncasecmp
 #include <fcntl.h>        // O_WRONLY, O_CREAT, O_TRUNC
+#include <inttypes.h>     // PRId64, SCNd64
+#include <pthread.h>      // pthread_create, pthread_join
+#include <unistd.h>       // sysconf, unlink
 #include <sys/stat.h>     // S_IRUSR, S_IRGRP, S_IROTH etc.
 #include <linux/limits.h> // PATH_MAX
-#include <curl/curl.h>
-#include <openssl/sha.h>
 
 #include "../nbfc.h"
 #include "../log.h"
 #include "../macros.h"
 #include "../memory.h"
 #include "../nxjson_utils.h"
+#include "../file_utils.h"
 
 #include "check_root.h"
 #include "client_global.h"
+#include "str_set.h"
+#include "model_support_index.h"
+#include "update_libs.h"
 
 #define UpdateParallelDefault 10
 
@@ -28,18 +35,35 @@
 #define UpdateAPIModelSupportURL \
   "https://raw.githubusercontent.com/nbfc-linux/configs/main/" UpdateConfigVersion "/model_support.json"
 
+#define UpdateArchiveURL \
+  "https://codeload.github.com/nbfc-linux/configs/tar.gz/refs/heads/main"
+
+// Environment variables for overriding the URLs above.
+// Only honored in test builds (-DNBFC_UPDATE_TEST, see tools/test-update.py).
+#define UpdateAPIContentsURLEnv     "NBFC_UPDATE_CONTENTS_URL"
+#define UpdateAPIModelSupportURLEnv "NBFC_UPDATE_MODEL_SUPPORT_URL"
+#define UpdateArchiveURLEnv         "NBFC_UPDATE_ARCHIVE_URL"
+
+// Files inside the archive are skipped if they are bigger than this
+#define UpdateArchiveMaxFileSize (4 * 1024 * 1024)
+
+#define UpdateFileMode (S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH)
+
 const cli99_option update_options[] = {
   cli99_include_options(&main_options),
   {"-p|--parallel", Option_Update_Parallel, 1},
   {"-q|--quiet",    Option_Update_Quiet,    0},
+  {"-a|--archive",  Option_Update_Archive,  0},
   cli99_options_end()
 };
 
 struct {
   int  parallel;
   bool quiet;
+  bool archive;
 } Update_Options = {
   UpdateParallelDefault,
+  false,
   false
 };
 
@@ -49,6 +73,8 @@ struct CurlMemory {
   size_t size;
   char*  url;  // (optional) stores original URL
   char*  path; // (optional) stores a file path
+  char*  etag; // ETag header of the response (or NULL)
+  struct GitHubFile* file; // (optional) file being downloaded
 };
 typedef struct CurlMemory CurlMemory;
 
@@ -66,10 +92,43 @@ struct GitHubFile {
   char* sha;
   char* download_url;
   FileState state;
+  char* local_path;    // Existing local copy of the file (or NULL)
+  char* local_sha;     // Git SHA1 sum of the local copy (NULL if unknown)
+  int64_t local_size;
+  int64_t local_mtime;
+  bool downloaded;
 };
 typedef struct GitHubFile GitHubFile;
 declare_array_of(GitHubFile);
 
+// Cached Git SHA1 sum of a local configuration file.
+// The cached sum is only used if size and mtime of the file did not change.
+struct ManifestEntry {
+  char*   path;
+  char    sha[SHA_DIGEST_LENGTH * 2 + 1];
+  int64_t size;
+  int64_t mtime; // Nanoseconds, see Stat_GetMTime()
+};
+typedef struct ManifestEntry ManifestEntry;
+declare_array_of(ManifestEntry);
+
+struct Manifest {
+  array_of(ManifestEntry) entries;
+  StrSet                  paths;
+};
+typedef struct Manifest Manifest;
+
+static inline const char* Update_Get_URL(const char* env, const char* url) {
+#ifdef NBFC_UPDATE_TEST
+  const char* value = getenv(env);
+  if (value)
+    return value;
+#else
+  (void) env;
+#endif
+  return url;
+}
+
 static inline void Log_Download_Finished(const char* url) {
   if (! Update_Options.quiet)
     Log_Info("Finished downloading %s\n", url);
@@ -83,6 +142,27 @@ static inline void Log_Write_Failed(const char* path, int err) {
   Log_Error("Write failed: %s: %s\n", path, strerror(err));
 }
 
+static inline void Log_HTTP_Failed(const char* url, long status) {
+  Log_Error("Download failed: %s (HTTP status %ld)\n", url, status);
+}
+
+// Read the whole `file` into a newly allocated, NUL terminated buffer.
+// Returns NULL on failure.
+static char* Update_Read_File(const char* file) {
+  struct stat st;
+
+  if (stat(file, &st) == -1)
+    return NULL;
+
+  char* buf = Mem_Malloc(st.st_size + 1);
+  if (slurp_file(buf, st.st_size + 1, file) == -1) {
+    Mem_Free(buf);
+    return NULL;
+  }
+
+  return buf;
+}
+
 // Callback function for `curl_easy_perform()`
 static size_t Curl_Write_Memory_Callback(char* data, size_t size, size_t nmemb, void* clientp)
 {
@@ -97,6 +177,31 @@ static size_t Curl_Write_Memory_Callback(char* data, size_t size, size_t nmemb,
   return realsize;
 }
 
+// Header callback for `curl_easy_perform()`, stores the ETag in the CurlMemory
+static size_t Curl_Header_Callback(char* data, size_t size, size_t nitems, void* clientp)
+{
+  const size_t realsize = size * nitems;
+  CurlMemory* mem = (CurlMemory*) clientp;
+
+  if (realsize > 5 && !strncasecmp(data, "ETag:", 5)) {
+    const char* value = data + 5;
+    size_t len = realsize - 5;
+
+    while (len && (*value == ' ' || *value == '\t'))
+      ++value, --len;
+
+    while (len && (value[len - 1] == '\r' || value[len - 1] == '\n' || value[len - 1] == ' '))
+      --len;
+
+    Mem_Free(mem->etag);
+    mem->etag = Mem_Malloc(len + 1);
+    memcpy(mem->etag, value, len);
+    mem->etag[len] = '\0';
+  }
+
+  return realsize;
+}
+
 // Create a CURL instance with a CurlMemory attached to it
 static CURL* CurlWithMem_Create(const char* url, const char* path) {
   CURL* curl = curl_easy_init();
@@ -114,6 +219,8 @@ static CURL* CurlWithMem_Create(const char* url, const char* path) {
   curl_easy_setopt(curl, CURLOPT_USERAGENT, UserAgent);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Curl_Write_Memory_Callback);
   curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) mem);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, Curl_Header_Callback);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void*) mem);
   curl_easy_setopt(curl, CURLOPT_PRIVATE, (void*) mem);
 
   return curl;
@@ -127,15 +234,14 @@ static void CurlWithMem_Destroy(CURL* curl) {
   Mem_Free(mem->data);
   Mem_Free(mem->url);
   Mem_Free(mem->path);
+  Mem_Free(mem->etag);
   Mem_Free(mem);
 
   curl_easy_cleanup(curl);
 }
 
 static int CurlMemory_WriteFile(const CurlMemory* mem) {
-  const int open_flags = O_WRONLY|O_CREAT|O_TRUNC;
-  const int mode_flags = S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH;
-  return write_file(mem->path, open_flags, mode_flags, mem->data, mem->size);
+  return write_file_atomic(mem->path, UpdateFileMode, mem->data, mem->size);
 }
 
 // Write the CurlMemory data to its path
@@ -145,11 +251,6 @@ static int CurlWithMem_WriteFile(CURL* curl) {
   return CurlMemory_WriteFile(mem);
 }
 
-// Return true if file exists
-static inline bool file_exists(const char* path) {
-  return (access(path, F_OK) == 0);
-}
-
 // Compute SHA1 sum of `data` with the size of `len` and store a string
 // representation of the hash in `out`
 static void compute_sha1(const char* data, size_t len, char* out) {
@@ -162,13 +263,12 @@ static void compute_sha1(const char* data, size_t len, char* out) {
   }
 }
 
-// Checks if `path` equals `sha1sum`.
+// Compute the Git SHA1 sum of `path` and store it in `out`.
 // Note: This is actually the checksum of the contents of the file including
 //       a header: `<SIZE>\0<CONTENT>`
-static bool File_Equals_Git_SHA1_Sum(const char* path, const char* sha1sum) {
+static bool File_Git_SHA1_Sum(const char* path, char* out) {
   char buf[NBFC_MAX_FILE_SIZE];
   char size_plus_content[NBFC_MAX_FILE_SIZE + 64];
-  char hash[SHA_DIGEST_LENGTH * 2 + 1] = {0};
 
   if (slurp_file(buf, sizeof(buf), path) == -1) {
     Log_Error("Error reading file: %s: %s\n", path, strerror(errno));
@@ -178,44 +278,220 @@ static bool File_Equals_Git_SHA1_Sum(const char* path, const char* sha1sum) {
   int len = snprintf(size_plus_content, sizeof(size_plus_content), "blob %lu%c%s",
     strlen(buf), 0, buf);
 
-  compute_sha1(size_plus_content, len, hash);
+  compute_sha1(size_plus_content, len, out);
+  return true;
+}
+
+// Load the manifest file. A missing or broken manifest results in an empty manifest.
+//
+// Each line of the manifest holds `<SHA1>\t<SIZE>\t<MTIME>\t<PATH>`.
+// MTIME is in nanoseconds.
+static void Manifest_Load(Manifest* self, const char* file) {
+  char line[PATH_MAX + 128];
+  ssize_t capacity = 512;
+
+  my.entries.data = Mem_Malloc(capacity * sizeof(ManifestEntry));
+  my.entries.size = 0;
+  StrSet_Init(&my.paths, capacity);
+
+  FILE* fh = fopen(file, "r");
+  if (! fh)
+    return;
+
+  while (fgets(line, sizeof(line), fh)) {
+    ManifestEntry entry;
+    char path[PATH_MAX];
+
+    if (sscanf(line, "%40[0-9a-f]\t%" SCNd64 "\t%" SCNd64 "\t%4095[^\n]",
+          entry.sha, &entry.size, &entry.mtime, path) != 4)
+      continue;
+
+    if (my.entries.size == capacity) {
+      capacity *= 2;
+      my.entries.data = Mem_Realloc(my.entries.data, capacity * sizeof(ManifestEntry));
+    }
 
-  return !strcmp(sha1sum, hash);
+    entry.path = Mem_Strdup(path);
+    my.entries.data[my.entries.size++] = entry;
+  }
+
+  fclose(fh);
+
+  // Index the entries. Since the paths are stored in the entries,
+  // the set has to be built after the array has stopped growing.
+  // The id of a path is its index in `entries`, so a duplicate path is
+  // dropped and the first entry is kept.
+  ssize_t size = 0;
+  for_each_array(ManifestEntry*, entry, my.entries) {
+    if (StrSet_Add(&my.paths, entry->path, NULL))
+      my.entries.data[size++] = *entry;
+    else
+      Mem_Free(entry->path);
+  }
+  my.entries.size = size;
 }
 
-// Checks if each file in `files` is either a new file (not present in any
-// configuration directory) or is different to existing files or does not
-// need an update at all.
-static void Files_Set_FileState(array_of(GitHubFile)* files) {
-  char path[PATH_MAX];
+static void Manifest_Free(Manifest* self) {
+  for_each_array(ManifestEntry*, entry, my.entries)
+    Mem_Free(entry->path);
+  Mem_Free(my.entries.data);
+  StrSet_Free(&my.paths);
+}
 
-  for_each_array(GitHubFile*, file, *files) {
-    snprintf(path, sizeof(path), "%s/%s", NBFC_MODEL_CONFIGS_DIR_MUTABLE, file->name);
-    if (file_exists(path)) {
-      if (File_Equals_Git_SHA1_Sum(path, file->sha)) {
-        file->state = FileState_UpToDate;
-        continue;
-      }
-      else {
-        file->state = FileState_Changed;
-        continue;
-      }
+// The modification time in nanoseconds. Seconds would miss an edit within the same second.
+static inline int64_t Stat_GetMTime(const struct stat* st) {
+  return (int64_t) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+// Return the cached SHA1 sum of `path` if size and mtime are unchanged, otherwise NULL
+static const char* Manifest_Lookup(const Manifest* self, const char* path, const struct stat* st) {
+  const ssize_t id = StrSet_Find(&my.paths, path);
+  if (id == -1)
+    return NULL;
+
+  const ManifestEntry* entry = &my.entries.data[id];
+  if (entry->size != st->st_size || entry->mtime != Stat_GetMTime(st))
+    return NULL;
+
+  return entry->sha;
+}
+
+static void Manifest_WriteEntry(FILE* fh, const char* path, const char* sha, int64_t size, int64_t mtime) {
+  fprintf(fh, "%s\t%" PRId64 "\t%" PRId64 "\t%s\n", sha, size, mtime, path);
+}
+
+// Write the manifest for `files` atomically to `file`
+static int Manifest_Write(array_of(GitHubFile)* files, const char* file) {
+  char* content = NULL;
+  size_t size = 0;
+
+  FILE* fh = open_memstream(&content, &size);
+  if (! fh)
+    return -1;
+
+  for_each_array(GitHubFile*, f, *files) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", NBFC_MODEL_CONFIGS_DIR_MUTABLE, f->name);
+
+    if (f->local_path && f->local_sha && !(f->downloaded && !strcmp(f->local_path, path)))
+      Manifest_WriteEntry(fh, f->local_path, f->local_sha, f->local_size, f->local_mtime);
+
+    if (f->downloaded) {
+      struct stat st;
+      if (stat(path, &st) == 0)
+        Manifest_WriteEntry(fh, path, f->sha, st.st_size, Stat_GetMTime(&st));
     }
+  }
 
-    snprintf(path, sizeof(path), "%s/%s", NBFC_MODEL_CONFIGS_DIR, file->name);
-    if (file_exists(path)) {
-      if (File_Equals_Git_SHA1_Sum(path, file->sha)) {
-        file->state = FileState_UpToDate;
-        continue;
-      }
-      else {
-        file->state = FileState_Changed;
-        continue;
-      }
+  int ret = -1;
+  if (fclose(fh) == 0)
+    ret = write_file_atomic(file, UpdateFileMode, content, size);
+
+  free(content);
+  return ret;
+}
+
+// Shared state of the hashing threads
+struct HashJobs {
+  GitHubFile** files;
+  ssize_t      size;
+  ssize_t      next;
+};
+typedef struct HashJobs HashJobs;
+
+static void* Hash_Worker(void* arg) {
+  HashJobs* jobs = arg;
+  ssize_t i;
+
+  while ((i = __atomic_fetch_add(&jobs->next, 1, __ATOMIC_RELAXED)) < jobs->size) {
+    GitHubFile* file = jobs->files[i];
+    char hash[SHA_DIGEST_LENGTH * 2 + 1] = {0};
+
+    if (File_Git_SHA1_Sum(file->local_path, hash))
+      file->local_sha = Mem_Strdup(hash);
+  }
+
+  return NULL;
+}
+
+// Compute the SHA1 sums of the local files of `jobs`, using one thread per CPU
+static void Hash_Files(HashJobs* jobs) {
+  pthread_t threads[64];
+  long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  n_threads = max(1, min(n_threads, min(jobs->size, ARRAY_SSIZE(threads))));
+
+  long started = 0;
+  for (; started < n_threads - 1; ++started)
+    if (pthread_create(&threads[started], NULL, Hash_Worker, jobs))
+      break;
+
+  Hash_Worker(jobs);
+
+  for (long i = 0; i < started; ++i)
+    pthread_join(threads[i], NULL);
+}
+
+// Find the local copy of `file` and take its SHA1 sum from `manifest` if possible.
+// Returns true if the local copy exists but its SHA1 sum still has to be computed.
+static bool File_Set_LocalState(GitHubFile* file, const Manifest* manifest) {
+  const char* dirs[] = { NBFC_MODEL_CONFIGS_DIR_MUTABLE, NBFC_MODEL_CONFIGS_DIR };
+  char path[PATH_MAX];
+  struct stat st;
+
+  for (int i = 0; i < ARRAY_SSIZE(dirs); ++i) {
+    snprintf(path, sizeof(path), "%s/%s", dirs[i], file->name);
+    if (stat(path, &st) == -1)
+      continue;
+
+    file->local_path = Mem_Strdup(path);
+    file->local_size = st.st_size;
+    file->local_mtime = Stat_GetMTime(&st);
+
+    const char* sha = Manifest_Lookup(manifest, path, &st);
+    if (sha) {
+      file->local_sha = Mem_Strdup(sha);
+      return false;
     }
 
+    return true;
+  }
+
+  return false;
+}
+
+// Set the state of `file` by comparing the remote and the local SHA1 sum
+static void File_Set_FileState(GitHubFile* file) {
+  if (! file->local_path)
     file->state = FileState_New;
+  else if (file->local_sha && !strcmp(file->local_sha, file->sha))
+    file->state = FileState_UpToDate;
+  else
+    file->state = FileState_Changed;
+}
+
+// Checks if each file in `files` is either a new file (not present in any
+// configuration directory) or is different to existing files or does not
+// need an update at all.
+//
+// SHA1 sums of local files are taken from `manifest` if the files did not
+// change since, the remaining files are hashed in parallel.
+static void Files_Set_FileState(array_of(GitHubFile)* files, const Manifest* manifest) {
+  HashJobs jobs = {
+    .files = Mem_Malloc(files->size * sizeof(GitHubFile*)),
+    .size = 0,
+    .next = 0
+  };
+
+  for_each_array(GitHubFile*, file, *files) {
+    if (File_Set_LocalState(file, manifest))
+      jobs.files[jobs.size++] = file;
   }
+
+  Hash_Files(&jobs);
+  Mem_Free(jobs.files);
+
+  for_each_array(GitHubFile*, file, *files)
+    File_Set_FileState(file);
 }
 
 // Print a short summary
@@ -250,8 +526,14 @@ next_file:
   const char* file = files->data[*iter].name;
   char path[PATH_MAX];
   snprintf(path, sizeof(path), "%s/%s", NBFC_MODEL_CONFIGS_DIR_MUTABLE, file);
+  GitHubFile* github_file = &files->data[*iter];
   ++*iter;
-  return CurlWithMem_Create(url, path);
+
+  CURL* curl = CurlWithMem_Create(url, path);
+  CurlMemory* mem;
+  curl_easy_getinfo(curl, CURLINFO_PRIVATE, &mem);
+  mem->file = github_file;
+  return curl;
 }
 
 static int Curl_Parallel_Download_Files(array_of(GitHubFile)* files, int parallel) {
@@ -302,16 +584,26 @@ static int Curl_Parallel_Download_Files(array_of(GitHubFile)* files, int paralle
         CurlMemory* mem;
         curl_easy_getinfo(easy, CURLINFO_PRIVATE, &mem);
 
+        long status = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+
         if (code != CURLE_OK) {
           Log_Download_Failed(mem->url, code);
           ret = -1;
         }
+        else if (status != 200) {
+          Log_HTTP_Failed(mem->url, status);
+          ret = -1;
+        }
         else {
           Log_Download_Finished(mem->url);
           if (CurlMemory_WriteFile(mem) == -1) {
             Log_Write_Failed(mem->path, errno);
             ret = -1;
           }
+          else if (mem->file) {
+            mem->file->downloaded = true;
+          }
         }
 
         curl_multi_remove_handle(multi, easy);
@@ -330,43 +622,111 @@ static int Curl_Parallel_Download_Files(array_of(GitHubFile)* files, int paralle
   return ret;
 }
 
-// Download `url`, parse the content as JSON and fill up the array specified
-// in `out`.
+/*
+ * Download `url` to `cache_file` unless the local copy is still up to date.
+ *
+ * The ETag of the last download is stored in `<cache_file>.etag` and sent
+ * in an `If-None-Match` header, so the server can answer with
+ * `304 Not Modified` instead of sending the content again.
+ *
+ * `headers` is a NULL terminated list of additional HTTP headers (or NULL).
+ *
+ * Return 1 if `cache_file` was updated, 0 if it is up to date and -1 on failure.
+ */
+static int Curl_Download_If_Modified(const char* url, const char* cache_file, const char** headers) {
+  int ret = 1;
+  char etag_file[PATH_MAX];
+  char etag[256];
+  char if_none_match[sizeof(etag) + 32];
+  struct curl_slist* header_list = NULL;
+  long status = 0;
+
+  snprintf(etag_file, sizeof(etag_file), "%s.etag", cache_file);
+
+  for (; headers && *headers; ++headers)
+    header_list = curl_slist_append(header_list, *headers);
+
+  if (access(cache_file, F_OK) == 0 && slurp_file(etag, sizeof(etag), etag_file) > 0) {
+    snprintf(if_none_match, sizeof(if_none_match), "If-None-Match: %s", etag);
+    header_list = curl_slist_append(header_list, if_none_match);
+  }
+
+  CURL* curl = CurlWithMem_Create(url, cache_file);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+  CURLcode code = curl_easy_perform(curl);
+  curl_slist_free_all(header_list);
+
+  if (code != CURLE_OK) {
+    Log_Download_Failed(url, code);
+    ret = -1;
+    goto end;
+  }
+
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+  if (status == 304) {
+    if (! Update_Options.quiet)
+      Log_Info("Not modified: %s\n", url);
+    ret = 0;
+    goto end;
+  }
+
+  if (status != 200) {
+    Log_HTTP_Failed(url, status);
+    ret = -1;
+    goto end;
+  }
+
+  Log_Download_Finished(url);
+
+  if (CurlWithMem_WriteFile(curl) == -1) {
+    Log_Write_Failed(cache_file, errno);
+    ret = -1;
+    goto end;
+  }
+
+  CurlMemory* mem;
+  curl_easy_getinfo(curl, CURLINFO_PRIVATE, &mem);
+
+  if (! mem->etag || write_file_atomic(etag_file, UpdateFileMode, mem->etag, strlen(mem->etag)) == -1)
+    unlink(etag_file);
+
+end:
+  CurlWithMem_Destroy(curl);
+  return ret;
+}
+
+// Get the file listing of `url` (using NBFC_UPDATE_LISTING as cache), parse
+// the content as JSON and fill up the array specified in `out`.
 //
 // Return 0 on success and -1 on failure.
 //
 // Note: `out` has to be freed regardless of the return code.
 static int GitHub_Get_Dir_Contents(const char* url, array_of(GitHubFile)* out) {
   int ret = 0;
-  CURL* curl = NULL;
   char* data = NULL;
   const nx_json* root = NULL;
   ssize_t out_capacity = 512;
+  const char* headers[] = {
+    "Accept: application/vnd.github+json",
+    "X-GitHub-Api-Version: 2022-11-28",
+    NULL
+  };
 
   out->data = Mem_Malloc(out_capacity * sizeof(GitHubFile));
   out->size = 0;
 
-  curl = CurlWithMem_Create(url, NULL);
-
-  struct curl_slist* headers = NULL;
-  headers = curl_slist_append(headers, "Accept: application/vnd.github+json");
-  headers = curl_slist_append(headers, "X-GitHub-Api-Version: 2022-11-28");
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  CURLcode code = curl_easy_perform(curl);
-  curl_slist_free_all(headers);
-
-  if (code != CURLE_OK) {
-    Log_Download_Failed(url, code);
+  if (Curl_Download_If_Modified(url, NBFC_UPDATE_LISTING, headers) == -1) {
     ret = -1;
     goto end;
   }
-  Log_Download_Finished(url);
 
-  CurlMemory* mem;
-  curl_easy_getinfo(curl, CURLINFO_PRIVATE, &mem);
-  data = mem->data;
-  mem->data = NULL;
-  CurlWithMem_Destroy(curl);
+  data = Update_Read_File(NBFC_UPDATE_LISTING);
+  if (! data) {
+    Log_Error("%s: %s\n", NBFC_UPDATE_LISTING, strerror(errno));
+    ret = -1;
+    goto end;
+  }
 
   root = nx_json_parse_utf8(data);
 
@@ -423,9 +783,11 @@ static int GitHub_Get_Dir_Contents(const char* url, array_of(GitHubFile)* out) {
       out->data = Mem_Realloc(out->data, out_capacity * sizeof(GitHubFile));
     }
 
-    out->data[out->size].name = Mem_Strdup(name);
-    out->data[out->size].sha = Mem_Strdup(sha);
-    out->data[out->size].download_url = Mem_Strdup(download_url);
+    out->data[out->size] = (GitHubFile) {
+      .name = Mem_Strdup(name),
+      .sha = Mem_Strdup(sha),
+      .download_url = Mem_Strdup(download_url)
+    };
     out->size++;
   }
 
@@ -437,43 +799,27 @@ end:
 
 // Update compatibility database (model_config.json)
 static int UpdateModelCompatibilityDatabase() {
-  int ret = 0;
-  CURL* curl = CurlWithMem_Create(UpdateAPIModelSupportURL, NBFC_MODEL_SUPPORT_FILE_MUTABLE);
-  CURLcode code = curl_easy_perform(curl);
-
-  if (code != CURLE_OK) {
-    Log_Download_Failed(UpdateAPIModelSupportURL, code);
-    ret = -1;
-    goto end;
-  }
-
-  Log_Download_Finished(UpdateAPIModelSupportURL);
-
-  if (CurlWithMem_WriteFile(curl) == -1) {
-    Log_Write_Failed(NBFC_MODEL_SUPPORT_FILE_MUTABLE, errno);
-    ret = -1;
-    goto end;
-  }
-
-end:
-  CurlWithMem_Destroy(curl);
-  return ret;
+  const char* url = Update_Get_URL(UpdateAPIModelSupportURLEnv, UpdateAPIModelSupportURL);
+  return (Curl_Download_If_Modified(url, NBFC_MODEL_SUPPORT_FILE_MUTABLE, NULL) == -1) ? -1 : 0;
 }
 
 // Update configuration files
 static int UpdateConfigurationFiles() {
   int ret = 0;
   array_of(GitHubFile) files = {0};
+  Manifest manifest;
+
+  Manifest_Load(&manifest, NBFC_UPDATE_MANIFEST);
 
   // Get a list of configuration files in the GitHub repository
-  if (GitHub_Get_Dir_Contents(UpdateAPIContentsURL, &files) == -1) {
+  if (GitHub_Get_Dir_Contents(Update_Get_URL(UpdateAPIContentsURLEnv, UpdateAPIContentsURL), &files) == -1) {
     Log_Error("Failed to download configuration file list\n");
     ret = -1;
     goto end;
   }
 
   // Check which files shall be updated (setting GitHubFile->state)
-  Files_Set_FileState(&files);
+  Files_Set_FileState(&files, &manifest);
 
   // Print a summary
   Print_Summary(&files);
@@ -484,34 +830,437 @@ static int UpdateConfigurationFiles() {
     ret = -1;
   }
 
+  if (Manifest_Write(&files, NBFC_UPDATE_MANIFEST) == -1)
+    Log_Warn("Could not write %s: %s\n", NBFC_UPDATE_MANIFEST, strerror(errno));
+
 end:
+  Manifest_Free(&manifest);
   for_each_array(GitHubFile*, file, files) {
     Mem_Free(file->name);
     Mem_Free(file->download_url);
     Mem_Free(file->sha);
+    Mem_Free(file->local_path);
+    Mem_Free(file->local_sha);
   }
   Mem_Free(files.data);
   return ret;
 }
 
+// ============================================================================
+// Archive mode
+// ============================================================================
+
+// State of the streaming extraction of the configuration archive (.tar.gz)
+struct ArchiveUpdate {
+  z_stream    zstream;
+  int         zstatus;
+  // Tar parser
+  enum {
+    Tar_Header,
+    Tar_Data,
+    Tar_Padding,
+    Tar_End
+  }           tar_state;
+  char        header[512];
+  size_t      header_fill;
+  char        type;
+  char        path[PATH_MAX];
+  char        long_path[PATH_MAX]; // Path from a preceding pax or GNU long name header
+  uint64_t    remaining;           // Data bytes left of the current entry
+  size_t      padding;             // Padding bytes left of the current entry
+  char*       data;                // Data of the current entry (NULL if it is skipped)
+  size_t      data_size;
+  // Result
+  const Manifest*      manifest;
+  array_of(GitHubFile) files;
+  ssize_t              files_capacity;
+  bool                 have_model_support;
+  int                  ret;
+};
+typedef struct ArchiveUpdate ArchiveUpdate;
+
+// Return the path of `path` relative to the version directory inside the archive
+// (stripping the leading `<repository>-<branch>/<version>/`) or NULL.
+static const char* Archive_Relative_Path(const char* path) {
+  const char* slash = strchr(path, '/');
+  if (! slash)
+    return NULL;
+
+  path = slash + 1;
+  const size_t len = strlen(UpdateConfigVersion "/");
+  if (strncmp(path, UpdateConfigVersion "/", len))
+    return NULL;
+
+  return path + len;
+}
+
+// Return the name of the configuration file if `path` refers to one, otherwise NULL
+static const char* Archive_Config_Name(const char* path) {
+  const char* rel = Archive_Relative_Path(path);
+  if (! rel || strncmp(rel, "configs/", 8))
+    return NULL;
+
+  rel += 8;
+  if (! *rel || strchr(rel, '/'))
+    return NULL;
+
+  return rel;
+}
+
+static bool Archive_Is_Model_Support(const char* path) {
+  const char* rel = Archive_Relative_Path(path);
+  return rel && !strcmp(rel, "model_support.json");
+}
+
+static uint64_t Tar_Parse_Octal(const char* s, size_t size) {
+  uint64_t value = 0;
+
+  for (; size && (*s == ' ' || *s == '\0'); ++s, --size);
+  for (; size && *s >= '0' && *s <= '7'; ++s, --size)
+    value = value * 8 + (*s - '0');
+
+  return value;
+}
+
+// Take the `path` record out of a pax extended header
+static void Tar_Parse_Pax(ArchiveUpdate* self) {
+  const char* p = my.data;
+  const char* end = my.data + my.data_size;
+
+  while (p < end) {
+    char* record;
+    const unsigned long len = strtoul(p, &record, 10);
+    if (! len || p + len > end || *record != ' ')
+      return;
+
+    ++record;
+    if (! strncmp(record, "path=", 5)) {
+      const char* value = record + 5;
+      const size_t value_len = (p + len - 1) - value; // without trailing newline
+      if (value_len < sizeof(my.long_path)) {
+        memcpy(my.long_path, value, value_len);
+        my.long_path[value_len] = '\0';
+      }
+    }
+
+    p += len;
+  }
+}
+
+// Handle a configuration file found in the archive
+static void Archive_Config_File(ArchiveUpdate* self, const char* name) {
+  char path[PATH_MAX];
+  char sha[SHA_DIGEST_LENGTH * 2 + 1];
+
+  // Git SHA1 sum of the content, the same as the GitHub API would report
+  char* blob = Mem_Malloc(my.data_size + 64);
+  const int header_len = snprintf(blob, 64, "blob %zu", my.data_size) + 1;
+  memcpy(blob + header_len, my.data, my.data_size);
+  compute_sha1(blob, header_len + my.data_size, sha);
+  Mem_Free(blob);
+
+  if (my.files.size == my.files_capacity) {
+    my.files_capacity *= 2;
+    my.files.data = Mem_Realloc(my.files.data, my.files_capacity * sizeof(GitHubFile));
+  }
+
+  GitHubFile* file = &my.files.data[my.files.size++];
+  *file = (GitHubFile) {
+    .name = Mem_Strdup(name),
+    .sha = Mem_Strdup(sha)
+  };
+
+  if (File_Set_LocalState(file, my.manifest)) {
+    char local_sha[SHA_DIGEST_LENGTH * 2 + 1] = {0};
+    if (File_Git_SHA1_Sum(file->local_path, local_sha))
+      file->local_sha = Mem_Strdup(local_sha);
+  }
+
+  File_Set_FileState(file);
+
+  if (file->state == FileState_UpToDate)
+    return;
+
+  snprintf(path, sizeof(path), "%s/%s", NBFC_MODEL_CONFIGS_DIR_MUTABLE, name);
+  if (write_file_atomic(path, UpdateFileMode, my.data, my.data_size) == -1) {
+    Log_Write_Failed(path, errno);
+    my.ret = -1;
+    return;
+  }
+
+  file->downloaded = true;
+  if (! Update_Options.quiet)
+    Log_Info("Extracted %s\n", name);
+}
+
+// Called when all data of an archive entry has been read
+static void Archive_Entry_Done(ArchiveUpdate* self) {
+  switch (my.type) {
+  case 'x': // pax extended header
+    Tar_Parse_Pax(self);
+    return;
+
+  case 'L': // GNU long name
+    snprintf(my.long_path, sizeof(my.long_path), "%s", my.data);
+    return;
+
+  case '0':
+  case '\0':
+    if (my.data) {
+      const char* name = Archive_Config_Name(my.path);
+      if (name)
+        Archive_Config_File(self, name);
+      else if (Archive_Is_Model_Support(my.path)) {
+        my.have_model_support = true;
+        if (write_file_atomic(NBFC_MODEL_SUPPORT_FILE_MUTABLE, UpdateFileMode, my.data, my.data_size) == -1) {
+          Log_Write_Failed(NBFC_MODEL_SUPPORT_FILE_MUTABLE, errno);
+          my.ret = -1;
+        }
+      }
+    }
+    break;
+  }
+
+  my.long_path[0] = '\0';
+}
+
+// Process a complete tar header block
+static void Tar_Header_Done(ArchiveUpdate* self) {
+  static const char zero_block[512];
+  const char* h = my.header;
+
+  if (! memcmp(h, zero_block, sizeof(zero_block))) {
+    my.tar_state = Tar_End;
+    return;
+  }
+
+  my.type = h[156];
+  my.remaining = Tar_Parse_Octal(h + 124, 12);
+  my.padding = (512 - my.remaining % 512) % 512;
+
+  if (my.long_path[0])
+    snprintf(my.path, sizeof(my.path), "%s", my.long_path);
+  else if (! strncmp(h + 257, "ustar", 5) && h[345])
+    snprintf(my.path, sizeof(my.path), "%.155s/%.100s", h + 345, h);
+  else
+    snprintf(my.path, sizeof(my.path), "%.100s", h);
+
+  // Only keep the data of entries we are interested in
+  bool keep = false;
+  if (my.type == 'x' || my.type == 'L')
+    keep = true;
+  else if ((my.type == '0' || my.type == '\0') &&
+           (Archive_Config_Name(my.path) || Archive_Is_Model_Support(my.path)))
+    keep = true;
+
+  if (keep && my.remaining > UpdateArchiveMaxFileSize) {
+    Log_Warn("Skipping %s: File too big\n", my.path);
+    keep = false;
+  }
+
+  Mem_Free(my.data);
+  my.data = keep ? Mem_Malloc(my.remaining + 1) : NULL;
+  my.data_size = 0;
+
+  if (my.remaining) {
+    my.tar_state = Tar_Data;
+  }
+  else {
+    if (my.data)
+      my.data[0] = '\0';
+    Archive_Entry_Done(self);
+    my.tar_state = Tar_Header;
+  }
+}
+
+// Feed decompressed data into the tar parser
+static void Tar_Feed(ArchiveUpdate* self, const char* buf, size_t len) {
+  while (len) {
+    size_t n;
+
+    switch (my.tar_state) {
+    case Tar_Header:
+      n = min(sizeof(my.header) - my.header_fill, len);
+      memcpy(my.header + my.header_fill, buf, n);
+      my.header_fill += n;
+      if (my.header_fill == sizeof(my.header)) {
+        my.header_fill = 0;
+        Tar_Header_Done(self);
+      }
+      break;
+
+    case Tar_Data:
+      n = min(my.remaining, len);
+      if (my.data) {
+        memcpy(my.data + my.data_size, buf, n);
+        my.data_size += n;
+      }
+      my.remaining -= n;
+      if (! my.remaining) {
+        if (my.data)
+          my.data[my.data_size] = '\0';
+        Archive_Entry_Done(self);
+        my.tar_state = my.padding ? Tar_Padding : Tar_Header;
+      }
+      break;
+
+    case Tar_Padding:
+      n = min(my.padding, len);
+      my.padding -= n;
+      if (! my.padding)
+        my.tar_state = Tar_Header;
+      break;
+
+    case Tar_End:
+    default:
+      return;
+    }
+
+    buf += n;
+    len -= n;
+  }
+}
+
+// Callback function for `curl_easy_perform()`, decompresses the received data
+static size_t Archive_Write_Callback(char* data, size_t size, size_t nmemb, void* clientp) {
+  const size_t realsize = size * nmemb;
+  ArchiveUpdate* self = (ArchiveUpdate*) clientp;
+  char out[16384];
+
+  if (my.zstatus == Z_STREAM_END)
+    return realsize;
+
+  my.zstream.next_in = (unsigned char*) data;
+  my.zstream.avail_in = realsize;
+
+  do {
+    my.zstream.next_out = (unsigned char*) out;
+    my.zstream.avail_out = sizeof(out);
+
+    my.zstatus = inflate(&my.zstream, Z_NO_FLUSH);
+    if (my.zstatus != Z_OK && my.zstatus != Z_STREAM_END) {
+      Log_Error("Invalid archive: %s\n", my.zstream.msg ? my.zstream.msg : zError(my.zstatus));
+      return 0; // Abort the transfer
+    }
+
+    Tar_Feed(self, out, sizeof(out) - my.zstream.avail_out);
+  } while (my.zstatus != Z_STREAM_END && (my.zstream.avail_in || !my.zstream.avail_out));
+
+  return realsize;
+}
+
+// Update the configuration files and the model support database by
+// downloading the whole repository as a single archive
+static int UpdateFromArchive() {
+  const char* url = Update_Get_URL(UpdateArchiveURLEnv, UpdateArchiveURL);
+  Manifest manifest;
+  ArchiveUpdate archive = {
+    .zstatus = Z_OK,
+    .tar_state = Tar_Header,
+    .manifest = &manifest,
+    .files_capacity = 512,
+    .ret = 0
+  };
+
+  archive.files.data = Mem_Malloc(archive.files_capacity * sizeof(GitHubFile));
+  Manifest_Load(&manifest, NBFC_UPDATE_MANIFEST);
+
+  // 16 + MAX_WBITS: Expect a gzip header
+  if (inflateInit2(&archive.zstream, 16 + MAX_WBITS) != Z_OK) {
+    Log_Error("inflateInit2() failed\n");
+    exit(NBFC_EXIT_FAILURE);
+  }
+
+  CURL* curl = curl_easy_init();
+  if (! curl) {
+    Log_Error("curl_easy_init() failed\n");
+    exit(NBFC_EXIT_FAILURE);
+  }
+
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, UserAgent);
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, Archive_Write_Callback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*) &archive);
+  CURLcode code = curl_easy_perform(curl);
+  curl_easy_cleanup(curl);
+
+  if (code != CURLE_OK) {
+    Log_Download_Failed(url, code);
+    archive.ret = -1;
+  }
+  else if (archive.zstatus != Z_STREAM_END || archive.tar_state != Tar_End) {
+    Log_Error("Archive is truncated: %s\n", url);
+    archive.ret = -1;
+  }
+  else {
+    Log_Download_Finished(url);
+
+    if (! archive.have_model_support) {
+      Log_Error("Archive does not contain the model support database\n");
+      archive.ret = -1;
+    }
+  }
+
+  Print_Summary(&archive.files);
+
+  if (Manifest_Write(&archive.files, NBFC_UPDATE_MANIFEST) == -1)
+    Log_Warn("Could not write %s: %s\n", NBFC_UPDATE_MANIFEST, strerror(errno));
+
+  inflateEnd(&archive.zstream);
+  Manifest_Free(&manifest);
+  Mem_Free(archive.data);
+  for_each_array(GitHubFile*, file, archive.files) {
+    Mem_Free(file->name);
+    Mem_Free(file->sha);
+    Mem_Free(file->local_path);
+    Mem_Free(file->local_sha);
+  }
+  Mem_Free(archive.files.data);
+  return archive.ret;
+}
+
 int Update() {
+#ifndef NBFC_UPDATE_TEST
   check_root();
+#endif
   int ret = NBFC_EXIT_SUCCESS;
 
+  Error* e = UpdateLibs_Load();
+  if (e) {
+    Log_Error("%s\n", err_print_all(e));
+    return NBFC_EXIT_FAILURE;
+  }
+
   if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
     Log_Error("curl_global_init() failed\n");
     return NBFC_EXIT_FAILURE;
   }
 
-  Log_Info("Updating model compatibility database ...\n");
-  if (UpdateModelCompatibilityDatabase() == -1)
-    ret = NBFC_EXIT_FAILURE;
+  if (Update_Options.archive) {
+    Log_Info("Updating configuration files from archive ...\n");
+    if (UpdateFromArchive() == -1)
+      ret = NBFC_EXIT_FAILURE;
+  }
+  else {
+    Log_Info("Updating model compatibility database ...\n");
+    if (UpdateModelCompatibilityDatabase() == -1)
+      ret = NBFC_EXIT_FAILURE;
+
+    Log_Info("Updating configuration files ...\n");
+    if (UpdateConfigurationFiles() == -1)
+      ret = NBFC_EXIT_FAILURE;
+  }
 
-  Log_Info("Updating configuration files ...\n");
-  if (UpdateConfigurationFiles() == -1)
-    ret = NBFC_EXIT_FAILURE;
-  
   curl_global_cleanup();
 
+  Log_Info("Updating model support index ...\n");
+  e = ModelSupportIndex_Build(NBFC_MODEL_SUPPORT_INDEX, NBFC_MODEL_SUPPORT_FILE, NBFC_MODEL_SUPPORT_FILE_MUTABLE);
+  if (e) {
+    Log_Error("%s\n", err_print_all(e));
+    ret = NBFC_EXIT_FAILURE;
+  }
+
   return ret;
 }
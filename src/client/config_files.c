@@ -9,8 +9,9 @@
 #include "../log.h"
 #include "../memory.h"
 #include "../nxjson_utils.h"
-#include "dmi.h"
 #include "str_functions.h"
+#include "str_set.h"
+#include "model_support_index.h"
 
 // Check if `files` contains a config named `name`
 bool Contains_Config(array_of(ConfigFile)* files, const char* name) {
@@ -36,8 +37,9 @@ int compare_config_by_name(const void *a, const void *b) {
 
 // Compare function for qsort
 int compare_config_by_diff(const void *a, const void *b) {
-  return (((struct ConfigFile *)b)->diff > ((struct ConfigFile *)a)->diff)
-       - (((struct ConfigFile *)b)->diff < ((struct ConfigFile *)a)->diff);
+  const int cmp = (((struct ConfigFile *)b)->diff > ((struct ConfigFile *)a)->diff)
+                - (((struct ConfigFile *)b)->diff < ((struct ConfigFile *)a)->diff);
+  return cmp ? cmp : compare_config_by_name(a, b);
 }
 
 // Return an array of ConfigFile for each file in `path`
@@ -84,16 +86,22 @@ static array_of(ConfigFile) Merge_Configs(array_of(ConfigFile)* a, array_of(Conf
     .size = 0
   };
 
+  StrSet names;
+  StrSet_Init(&names, a->size + b->size);
+
   for_each_array(ConfigFile*, file, *a) {
-    files.data[files.size++].config_name = Mem_Strdup(file->config_name);
+    if (StrSet_Add(&names, file->config_name, NULL)) {
+      files.data[files.size++].config_name = Mem_Strdup(file->config_name);
+    }
   }
 
   for_each_array(ConfigFile*, file, *b) {
-    if (! Contains_Config(&files, file->config_name)) {
+    if (StrSet_Add(&names, file->config_name, NULL)) {
       files.data[files.size++].config_name = Mem_Strdup(file->config_name);
     }
   }
 
+  StrSet_Free(&names);
   return files;
 }
 
@@ -115,16 +123,126 @@ array_of(ConfigFile) List_All_Configs() {
   return c;
 }
 
-// List all configs (in the static config directory as well as in the mutable config directory).
-// The `diff` field of the ConfigFile structure will also be set.
-array_of(ConfigFile) List_Recommended_Configs() {
-  const char* model_name = DMI_Get_Model_Name();
-  array_of(ConfigFile) files = List_All_Configs();
-  for_each_array(ConfigFile*, file, files) {
-    file->diff = str_similarity(model_name, file->config_name);
+// Return true if `a` is a better recommendation than `b`
+static inline bool ConfigFile_IsBetterMatch(const ConfigFile* a, const ConfigFile* b) {
+  if (a->diff != b->diff)
+    return a->diff > b->diff;
+  return strcmp(a->config_name, b->config_name) < 0;
+}
+
+// Restore the min-heap property (worst match at the root) starting at `i`
+static void ConfigHeap_SiftDown(array_of(ConfigFile)* heap, ssize_t i) {
+  for (;;) {
+    ssize_t worst = i;
+    const ssize_t left = 2 * i + 1;
+    const ssize_t right = 2 * i + 2;
+
+    if (left < heap->size && ConfigFile_IsBetterMatch(&heap->data[worst], &heap->data[left]))
+      worst = left;
+    if (right < heap->size && ConfigFile_IsBetterMatch(&heap->data[worst], &heap->data[right]))
+      worst = right;
+    if (worst == i)
+      return;
+
+    const ConfigFile tmp = heap->data[i];
+    heap->data[i] = heap->data[worst];
+    heap->data[worst] = tmp;
+    i = worst;
+  }
+}
+
+static void ConfigHeap_SiftUp(array_of(ConfigFile)* heap, ssize_t i) {
+  while (i > 0) {
+    const ssize_t parent = (i - 1) / 2;
+    if (! ConfigFile_IsBetterMatch(&heap->data[parent], &heap->data[i]))
+      return;
+
+    const ConfigFile tmp = heap->data[i];
+    heap->data[i] = heap->data[parent];
+    heap->data[parent] = tmp;
+    i = parent;
   }
-  qsort(files.data, files.size, sizeof(struct ConfigFile), compare_config_by_diff);
-  return files;
+}
+
+// Return the best matching configs in `files` for `model_name`.
+// Only configs with a similarity of at least `RecommendedConfigMatchThreshold` are returned,
+// at most `RecommendedConfigMaxResults`, sorted by their `diff` field (best match first).
+array_of(ConfigFile) List_Recommended_Configs(array_of(ConfigFile)* files, const char* model_name) {
+  array_of(ConfigFile) heap = {
+    .data = Mem_Malloc(RecommendedConfigMaxResults * sizeof(ConfigFile)),
+    .size = 0
+  };
+
+  FuzzyPattern pattern;
+  FuzzyPattern_Init(&pattern, model_name);
+
+  for_each_array(ConfigFile*, file, *files) {
+    const bool heap_is_full = (heap.size == RecommendedConfigMaxResults);
+
+    // Once the heap is full, only configs at least as good as the worst one are of interest
+    float min_similarity = RecommendedConfigMatchThreshold;
+    if (heap_is_full)
+      min_similarity = max(min_similarity, heap.data[0].diff);
+
+    ConfigFile candidate = {
+      .config_name = file->config_name,
+      .diff = FuzzyPattern_Similarity(&pattern, file->config_name, min_similarity)
+    };
+
+    if (candidate.diff < min_similarity)
+      continue;
+
+    if (! heap_is_full) {
+      candidate.config_name = Mem_Strdup(candidate.config_name);
+      heap.data[heap.size++] = candidate;
+      ConfigHeap_SiftUp(&heap, heap.size - 1);
+    }
+    else if (ConfigFile_IsBetterMatch(&candidate, &heap.data[0])) {
+      Mem_Free(heap.data[0].config_name);
+      candidate.config_name = Mem_Strdup(candidate.config_name);
+      heap.data[0] = candidate;
+      ConfigHeap_SiftDown(&heap, 0);
+    }
+  }
+
+  FuzzyPattern_Free(&pattern);
+  qsort(heap.data, heap.size, sizeof(struct ConfigFile), compare_config_by_diff);
+  return heap;
+}
+
+/*
+ * Check the result of a model support database lookup.
+ *
+ * `config` is the config that was found for `model_name` in `support_file`,
+ * or `NULL` if the model is not listed in the database.
+ *
+ * If the model is found in the support database, the function will check if
+ * the corresponding output config exists in the provided `config_names`.
+ * If a match is found, the output config is returned. Otherwise, a warning
+ * is printed and `NULL` is returned.
+ *
+ * If the input model is not found in the support database, the function
+ * attempts to find the config directly in `config_names` and returns it if
+ * a match is found.
+ *
+ * If there is no match, `NULL` is returned.
+ */
+static char* Resolve_Supported_Config(const char* support_file, const StrSet* config_names, const char* model_name, const char* config) {
+  if (config) {
+    // Ensure that the model actually exists
+    if (StrSet_Find(config_names, config) != -1)
+      return Mem_Strdup(config);
+
+    Log_Warn("%s: The model `%s` was found in the support database, but the specified configuration file (`%s`) is missing\n",
+        support_file, model_name, config);
+  }
+  else {
+    // Not found in support database, try a direct match on `config_names`
+    if (StrSet_Find(config_names, model_name) != -1)
+      return Mem_Strdup(model_name);
+  }
+
+  return NULL;
 }
 
 /*
@@ -140,21 +258,12 @@ array_of(ConfigFile) List_Recommended_Configs() {
  *     "Input Model Name": "Output Config"
  *  }
  *
- * If the model is found in the support database, the function will check if
- * the corresponding output config exists in the provided `config_files`.
- * If a match is found, the output config is returned. Otherwise, a warning
- * is printed and `NULL` is returned.
- *
- * If the input model is not found in the support database, the function
- * attempts to find the config directly in `config_files` and returns it if
- * a match is found.
- *
- * If there is no match, `NULL` is returned.
+ * See `Resolve_Supported_Config()` for the return value.
  */
-char* Get_Supported_Config_From_SupportFile(const char* support_file, array_of(ConfigFile)* config_files, const char* model_name) {
+static char* Get_Supported_Config_From_SupportFile(const char* support_file, const StrSet* config_names, const char* model_name) {
   char buf[NBFC_MAX_FILE_SIZE];
   const nx_json* root = NULL;
-  char* config = NULL;
+  const char* config = NULL;
 
   Error* e = nx_json_parse_file(&root, buf, sizeof(buf), support_file);
   if (e) {
@@ -175,46 +284,63 @@ char* Get_Supported_Config_From_SupportFile(const char* support_file, array_of(C
       if (config) {
         Log_Warn("%s: Duplicate model key: `%s`\n", support_file, model->key);
       }
-      config = Mem_Strdup(model->val.text);
+      config = model->val.text;
     }
   }
 
-end:
+end:;
+  char* result = Resolve_Supported_Config(support_file, config_names, model_name, config);
   nx_json_free(root);
+  return result;
+}
 
-  if (config) {
-    // Ensure that the model actually exists
-    for_each_array(ConfigFile*, file, *config_files) {
-      if (!strcmp(file->config_name, config)) {
-        return config;
-      }
-    }
+/*
+ * Retrive the supported config for `model_name` using the model support index.
+ *
+ * Returns false if the index is missing or outdated. Otherwise `*config`
+ * receives the result (see `Resolve_Supported_Config()`).
+ */
+static bool Get_Supported_Config_From_Index(const StrSet* config_names, const char* model_name, char** config) {
+  ModelSupportIndex index;
+  const char* configs[ModelSupportIndex_DatabaseCount] = {0};
 
-    Log_Warn("%s: The model `%s` was found in the support database, but the specified configuration file (`%s`) is missing\n",
-        support_file, model_name, config);
+  Error* e = ModelSupportIndex_Open(&index,
+    NBFC_MODEL_SUPPORT_INDEX, NBFC_MODEL_SUPPORT_FILE, NBFC_MODEL_SUPPORT_FILE_MUTABLE);
+  if (e)
+    return false;
 
-    Mem_Free(config);
-  }
-  else {
-    // Not found in support database, try a direct match on `config_files`
-    for_each_array(ConfigFile*, file, *config_files) {
-      if (!strcmp(file->config_name, model_name)) {
-        return Mem_Strdup(model_name);
-      }
-    }
-  }
+  ModelSupportIndex_Find(&index, model_name, configs);
 
-  return NULL;
+  *config = NULL;
+
+  if (ModelSupportIndex_HasDatabase(&index, ModelSupportIndex_Mutable))
+    *config = Resolve_Supported_Config(NBFC_MODEL_SUPPORT_FILE_MUTABLE, config_names, model_name, configs[ModelSupportIndex_Mutable]);
+
+  if (! *config)
+    *config = Resolve_Supported_Config(NBFC_MODEL_SUPPORT_FILE, config_names, model_name, configs[ModelSupportIndex_Static]);
+
+  ModelSupportIndex_Close(&index);
+  return true;
 }
 
 char* Get_Supported_Config(array_of(ConfigFile)* files, const char* model) {
   char* config = NULL;
+  StrSet config_names;
+
+  StrSet_Init(&config_names, files->size);
+  for_each_array(ConfigFile*, file, *files)
+    StrSet_Add(&config_names, file->config_name, NULL);
+
+  if (Get_Supported_Config_From_Index(&config_names, model, &config))
+    goto end;
 
   if (access(NBFC_MODEL_SUPPORT_FILE_MUTABLE, F_OK) == 0)
-    config = Get_Supported_Config_From_SupportFile(NBFC_MODEL_SUPPORT_FILE_MUTABLE, files, model);
+    config = Get_Supported_Config_From_SupportFile(NBFC_MODEL_SUPPORT_FILE_MUTABLE, &config_names, model);
 
   if (! config)
-    config = Get_Supported_Config_From_SupportFile(NBFC_MODEL_SUPPORT_FILE, files, model);
+    config = Get_Supported_Config_From_SupportFile(NBFC_MODEL_SUPPORT_FILE, &config_names, model);
 
+end:
+  StrSet_Free(&config_names);
   return config;
 }
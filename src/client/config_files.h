@@ -4,6 +4,7 @@
 #include "../macros.h"
 
 #define RecommendedConfigMatchThreshold 0.7f
+#define RecommendedConfigMaxResults     32
 
 struct ConfigFile {
   char* config_name;
@@ -13,7 +14,7 @@ typedef struct ConfigFile ConfigFile;
 declare_array_of(ConfigFile);
 
 array_of(ConfigFile) List_All_Configs();
-array_of(ConfigFile) List_Recommended_Configs();
+array_of(ConfigFile) List_Recommended_Configs(array_of(ConfigFile)*, const char*);
 
 char* Get_Supported_Config(array_of(ConfigFile)*, const char*);
 bool  Contains_Config(array_of(ConfigFile)*, const char*);
@@ -0,0 +1,306 @@
+#include "model_support_index.h"
+
+#include <errno.h>    // errno, EINVAL
+#include <fcntl.h>    // open, O_RDONLY
+#include <stdlib.h>   // qsort
+#include <string.h>   // strcmp, strlen, memcpy, memcmp
+#include <unistd.h>   // close
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // stat, fstat
+
+#include "../log.h"
+#include "../macros.h"
+#include "../memory.h"
+#include "../nxjson_utils.h"
+#include "../file_utils.h"
+#include "str_set.h"
+
+static void ModelSupportIndex_StatSource(const char* file, ModelSupportIndex_Source* source) {
+  struct stat st;
+
+  if (stat(file, &st) == -1) {
+    source->size = -1;
+    source->mtime = 0;
+    source->inode = 0;
+    return;
+  }
+
+  source->size = st.st_size;
+  source->mtime = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+  source->inode = st.st_ino;
+}
+
+// Read the whole `file` into a newly allocated, NUL terminated buffer
+static Error* ModelSupportIndex_ReadFile(const char* file, char** out) {
+  struct stat st;
+
+  if (stat(file, &st) == -1)
+    return err_stdlib(0, file);
+
+  char* buf = Mem_Malloc(st.st_size + 1);
+  if (slurp_file(buf, st.st_size + 1, file) == -1) {
+    Mem_Free(buf);
+    return err_stdlib(0, file);
+  }
+
+  *out = buf;
+  return err_success();
+}
+
+// Intermediate entry used while building the index
+struct ModelSupportIndex_BuildEntry {
+  const char* model;
+  const char* configs[ModelSupportIndex_DatabaseCount];
+};
+typedef struct ModelSupportIndex_BuildEntry ModelSupportIndex_BuildEntry;
+declare_array_of(ModelSupportIndex_BuildEntry);
+
+static int ModelSupportIndex_CompareBuildEntry(const void* a, const void* b) {
+  return strcmp(((const ModelSupportIndex_BuildEntry*) a)->model,
+                ((const ModelSupportIndex_BuildEntry*) b)->model);
+}
+
+// Add all models of the database `root` to `entries`
+static void ModelSupportIndex_AddDatabase(
+  const char* file,
+  const nx_json* root,
+  enum ModelSupportIndex_Database db,
+  StrSet* models,
+  array_of(ModelSupportIndex_BuildEntry)* entries,
+  ssize_t* capacity)
+{
+  nx_json_for_each(model, root) {
+    if (model->type != NX_JSON_STRING) {
+      Log_Warn("%s: Invalid value for model `%s`: Not a string\n", file, model->key);
+      continue;
+    }
+
+    ssize_t id;
+    if (StrSet_Add(models, model->key, &id)) {
+      if (entries->size == *capacity) {
+        *capacity *= 2;
+        entries->data = Mem_Realloc(entries->data, *capacity * sizeof(ModelSupportIndex_BuildEntry));
+      }
+
+      entries->data[id] = (ModelSupportIndex_BuildEntry) { .model = model->key };
+      entries->size++;
+    }
+
+    ModelSupportIndex_BuildEntry* entry = &entries->data[id];
+    if (entry->configs[db])
+      Log_Warn("%s: Duplicate model key: `%s`\n", file, model->key);
+
+    entry->configs[db] = model->val.text;
+  }
+}
+
+// Append `s` to the string pool, reusing an existing copy of it
+// `offsets` holds the pool offset for each string id of `strings`.
+static uint32_t ModelSupportIndex_PoolAdd(StrSet* strings, uint32_t* offsets, char* out, size_t* out_size, const char* s) {
+  ssize_t id;
+
+  if (StrSet_Add(strings, s, &id)) {
+    const size_t len = strlen(s) + 1;
+    memcpy(out + *out_size, s, len);
+    offsets[id] = *out_size;
+    *out_size += len;
+  }
+
+  return offsets[id];
+}
+
+// Build the index of the databases `static_file` and `mutable_file` and write it to `index_file`
+Error* ModelSupportIndex_Build(const char* index_file, const char* static_file, const char* mutable_file) {
+  Error* e = NULL;
+  const char* files[ModelSupportIndex_DatabaseCount] = { static_file, mutable_file };
+  char* buffers[ModelSupportIndex_DatabaseCount] = {0};
+  const nx_json* roots[ModelSupportIndex_DatabaseCount] = {0};
+  ModelSupportIndex_Header header = {0};
+  ssize_t capacity = 1024;
+  array_of(ModelSupportIndex_BuildEntry) entries = {
+    .data = Mem_Malloc(capacity * sizeof(ModelSupportIndex_BuildEntry)),
+    .size = 0
+  };
+  StrSet models;
+  StrSet_Init(&models, capacity);
+
+  for (int db = 0; db < ModelSupportIndex_DatabaseCount; ++db) {
+    // Stat before reading, so a concurrent update invalidates the index
+    ModelSupportIndex_StatSource(files[db], &header.sources[db]);
+    if (header.sources[db].size == -1)
+      continue;
+
+    e = ModelSupportIndex_ReadFile(files[db], &buffers[db]);
+    if (e) {
+      Log_Warn("%s\n", err_print_all(e));
+      e = NULL;
+      continue;
+    }
+
+    roots[db] = nx_json_parse_utf8(buffers[db]);
+    if (! roots[db]) {
+      Log_Warn("%s: %s\n", files[db], err_print_all(err_nxjson(0, NULL)));
+      continue;
+    }
+
+    if (roots[db]->type != NX_JSON_OBJECT) {
+      Log_Warn("%s: Not a JSON object\n", files[db]);
+      continue;
+    }
+
+    ModelSupportIndex_AddDatabase(files[db], roots[db], db, &models, &entries, &capacity);
+  }
+
+  qsort(entries.data, entries.size, sizeof(ModelSupportIndex_BuildEntry), ModelSupportIndex_CompareBuildEntry);
+
+  // Serialize the index. The string pool is at most as big as all strings combined.
+  size_t pool_size = 0;
+  for_each_array(ModelSupportIndex_BuildEntry*, entry, entries) {
+    pool_size += strlen(entry->model) + 1;
+    for (int db = 0; db < ModelSupportIndex_DatabaseCount; ++db)
+      if (entry->configs[db])
+        pool_size += strlen(entry->configs[db]) + 1;
+  }
+
+  const size_t entries_offset = sizeof(ModelSupportIndex_Header);
+  size_t size = entries_offset + entries.size * sizeof(ModelSupportIndex_Entry);
+  char* out = Mem_Calloc(size + pool_size + 1, 1);
+  ModelSupportIndex_Entry* out_entries = (ModelSupportIndex_Entry*) (out + entries_offset);
+
+  StrSet strings;
+  StrSet_Init(&strings, entries.size);
+  uint32_t* offsets = Mem_Malloc((entries.size * (1 + ModelSupportIndex_DatabaseCount) + 1) * sizeof(uint32_t));
+
+  for_enumerate_array(ssize_t, i, entries) {
+    const ModelSupportIndex_BuildEntry* entry = &entries.data[i];
+    out_entries[i].model = ModelSupportIndex_PoolAdd(&strings, offsets, out, &size, entry->model);
+    for (int db = 0; db < ModelSupportIndex_DatabaseCount; ++db)
+      out_entries[i].configs[db] = entry->configs[db]
+        ? ModelSupportIndex_PoolAdd(&strings, offsets, out, &size, entry->configs[db])
+        : 0;
+  }
+
+  // Ensure the file ends with a NUL byte, even if the pool is empty
+  if (! entries.size)
+    size++;
+
+  memcpy(header.magic, MODEL_SUPPORT_INDEX_MAGIC, sizeof(header.magic));
+  header.count = entries.size;
+  memcpy(out, &header, sizeof(header));
+
+  if (write_file_atomic(index_file, 0644, out, size) == -1)
+    e = err_stdlib(0, index_file);
+
+  StrSet_Free(&strings);
+  StrSet_Free(&models);
+  Mem_Free(offsets);
+  Mem_Free(entries.data);
+  Mem_Free(out);
+  for (int db = 0; db < ModelSupportIndex_DatabaseCount; ++db) {
+    nx_json_free(roots[db]);
+    Mem_Free(buffers[db]);
+  }
+
+  return e;
+}
+
+// Open the index file and check if it is up to date with the source databases
+Error* ModelSupportIndex_Open(ModelSupportIndex* self, const char* index_file, const char* static_file, const char* mutable_file) {
+  const char* files[ModelSupportIndex_DatabaseCount] = { static_file, mutable_file };
+  struct stat st;
+
+  const int fd = open(index_file, O_RDONLY);
+  if (fd == -1)
+    return err_stdlib(0, index_file);
+
+  if (fstat(fd, &st) == -1) {
+    const int old_errno = errno;
+    close(fd);
+    errno = old_errno;
+    return err_stdlib(0, index_file);
+  }
+
+  if (st.st_size <= (off_t) sizeof(ModelSupportIndex_Header)) {
+    close(fd);
+    return err_string(0, "Index file is truncated");
+  }
+
+  void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int old_errno = errno;
+  close(fd);
+  errno = old_errno;
+
+  if (data == MAP_FAILED)
+    return err_stdlib(0, index_file);
+
+  my.data = data;
+  my.size = st.st_size;
+  my.header = (const ModelSupportIndex_Header*) my.data;
+  my.entries = (const ModelSupportIndex_Entry*) (my.data + sizeof(ModelSupportIndex_Header));
+
+  Error* e = NULL;
+
+  if (memcmp(my.header->magic, MODEL_SUPPORT_INDEX_MAGIC, sizeof(my.header->magic)))
+    e = err_string(0, "Invalid index file");
+  else if (my.header->count > (my.size - sizeof(ModelSupportIndex_Header)) / sizeof(ModelSupportIndex_Entry))
+    e = err_string(0, "Index file is truncated");
+  else if (my.data[my.size - 1] != '\0')
+    e = err_string(0, "Index file is truncated");
+
+  for (int db = 0; !e && db < ModelSupportIndex_DatabaseCount; ++db) {
+    ModelSupportIndex_Source source;
+    ModelSupportIndex_StatSource(files[db], &source);
+    if (memcmp(&source, &my.header->sources[db], sizeof(source)))
+      e = err_stringf(0, "Index file is outdated: %s has changed", files[db]);
+  }
+
+  if (e) {
+    ModelSupportIndex_Close(self);
+    return err_string(e, index_file);
+  }
+
+  return err_success();
+}
+
+void ModelSupportIndex_Close(ModelSupportIndex* self) {
+  if (my.data)
+    munmap((void*) my.data, my.size);
+  my.data = NULL;
+}
+
+// Return true if the database was present when the index was built
+bool ModelSupportIndex_HasDatabase(const ModelSupportIndex* self, enum ModelSupportIndex_Database db) {
+  return my.header->sources[db].size != -1;
+}
+
+static inline const char* ModelSupportIndex_String(const ModelSupportIndex* self, uint32_t offset) {
+  return (offset && offset < my.size) ? my.data + offset : NULL;
+}
+
+// Binary search for `model`.
+// If found, `configs` receives the config of the model in each database (NULL if not present).
+bool ModelSupportIndex_Find(const ModelSupportIndex* self, const char* model, const char** configs) {
+  ssize_t lo = 0;
+  ssize_t hi = (ssize_t) my.header->count - 1;
+
+  while (lo <= hi) {
+    const ssize_t mid = lo + (hi - lo) / 2;
+    const ModelSupportIndex_Entry* entry = &my.entries[mid];
+    const char* name = ModelSupportIndex_String(self, entry->model);
+    if (! name)
+      return false;
+
+    const int cmp = strcmp(model, name);
+    if (cmp < 0)
+      hi = mid - 1;
+    else if (cmp > 0)
+      lo = mid + 1;
+    else {
+      for (int db = 0; db < ModelSupportIndex_DatabaseCount; ++db)
+        configs[db] = ModelSupportIndex_String(self, entry->configs[db]);
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,69 @@
+#ifndef MODEL_SUPPORT_INDEX_H_
+#define MODEL_SUPPORT_INDEX_H_
+
+#include <stdbool.h>
+#include <stddef.h> // size_t
+#include <stdint.h> // uint32_t, int64_t
+
+#include "../error.h"
+
+/*
+ * Sorted on-disk index of the model support databases.
+ *
+ * The index merges the static and the mutable model support database.
+ * Each entry holds the config of the model in both databases, so the
+ * precedence of the mutable database is decided at lookup time.
+ *
+ * Layout (native byte order):
+ *   ModelSupportIndex_Header
+ *   ModelSupportIndex_Entry[count] (sorted by model name)
+ *   String pool (NUL terminated strings)
+ *
+ * The index is only valid as long as the size, modification time and inode
+ * of the source databases match the ones recorded in the header.
+ */
+
+#define MODEL_SUPPORT_INDEX_MAGIC "NBFCMSI1"
+
+enum ModelSupportIndex_Database {
+  ModelSupportIndex_Static = 0,
+  ModelSupportIndex_Mutable,
+  ModelSupportIndex_DatabaseCount
+};
+
+struct ModelSupportIndex_Source {
+  int64_t size;       // -1 if the file does not exist
+  int64_t mtime;      // Nanoseconds, an edit within the same second must be noticed
+  int64_t inode;
+};
+typedef struct ModelSupportIndex_Source ModelSupportIndex_Source;
+
+struct ModelSupportIndex_Header {
+  char     magic[8];
+  uint32_t count;
+  uint32_t reserved;
+  ModelSupportIndex_Source sources[ModelSupportIndex_DatabaseCount];
+};
+typedef struct ModelSupportIndex_Header ModelSupportIndex_Header;
+
+struct ModelSupportIndex_Entry {
+  uint32_t model;                                    // Offset of the model name
+  uint32_t configs[ModelSupportIndex_DatabaseCount]; // Offset of the config name, 0 if not present
+};
+typedef struct ModelSupportIndex_Entry ModelSupportIndex_Entry;
+
+struct ModelSupportIndex {
+  const char*                     data;
+  size_t                          size;
+  const ModelSupportIndex_Header* header;
+  const ModelSupportIndex_Entry*  entries;
+};
+typedef struct ModelSupportIndex ModelSupportIndex;
+
+Error* ModelSupportIndex_Build(const char*, const char*, const char*);
+Error* ModelSupportIndex_Open(ModelSupportIndex*, const char*, const char*, const char*);
+void   ModelSupportIndex_Close(ModelSupportIndex*);
+bool   ModelSupportIndex_Find(const ModelSupportIndex*, const char*, const char**);
+bool   ModelSupportIndex_HasDatabase(const ModelSupportIndex*, enum ModelSupportIndex_Database);
+
+#endif
@@ -4,7 +4,7 @@
 #include <stdio.h>  // snprintf
 #include <stdlib.h> // exit, system, WEXITSTATUS
 #include <string.h> // strcat, strerror, strcspn, memset
-#include <signal.h> // kill, SIGINT
+#include <signal.h> // kill, SIGINT, SIGHUP
 #include <unistd.h> // access, F_OK, unlink
 #include <limits.h> // INT_MAX
 
@@ -226,3 +226,20 @@ int Service_Restart(bool read_only) {
   sleep_ms(1000);
   return Service_Start(read_only);
 }
+
+// Let the service re-execute itself without interrupting the fan control
+int Service_Reexec() {
+  int pid = Service_Get_PID();
+  if (pid == -1) {
+    Log_Error("Service not running\n");
+    return NBFC_EXIT_FAILURE;
+  }
+
+  Log_Info("Re-executing nbfc_service (%d)\n", pid);
+  if (kill(pid, SIGHUP) == -1) {
+    Log_Error("Failed to signal nbfc_service process (%d): %s\n", pid, strerror(errno));
+    return NBFC_EXIT_FAILURE;
+  }
+
+  return NBFC_EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@ int    Service_Get_PID();
 int    Service_Start(bool);
 int    Service_Stop();
 int    Service_Restart(bool);
+int    Service_Reexec();
 
 Error* Client_Communicate(const nx_json*, char**, const nx_json**);
 Error* ServiceInfo_TryLoad(ServiceInfo*);
@@ -1,8 +1,10 @@
 #include "str_functions.h"
 
 #include <ctype.h>  // tolower
-#include <string.h> // strlen
+#include <string.h> // strlen, memset
+#include <stdlib.h> // abs
 
+#include "../macros.h"
 #include "../memory.h"
 
 const char* bool_to_str(bool val) {
@@ -24,41 +26,163 @@ bool str_starts_with_ignorecase(const char* string, const char* prefix) {
   return true;
 }
 
-static int levenshtein_min(int a, int b, int c) {
-  if (a <= b && a <= c) {
-    return a;
-  }
-  else if (b <= a && b <= c) {
-    return b;
+#define FUZZY_HIGH_BIT (1ULL << 63)
+
+static inline unsigned int trigram_hash(const char* s) {
+  const unsigned int h = (unsigned char) s[0] * 0x9E3779B1u
+                       ^ (unsigned char) s[1] * 0x85EBCA77u
+                       ^ (unsigned char) s[2] * 0xC2B2AE3Du;
+  return (h >> 16) % FUZZY_TRIGRAM_BUCKETS;
+}
+
+void FuzzyPattern_Init(FuzzyPattern* self, const char* pattern) {
+  my.length = strlen(pattern);
+  my.blocks = (my.length + 63) / 64;
+  my.peq = NULL;
+  my.pv = NULL;
+  my.mv = NULL;
+
+  if (my.blocks) {
+    my.peq = Mem_Calloc((256 + 2) * my.blocks, sizeof(uint64_t));
+    my.pv = my.peq + 256 * my.blocks;
+    my.mv = my.pv + my.blocks;
   }
-  else {
-    return c;
+
+  for (int i = 0; i < my.length; ++i)
+    my.peq[(unsigned char) pattern[i] * my.blocks + i / 64] |= 1ULL << (i % 64);
+
+  memset(my.trigrams, 0, sizeof(my.trigrams));
+  my.trigrams_size = (my.length > 2) ? my.length - 2 : 0;
+  for (int i = 0; i < my.trigrams_size; ++i)
+    my.trigrams[trigram_hash(pattern + i)]++;
+}
+
+void FuzzyPattern_Free(FuzzyPattern* self) {
+  Mem_Free(my.peq);
+  my.peq = NULL;
+}
+
+// Lower bound of the edit distance between the pattern and `text`.
+//
+// A single edit operation destroys at most three trigrams, so the number of
+// trigrams that are not shared by both strings limits the distance from below.
+// Hash collisions may only overcount the shared trigrams, which keeps the bound valid.
+static int FuzzyPattern_TrigramBound(FuzzyPattern* self, const char* text, int text_length) {
+  uint16_t taken[256];
+  int n_taken = 0;
+  int common = 0;
+  const int text_trigrams = (text_length > 2) ? text_length - 2 : 0;
+
+  for (int i = 0; i < text_trigrams; ++i) {
+    if (n_taken == ARRAY_SSIZE(taken)) {
+      common += text_trigrams - i; // Assume the rest is shared
+      break;
+    }
+
+    const unsigned int h = trigram_hash(text + i);
+    if (my.trigrams[h]) {
+      my.trigrams[h]--;
+      taken[n_taken++] = h;
+      common++;
+    }
   }
+
+  for (int i = 0; i < n_taken; ++i)
+    my.trigrams[taken[i]]++;
+
+  const int missing = max(my.trigrams_size, text_trigrams) - common;
+  return (missing > 0) ? (missing + 2) / 3 : 0;
+}
+
+// Advance one 64-bit block of the bit-parallel edit distance matrix by one text character.
+// `hin` is the horizontal delta entering the block from above, the return value is the one leaving it.
+static inline int FuzzyPattern_AdvanceBlock(uint64_t* pv, uint64_t* mv, uint64_t eq, int hin, uint64_t high_bit) {
+  uint64_t Pv = *pv;
+  uint64_t Mv = *mv;
+  const uint64_t Xv = eq | Mv;
+
+  if (hin < 0)
+    eq |= 1;
+
+  const uint64_t Xh = (((eq & Pv) + Pv) ^ Pv) | eq;
+  uint64_t Ph = Mv | ~(Xh | Pv);
+  uint64_t Mh = Pv & Xh;
+
+  int hout = 0;
+  if (Ph & high_bit)
+    hout = 1;
+  else if (Mh & high_bit)
+    hout = -1;
+
+  Ph <<= 1;
+  Mh <<= 1;
+  if (hin < 0)
+    Mh |= 1;
+  else if (hin > 0)
+    Ph |= 1;
+
+  *pv = Mh | ~(Xv | Ph);
+  *mv = Ph & Xv;
+  return hout;
 }
 
-static int levenshtein(const char *s1, const char *s2) {
-  unsigned int x, y, s1len, s2len;
-  s1len = strlen(s1);
-  s2len = strlen(s2);
-  unsigned int matrix[s2len+1][s1len+1];
-  matrix[0][0] = 0;
-  for (x = 1; x <= s2len; x++)
-    matrix[x][0] = matrix[x-1][0] + 1;
-  for (y = 1; y <= s1len; y++)
-    matrix[0][y] = matrix[0][y-1] + 1;
-  for (x = 1; x <= s2len; x++)
-    for (y = 1; y <= s1len; y++)
-      matrix[x][y] = levenshtein_min(matrix[x-1][y] + 1, matrix[x][y-1] + 1, matrix[x-1][y-1] + (s1[y-1] == s2[x-1] ? 0 : 1));
-
-  return(matrix[s2len][s1len]);
+// Return the edit distance between the pattern and `text`.
+// If the distance exceeds `max_distance`, the computation is aborted and a value greater than `max_distance` is returned.
+int FuzzyPattern_Distance(FuzzyPattern* self, const char* text, int max_distance) {
+  const int n = strlen(text);
+  const int m = my.length;
+
+  if (abs(m - n) > max_distance)
+    return max_distance + 1;
+
+  if (m == 0)
+    return n;
+
+  for (int b = 0; b < my.blocks; ++b) {
+    my.pv[b] = ~0ULL;
+    my.mv[b] = 0;
+  }
+
+  const uint64_t last_high_bit = 1ULL << ((m - 1) % 64);
+  int score = m;
+
+  for (int j = 0; j < n; ++j) {
+    const uint64_t* eq = my.peq + (unsigned char) text[j] * my.blocks;
+
+    int carry = 1;
+    for (int b = 0; b < my.blocks - 1; ++b)
+      carry = FuzzyPattern_AdvanceBlock(&my.pv[b], &my.mv[b], eq[b], carry, FUZZY_HIGH_BIT);
+
+    const int b = my.blocks - 1;
+    score += FuzzyPattern_AdvanceBlock(&my.pv[b], &my.mv[b], eq[b], carry, last_high_bit);
+
+    // The score changes by at most one per remaining column
+    if (score - (n - j - 1) > max_distance)
+      return max_distance + 1;
+  }
+
+  return score;
 }
 
-float str_similarity(const char* s1, const char* s2) {
-  const int s1len = strlen(s1);
-  const int s2len = strlen(s2);
-  const int diff = levenshtein(s1, s2);
-  if (s1len > s2len)
-    return 1.0f - ((float) diff / s1len);
-  else
-    return 1.0f - ((float) diff / s2len);
+// Return the similarity (1.0 - distance / longest length) between the pattern and `text`.
+// Returns -1.0 if the similarity is below `min_similarity`.
+float FuzzyPattern_Similarity(FuzzyPattern* self, const char* text, float min_similarity) {
+  const int text_length = strlen(text);
+  const int longest = max(my.length, text_length);
+
+  if (! longest)
+    return 1.0f;
+
+  // One extra edit of slack, the exact comparison is done on the result
+  const int max_distance = (int) ((1.0f - min_similarity) * longest) + 1;
+
+  if (FuzzyPattern_TrigramBound(self, text, text_length) > max_distance)
+    return -1.0f;
+
+  const int distance = FuzzyPattern_Distance(self, text, max_distance);
+  if (distance > max_distance)
+    return -1.0f;
+
+  const float similarity = 1.0f - ((float) distance / longest);
+  return (similarity >= min_similarity) ? similarity : -1.0f;
 }
@@ -2,10 +2,29 @@
 #define STR_FUNCTIONS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
+
+#define FUZZY_TRIGRAM_BUCKETS 1024
+
+// A precompiled pattern for repeated edit distance queries (Myers' bit-parallel algorithm)
+struct FuzzyPattern {
+  int       length;
+  int       blocks;                            // Number of 64-bit words per bitvector
+  uint64_t* peq;                               // Match bitmasks for each byte value, [256][blocks]
+  uint64_t* pv;                                // Vertical +1 deltas, [blocks]
+  uint64_t* mv;                                // Vertical -1 deltas, [blocks]
+  int       trigrams_size;                     // Number of trigrams in the pattern
+  uint16_t  trigrams[FUZZY_TRIGRAM_BUCKETS];   // Hashed trigram counts of the pattern
+};
+typedef struct FuzzyPattern FuzzyPattern;
+
+void  FuzzyPattern_Init(FuzzyPattern*, const char*);
+void  FuzzyPattern_Free(FuzzyPattern*);
+int   FuzzyPattern_Distance(FuzzyPattern*, const char*, int);
+float FuzzyPattern_Similarity(FuzzyPattern*, const char*, float);
 
 const char* bool_to_str(bool);
 char*       str_to_lower(const char*);
 bool        str_starts_with_ignorecase(const char*, const char*);
-float       str_similarity(const char*, const char*);
 
 #endif
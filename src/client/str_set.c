@@ -0,0 +1,95 @@
+#include "str_set.h"
+
+#include <stdint.h> // uint32_t
+#include <string.h> // strcmp
+
+#include "../macros.h"
+#include "../memory.h"
+
+// FNV-1a
+static inline uint32_t StrSet_Hash(const char* s) {
+  uint32_t h = 2166136261u;
+  for (; *s; ++s)
+    h = (h ^ (unsigned char) *s) * 16777619u;
+  return h;
+}
+
+// Return the slot of `key`, or the empty slot where it would be inserted
+static inline ssize_t StrSet_Slot(const StrSet* self, const char* key) {
+  const ssize_t mask = my.capacity - 1;
+  ssize_t slot = StrSet_Hash(key) & mask;
+
+  while (my.keys[slot] && strcmp(my.keys[slot], key))
+    slot = (slot + 1) & mask;
+
+  return slot;
+}
+
+static void StrSet_Allocate(StrSet* self, ssize_t capacity) {
+  my.keys = Mem_Calloc(capacity, sizeof(const char*));
+  my.ids = Mem_Malloc(capacity * sizeof(ssize_t));
+  my.capacity = capacity;
+}
+
+// Initialize the set for about `expected_size` strings
+void StrSet_Init(StrSet* self, ssize_t expected_size) {
+  ssize_t capacity = 16;
+  while (capacity < expected_size * 2)
+    capacity *= 2;
+
+  StrSet_Allocate(self, capacity);
+  my.size = 0;
+}
+
+void StrSet_Free(StrSet* self) {
+  Mem_Free(my.keys);
+  Mem_Free(my.ids);
+  my.keys = NULL;
+  my.ids = NULL;
+}
+
+static void StrSet_Grow(StrSet* self) {
+  const char** keys = my.keys;
+  ssize_t* ids = my.ids;
+  const ssize_t capacity = my.capacity;
+
+  StrSet_Allocate(self, capacity * 2);
+
+  for (ssize_t i = 0; i < capacity; ++i) {
+    if (keys[i]) {
+      const ssize_t slot = StrSet_Slot(self, keys[i]);
+      my.keys[slot] = keys[i];
+      my.ids[slot] = ids[i];
+    }
+  }
+
+  Mem_Free(keys);
+  Mem_Free(ids);
+}
+
+// Add `key` to the set.
+// Returns true if `key` was not already in the set.
+// If `id` is not NULL, it receives the id of `key`.
+bool StrSet_Add(StrSet* self, const char* key, ssize_t* id) {
+  if ((my.size + 1) * 2 > my.capacity)
+    StrSet_Grow(self);
+
+  const ssize_t slot = StrSet_Slot(self, key);
+  const bool inserted = (my.keys[slot] == NULL);
+
+  if (inserted) {
+    my.keys[slot] = key;
+    my.ids[slot] = my.size++;
+  }
+
+  if (id)
+    *id = my.ids[slot];
+
+  return inserted;
+}
+
+// Return the id of `key`, or -1 if it is not in the set
+ssize_t StrSet_Find(const StrSet* self, const char* key) {
+  const ssize_t slot = StrSet_Slot(self, key);
+  return my.keys[slot] ? my.ids[slot] : -1;
+}
@@ -0,0 +1,22 @@
+#ifndef STR_SET_H_
+#define STR_SET_H_
+
+#include <stdbool.h>
+#include <sys/types.h> // ssize_t
+
+// Hash set of strings. Each distinct string is assigned an id in order of insertion.
+// The strings are not copied, they have to outlive the set.
+struct StrSet {
+  const char** keys;     // Open addressing slots, NULL means empty
+  ssize_t*     ids;      // Id of the key in the same slot
+  ssize_t      capacity; // Always a power of two
+  ssize_t      size;     // Number of distinct strings
+};
+typedef struct StrSet StrSet;
+
+void    StrSet_Init(StrSet*, ssize_t);
+void    StrSet_Free(StrSet*);
+bool    StrSet_Add(StrSet*, const char*, ssize_t*);
+ssize_t StrSet_Find(const StrSet*, const char*);
+
+#endif
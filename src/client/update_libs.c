@@ -0,0 +1,106 @@
+#include "update_libs.h"
+
+#include <dlfcn.h> // dlopen, dlsym, dlerror
+
+#include "../macros.h"
+
+CURLcode     (*UpdateLibs_curl_global_init)(long);
+void         (*UpdateLibs_curl_global_cleanup)(void);
+CURL*        (*UpdateLibs_curl_easy_init)(void);
+CURLcode     (*UpdateLibs_curl_easy_setopt)(CURL*, CURLoption, ...);
+CURLcode     (*UpdateLibs_curl_easy_getinfo)(CURL*, CURLINFO, ...);
+CURLcode     (*UpdateLibs_curl_easy_perform)(CURL*);
+void         (*UpdateLibs_curl_easy_cleanup)(CURL*);
+const char*  (*UpdateLibs_curl_easy_strerror)(CURLcode);
+struct curl_slist* (*UpdateLibs_curl_slist_append)(struct curl_slist*, const char*);
+void         (*UpdateLibs_curl_slist_free_all)(struct curl_slist*);
+CURLM*       (*UpdateLibs_curl_multi_init)(void);
+CURLMcode    (*UpdateLibs_curl_multi_add_handle)(CURLM*, CURL*);
+CURLMcode    (*UpdateLibs_curl_multi_remove_handle)(CURLM*, CURL*);
+CURLMcode    (*UpdateLibs_curl_multi_perform)(CURLM*, int*);
+CURLMcode    (*UpdateLibs_curl_multi_wait)(CURLM*, struct curl_waitfd*, unsigned int, int, int*);
+CURLMsg*     (*UpdateLibs_curl_multi_info_read)(CURLM*, int*);
+CURLMcode    (*UpdateLibs_curl_multi_cleanup)(CURLM*);
+unsigned char* (*UpdateLibs_SHA1)(const unsigned char*, size_t, unsigned char*);
+int          (*UpdateLibs_inflateInit2_)(z_streamp, int, const char*, int);
+int          (*UpdateLibs_inflate)(z_streamp, int);
+int          (*UpdateLibs_inflateEnd)(z_streamp);
+const char*  (*UpdateLibs_zError)(int);
+
+struct UpdateLibs_Symbol {
+  void**      fn;
+  const char* name;
+};
+typedef struct UpdateLibs_Symbol UpdateLibs_Symbol;
+
+#define UpdateLibs_Symbol(NAME) { (void**) &UpdateLibs_ ## NAME, #NAME }
+
+struct UpdateLibs_Library {
+  const char*              names[4]; // Candidate sonames, NULL terminated
+  const UpdateLibs_Symbol* symbols;
+  int                      n_symbols;
+};
+typedef struct UpdateLibs_Library UpdateLibs_Library;
+
+static const UpdateLibs_Symbol UpdateLibs_CurlSymbols[] = {
+  UpdateLibs_Symbol(curl_global_init),
+  UpdateLibs_Symbol(curl_global_cleanup),
+  UpdateLibs_Symbol(curl_easy_init),
+  UpdateLibs_Symbol(curl_easy_setopt),
+  UpdateLibs_Symbol(curl_easy_getinfo),
+  UpdateLibs_Symbol(curl_easy_perform),
+  UpdateLibs_Symbol(curl_easy_cleanup),
+  UpdateLibs_Symbol(curl_easy_strerror),
+  UpdateLibs_Symbol(curl_slist_append),
+  UpdateLibs_Symbol(curl_slist_free_all),
+  UpdateLibs_Symbol(curl_multi_init),
+  UpdateLibs_Symbol(curl_multi_add_handle),
+  UpdateLibs_Symbol(curl_multi_remove_handle),
+  UpdateLibs_Symbol(curl_multi_perform),
+  UpdateLibs_Symbol(curl_multi_wait),
+  UpdateLibs_Symbol(curl_multi_info_read),
+  UpdateLibs_Symbol(curl_multi_cleanup),
+};
+
+static const UpdateLibs_Symbol UpdateLibs_CryptoSymbols[] = {
+  UpdateLibs_Symbol(SHA1),
+};
+
+static const UpdateLibs_Symbol UpdateLibs_ZlibSymbols[] = {
+  UpdateLibs_Symbol(inflateInit2_),
+  UpdateLibs_Symbol(inflate),
+  UpdateLibs_Symbol(inflateEnd),
+  UpdateLibs_Symbol(zError),
+};
+
+static const UpdateLibs_Library UpdateLibs_Libraries[] = {
+  {{"libcurl.so.4", "libcurl-gnutls.so.4", "libcurl.so", NULL},
+    UpdateLibs_CurlSymbols, ARRAY_SSIZE(UpdateLibs_CurlSymbols)},
+  {{"libcrypto.so.3", "libcrypto.so.1.1", "libcrypto.so", NULL},
+    UpdateLibs_CryptoSymbols, ARRAY_SSIZE(UpdateLibs_CryptoSymbols)},
+  {{"libz.so.1", "libz.so", NULL},
+    UpdateLibs_ZlibSymbols, ARRAY_SSIZE(UpdateLibs_ZlibSymbols)},
+};
+
+// Load libcurl, libcrypto and zlib and resolve all functions used by `nbfc update`.
+// The libraries are never unloaded.
+Error* UpdateLibs_Load() {
+  for (int i = 0; i < ARRAY_SSIZE(UpdateLibs_Libraries); ++i) {
+    const UpdateLibs_Library* lib = &UpdateLibs_Libraries[i];
+    void* handle = NULL;
+
+    for (const char* const* name = lib->names; *name && !handle; ++name)
+      handle = dlopen(*name, RTLD_NOW|RTLD_LOCAL);
+
+    if (! handle)
+      return err_stringf(0, "Could not load %s: %s", lib->names[0], dlerror());
+
+    for (int j = 0; j < lib->n_symbols; ++j) {
+      *lib->symbols[j].fn = dlsym(handle, lib->symbols[j].name);
+      if (! *lib->symbols[j].fn)
+        return err_stringf(0, "%s: %s", lib->names[0], dlerror());
+    }
+  }
+
+  return err_success();
+}
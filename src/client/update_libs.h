@@ -0,0 +1,70 @@
+#ifndef UPDATE_LIBS_H_
+#define UPDATE_LIBS_H_
+
+/*
+ * libcurl, libcrypto and zlib are only needed by `nbfc update`.
+ *
+ * Instead of linking against them (which every other command would pay for
+ * at startup), they are loaded by `UpdateLibs_Load()` when needed.
+ * The headers are still used for types and constants, the functions are
+ * redirected to the pointers below.
+ */
+
+#define CURL_DISABLE_TYPECHECK
+#include <curl/curl.h>
+#include <openssl/sha.h>
+#include <zlib.h>
+
+#include "../error.h"
+
+extern CURLcode     (*UpdateLibs_curl_global_init)(long);
+extern void         (*UpdateLibs_curl_global_cleanup)(void);
+extern CURL*        (*UpdateLibs_curl_easy_init)(void);
+extern CURLcode     (*UpdateLibs_curl_easy_setopt)(CURL*, CURLoption, ...);
+extern CURLcode     (*UpdateLibs_curl_easy_getinfo)(CURL*, CURLINFO, ...);
+extern CURLcode     (*UpdateLibs_curl_easy_perform)(CURL*);
+extern void         (*UpdateLibs_curl_easy_cleanup)(CURL*);
+extern const char*  (*UpdateLibs_curl_easy_strerror)(CURLcode);
+extern struct curl_slist* (*UpdateLibs_curl_slist_append)(struct curl_slist*, const char*);
+extern void         (*UpdateLibs_curl_slist_free_all)(struct curl_slist*);
+extern CURLM*       (*UpdateLibs_curl_multi_init)(void);
+extern CURLMcode    (*UpdateLibs_curl_multi_add_handle)(CURLM*, CURL*);
+extern CURLMcode    (*UpdateLibs_curl_multi_remove_handle)(CURLM*, CURL*);
+extern CURLMcode    (*UpdateLibs_curl_multi_perform)(CURLM*, int*);
+extern CURLMcode    (*UpdateLibs_curl_multi_wait)(CURLM*, struct curl_waitfd*, unsigned int, int, int*);
+extern CURLMsg*     (*UpdateLibs_curl_multi_info_read)(CURLM*, int*);
+extern CURLMcode    (*UpdateLibs_curl_multi_cleanup)(CURLM*);
+extern unsigned char* (*UpdateLibs_SHA1)(const unsigned char*, size_t, unsigned char*);
+extern int          (*UpdateLibs_inflateInit2_)(z_streamp, int, const char*, int);
+extern int          (*UpdateLibs_inflate)(z_streamp, int);
+extern int          (*UpdateLibs_inflateEnd)(z_streamp);
+extern const char*  (*UpdateLibs_zError)(int);
+
+Error* UpdateLibs_Load();
+
+#undef curl_easy_setopt
+#undef curl_easy_getinfo
+#define curl_global_init         UpdateLibs_curl_global_init
+#define curl_global_cleanup      UpdateLibs_curl_global_cleanup
+#define curl_easy_init           UpdateLibs_curl_easy_init
+#define curl_easy_setopt         UpdateLibs_curl_easy_setopt
+#define curl_easy_getinfo        UpdateLibs_curl_easy_getinfo
+#define curl_easy_perform        UpdateLibs_curl_easy_perform
+#define curl_easy_cleanup        UpdateLibs_curl_easy_cleanup
+#define curl_easy_strerror       UpdateLibs_curl_easy_strerror
+#define curl_slist_append        UpdateLibs_curl_slist_append
+#define curl_slist_free_all      UpdateLibs_curl_slist_free_all
+#define curl_multi_init          UpdateLibs_curl_multi_init
+#define curl_multi_add_handle    UpdateLibs_curl_multi_add_handle
+#define curl_multi_remove_handle UpdateLibs_curl_multi_remove_handle
+#define curl_multi_perform       UpdateLibs_curl_multi_perform
+#define curl_multi_wait          UpdateLibs_curl_multi_wait
+#define curl_multi_info_read     UpdateLibs_curl_multi_info_read
+#define curl_multi_cleanup       UpdateLibs_curl_multi_cleanup
+#define SHA1                     UpdateLibs_SHA1
+#define inflateInit2_            UpdateLibs_inflateInit2_
+#define inflate                  UpdateLibs_inflate
+#define inflateEnd               UpdateLibs_inflateEnd
+#define zError                   UpdateLibs_zError
+
+#endif
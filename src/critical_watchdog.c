@@ -0,0 +1,274 @@
+#include "critical_watchdog.h"
+
+#include "ec.h"
+#include "log.h"
+#include "memory.h"
+
+#include <errno.h>    // errno, EINTR
+#include <fcntl.h>    // open, O_RDONLY
+#include <float.h>    // FLT_MAX
+#include <pthread.h>  // pthread_create, pthread_join
+#include <sched.h>    // SCHED_FIFO, sched_get_priority_min
+#include <stdlib.h>   // strtof
+#include <string.h>   // strerror
+#include <time.h>     // clock_gettime, clock_nanosleep
+#include <unistd.h>   // pread, close
+
+/*
+ * A thread that reads the raw temperature files of the fans every
+ * CRITICAL_WATCHDOG_INTERVAL milliseconds. It bypasses the temperature filter
+ * and the control loop: if a fan exceeds its CriticalTemperature it writes
+ * the 100% value directly to the EC.
+ *
+ * Only fans that are written through the EC or a WriteHwmonFile (no
+ * WriteAcpiMethod) and that have file based temperature sources are watched.
+ * The EC must be wrapped by EC_Locked_VTable, since the control loop uses it
+ * concurrently.
+ */
+
+extern EC_VTable* ec;
+
+struct CriticalWatchdog_Fan {
+  int                      index;
+  int                      fds[FAN_TEMPERATURE_CONTROL_MAX_SOURCES];
+  float                    multipliers[FAN_TEMPERATURE_CONTROL_MAX_SOURCES];
+  int                      sources_size;
+  TemperatureAlgorithmType algorithm;
+  float                    critical;       // Enter critical mode above this
+  float                    release;        // Leave critical mode below this
+  uint8_t                  register_;
+  bool                     word;
+  uint16_t                 value;          // EC value for 100%
+  HwmonPwm*                pwm;            // Written instead of the EC if not NULL
+  bool                     is_critical;    // Accessed atomically
+};
+typedef struct CriticalWatchdog_Fan CriticalWatchdog_Fan;
+declare_array_of(CriticalWatchdog_Fan);
+
+static struct {
+  bool                           running;
+  bool                           stop;     // Accessed atomically
+  pthread_t                      thread;
+  array_of(CriticalWatchdog_Fan) fans;
+  bool*                          critical; // Indexed by fan index, accessed atomically
+  int                            critical_size;
+} CriticalWatchdog;
+
+static uint64_t CriticalWatchdog_Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool CriticalWatchdog_ReadTemperature(CriticalWatchdog_Fan* fan, float* out) {
+  float sum = 0, min = FLT_MAX, max = -FLT_MAX;
+  int total = 0;
+
+  for (int i = 0; i < fan->sources_size; ++i) {
+    char buf[32];
+    const ssize_t nread = pread(fan->fds[i], buf, sizeof(buf) - 1, 0);
+    if (nread <= 0)
+      continue;
+
+    buf[nread] = '\0';
+    char* end;
+    const float temperature = strtof(buf, &end) * fan->multipliers[i];
+    if (end == buf)
+      continue;
+
+    sum += temperature;
+    min = min(min, temperature);
+    max = max(max, temperature);
+    ++total;
+  }
+
+  if (! total)
+    return false;
+
+  switch (fan->algorithm) {
+    case TemperatureAlgorithmType_Min: *out = min;         break;
+    case TemperatureAlgorithmType_Max: *out = max;         break;
+    default:                           *out = sum / total; break;
+  }
+
+  return true;
+}
+
+static void CriticalWatchdog_Check(CriticalWatchdog_Fan* fan) {
+  float temperature;
+  if (! CriticalWatchdog_ReadTemperature(fan, &temperature))
+    return;
+
+  const bool was_critical = __atomic_load_n(&fan->is_critical, __ATOMIC_RELAXED);
+
+  if (! was_critical && temperature > fan->critical) {
+    const uint64_t detected = CriticalWatchdog_Now();
+    Error* e = fan->pwm  ? HwmonPwm_WriteCritical(fan->pwm, fan->value)
+             : fan->word ? ec->WriteWord(fan->register_, fan->value)
+             :             ec->WriteByte(fan->register_, fan->value);
+    const uint64_t written = CriticalWatchdog_Now();
+
+    if (e) {
+      Log_Error("Critical watchdog: Fan #%d: %s\n", fan->index, err_print_all(e));
+      return;
+    }
+
+    __atomic_store_n(&fan->is_critical, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&CriticalWatchdog.critical[fan->index], true, __ATOMIC_RELEASE);
+    Log_Warn("Critical watchdog: Fan #%d: %.1f°C exceeds the critical temperature, "
+             "fan set to 100%% (latency %.3f ms)\n",
+             fan->index, temperature, (written - detected) / 1000.0);
+  }
+  else if (was_critical && temperature < fan->release) {
+    __atomic_store_n(&fan->is_critical, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&CriticalWatchdog.critical[fan->index], false, __ATOMIC_RELEASE);
+    Log_Info("Critical watchdog: Fan #%d: %.1f°C is below the critical temperature again\n",
+             fan->index, temperature);
+  }
+}
+
+static void* CriticalWatchdog_Thread(void* arg) {
+  (void) arg;
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (! __atomic_load_n(&CriticalWatchdog.stop, __ATOMIC_ACQUIRE)) {
+    for_each_array(CriticalWatchdog_Fan*, fan, CriticalWatchdog.fans)
+      CriticalWatchdog_Check(fan);
+
+    next.tv_nsec += CRITICAL_WATCHDOG_INTERVAL * 1000000L;
+    if (next.tv_nsec >= 1000000000L) {
+      next.tv_sec += next.tv_nsec / 1000000000L;
+      next.tv_nsec %= 1000000000L;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR);
+  }
+
+  return NULL;
+}
+
+// Set up a watched fan. Returns false if the fan cannot be watched.
+static bool CriticalWatchdog_AddFan(CriticalWatchdog_Fan* fan, int index, FanTemperatureControl* ftc) {
+  const FanConfiguration* cfg = ftc->Fan.fanConfig;
+
+  memset(fan, 0, sizeof(*fan));
+
+  if (cfg->WriteAcpiMethod && ! ftc->Fan.pwm.pwm.path) {
+    Log_Info("Critical watchdog: Fan #%d: Not watched (uses WriteAcpiMethod)\n", index);
+    return false;
+  }
+
+  for (int i = 0; i < ftc->TemperatureSourcesSize; ++i) {
+    const FS_TemperatureSource* ts = ftc->TemperatureSources[i];
+    if (ts->type != FS_TemperatureSource_File)
+      continue;
+
+    const int fd = open(ts->file, O_RDONLY);
+    if (fd < 0) {
+      Log_Warn("Critical watchdog: %s: %s\n", ts->file, strerror(errno));
+      continue;
+    }
+
+    fan->fds[fan->sources_size] = fd;
+    fan->multipliers[fan->sources_size] = ts->multiplier;
+    fan->sources_size++;
+  }
+
+  if (! fan->sources_size) {
+    Log_Info("Critical watchdog: Fan #%d: Not watched (no temperature files)\n", index);
+    return false;
+  }
+
+  fan->index     = index;
+  fan->algorithm = ftc->TemperatureAlgorithmType;
+  fan->critical  = ftc->Fan.criticalTemperature;
+  fan->release   = ftc->Fan.criticalTemperature - ftc->Fan.criticalTemperatureOffset;
+  fan->register_ = cfg->WriteRegister;
+  fan->word      = ftc->Fan.readWriteWords;
+  fan->value     = Fan_GetCriticalSpeedValue(&ftc->Fan);
+  fan->pwm       = ftc->Fan.pwm.pwm.path ? &ftc->Fan.pwm : NULL;
+  return true;
+}
+
+static void CriticalWatchdog_Free() {
+  for_each_array(CriticalWatchdog_Fan*, fan, CriticalWatchdog.fans)
+    for (int i = 0; i < fan->sources_size; ++i)
+      close(fan->fds[i]);
+
+  Mem_Free(CriticalWatchdog.fans.data);
+  CriticalWatchdog.fans.data = NULL;
+  CriticalWatchdog.fans.size = 0;
+}
+
+Error* CriticalWatchdog_Start(array_of(FanTemperatureControl)* fans) {
+  if (CriticalWatchdog.running)
+    return err_success();
+
+  Mem_Free(CriticalWatchdog.critical);
+  CriticalWatchdog.critical = Mem_Calloc(fans->size, sizeof(bool));
+  CriticalWatchdog.critical_size = fans->size;
+  CriticalWatchdog.fans.data = Mem_Calloc(fans->size, sizeof(CriticalWatchdog_Fan));
+  CriticalWatchdog.fans.size = 0;
+
+  for_enumerate_array(int, i, *fans) {
+    CriticalWatchdog_Fan* fan = &CriticalWatchdog.fans.data[CriticalWatchdog.fans.size];
+    if (CriticalWatchdog_AddFan(fan, i, &fans->data[i]))
+      CriticalWatchdog.fans.size++;
+  }
+
+  if (! CriticalWatchdog.fans.size) {
+    CriticalWatchdog_Free();
+    return err_string(0, "Critical watchdog: No fans to watch");
+  }
+
+  // Prefer a realtime priority, so the watchdog isn't delayed by the rest of the system
+  pthread_attr_t attr;
+  struct sched_param param = { .sched_priority = sched_get_priority_min(SCHED_FIFO) };
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  pthread_attr_setschedparam(&attr, &param);
+
+  CriticalWatchdog.stop = false;
+  int ret = pthread_create(&CriticalWatchdog.thread, &attr, CriticalWatchdog_Thread, NULL);
+  pthread_attr_destroy(&attr);
+
+  if (ret == EPERM) {
+    Log_Info("Critical watchdog: Realtime priority not available, using normal priority\n");
+    ret = pthread_create(&CriticalWatchdog.thread, NULL, CriticalWatchdog_Thread, NULL);
+  }
+
+  if (ret) {
+    CriticalWatchdog_Free();
+    errno = ret;
+    return err_stdlib(0, "Critical watchdog: pthread_create()");
+  }
+
+  CriticalWatchdog.running = true;
+  Log_Info("Critical watchdog: Watching %zd fan(s) every %d ms\n",
+    CriticalWatchdog.fans.size, CRITICAL_WATCHDOG_INTERVAL);
+  return err_success();
+}
+
+void CriticalWatchdog_Stop() {
+  if (! CriticalWatchdog.running)
+    return;
+
+  __atomic_store_n(&CriticalWatchdog.stop, true, __ATOMIC_RELEASE);
+  pthread_join(CriticalWatchdog.thread, NULL);
+  CriticalWatchdog.running = false;
+  CriticalWatchdog_Free();
+
+  Mem_Free(CriticalWatchdog.critical);
+  CriticalWatchdog.critical = NULL;
+  CriticalWatchdog.critical_size = 0;
+}
+
+// Whether the watchdog has put the fan into critical mode
+bool CriticalWatchdog_IsCritical(int fan) {
+  if (fan < 0 || fan >= CriticalWatchdog.critical_size)
+    return false;
+
+  return __atomic_load_n(&CriticalWatchdog.critical[fan], __ATOMIC_ACQUIRE);
+}
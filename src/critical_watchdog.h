@@ -0,0 +1,15 @@
+#ifndef NBFC_CRITICAL_WATCHDOG_H_
+#define NBFC_CRITICAL_WATCHDOG_H_
+
+#include "error.h"
+#include "fan_temperature_control.h"
+
+#include <stdbool.h>
+
+#define CRITICAL_WATCHDOG_INTERVAL 100 /*ms*/
+
+Error* CriticalWatchdog_Start(array_of(FanTemperatureControl)*);
+void   CriticalWatchdog_Stop();
+bool   CriticalWatchdog_IsCritical(int fan);
+
+#endif
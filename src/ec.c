@@ -3,6 +3,8 @@
 #include "ec_linux.h"
 #include "ec_sys_linux.h"
 
+int EC_InheritedFD = -1;
+
 bool EC_CheckWorking(EC_VTable* ec) {
   Error* e = ec->Open();
   if (e)
@@ -15,8 +15,13 @@ struct EC_VTable {
   Error* (*ReadWord)(uint8_t, uint16_t*);
   Error* (*WriteByte)(uint8_t, uint8_t);
   Error* (*WriteWord)(uint8_t, uint16_t);
+  int    (*GetFD)(); // -1 if the implementation doesn't use a file descriptor
 };
 
+// A file descriptor inherited from a re-executed service. It is adopted by
+// the next Open() of an implementation that uses a file descriptor.
+extern int EC_InheritedFD;
+
 bool   EC_CheckWorking(EC_VTable*);
 Error* EC_FindWorking(EC_VTable**);
 
@@ -40,6 +40,10 @@ Error* EC_Debug_ReadWord(uint8_t register_, uint16_t* out) {
   return e;
 }
 
+int EC_Debug_GetFD() {
+  return EC_Debug_Controller->GetFD();
+}
+
 EC_VTable EC_Debug_VTable = {
   EC_Debug_Open,
   EC_Debug_Close,
@@ -47,4 +51,5 @@ EC_VTable EC_Debug_VTable = {
   EC_Debug_ReadWord,
   EC_Debug_WriteByte,
   EC_Debug_WriteWord,
+  EC_Debug_GetFD,
 };
@@ -12,5 +12,6 @@ Error* EC_Debug_WriteByte(uint8_t, uint8_t);
 Error* EC_Debug_WriteWord(uint8_t, uint16_t);
 Error* EC_Debug_ReadByte(uint8_t, uint8_t*);
 Error* EC_Debug_ReadWord(uint8_t, uint16_t*);
+int    EC_Debug_GetFD();
 
 #endif
@@ -56,6 +56,10 @@ Error* EC_Dummy_WriteWord(uint8_t register_, uint16_t value) {
   return err_success();
 }
 
+int EC_Dummy_GetFD() {
+  return -1;
+}
+
 EC_VTable EC_Dummy_VTable = {
   EC_Dummy_Open,
   EC_Dummy_Close,
@@ -63,4 +67,5 @@ EC_VTable EC_Dummy_VTable = {
   EC_Dummy_ReadWord,
   EC_Dummy_WriteByte,
   EC_Dummy_WriteWord,
+  EC_Dummy_GetFD,
 };
@@ -11,5 +11,6 @@ Error* EC_Dummy_WriteByte(uint8_t, uint8_t);
 Error* EC_Dummy_WriteWord(uint8_t, uint16_t);
 Error* EC_Dummy_ReadByte(uint8_t, uint8_t*);
 Error* EC_Dummy_ReadWord(uint8_t, uint16_t*);
+int    EC_Dummy_GetFD();
 
 #endif
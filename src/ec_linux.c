@@ -21,6 +21,12 @@
 static int EC_Linux_FD = -1;
 
 Error* EC_Linux_Open() {
+  if (EC_InheritedFD >= 0) {
+    EC_Linux_FD = EC_InheritedFD;
+    EC_InheritedFD = -1;
+    return err_success();
+  }
+
   EC_Linux_FD = open(EC_Linux_PortFilePath, O_RDWR);
   if (EC_Linux_FD < 0)
     return err_stdlib(0, EC_Linux_PortFilePath);
@@ -34,6 +40,10 @@ void EC_Linux_Close() {
   }
 }
 
+int EC_Linux_GetFD() {
+  return EC_Linux_FD;
+}
+
 static bool EC_Linux_WritePort(int port, uint8_t value)
 {
   return (1 == pwrite(EC_Linux_FD, &value, 1, port));
@@ -219,4 +229,5 @@ EC_VTable EC_Linux_VTable = {
   EC_Linux_ReadWord,
   EC_Linux_WriteByte,
   EC_Linux_WriteWord,
+  EC_Linux_GetFD,
 };
@@ -11,5 +11,6 @@ Error* EC_Linux_WriteByte(uint8_t, uint8_t);
 Error* EC_Linux_WriteWord(uint8_t, uint16_t);
 Error* EC_Linux_ReadByte(uint8_t, uint8_t*);
 Error* EC_Linux_ReadWord(uint8_t, uint16_t*);
+int    EC_Linux_GetFD();
 
 #endif
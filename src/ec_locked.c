@@ -0,0 +1,65 @@
+#include "ec_locked.h"
+
+#include <pthread.h>
+
+// Serializes the accesses to EC_Locked_Controller, so it can be used by more than one thread
+
+EC_VTable* EC_Locked_Controller;
+
+static pthread_mutex_t EC_Locked_Mutex = PTHREAD_MUTEX_INITIALIZER;
+
+Error* EC_Locked_Open() {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  Error* e = EC_Locked_Controller->Open();
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+  return e;
+}
+
+void EC_Locked_Close() {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  EC_Locked_Controller->Close();
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+}
+
+Error* EC_Locked_WriteByte(uint8_t register_, uint8_t value) {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  Error* e = EC_Locked_Controller->WriteByte(register_, value);
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+  return e;
+}
+
+Error* EC_Locked_WriteWord(uint8_t register_, uint16_t value) {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  Error* e = EC_Locked_Controller->WriteWord(register_, value);
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+  return e;
+}
+
+Error* EC_Locked_ReadByte(uint8_t register_, uint8_t* out) {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  Error* e = EC_Locked_Controller->ReadByte(register_, out);
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+  return e;
+}
+
+Error* EC_Locked_ReadWord(uint8_t register_, uint16_t* out) {
+  pthread_mutex_lock(&EC_Locked_Mutex);
+  Error* e = EC_Locked_Controller->ReadWord(register_, out);
+  pthread_mutex_unlock(&EC_Locked_Mutex);
+  return e;
+}
+
+// The file descriptor doesn't change while the controller is open
+int EC_Locked_GetFD() {
+  return EC_Locked_Controller->GetFD();
+}
+
+EC_VTable EC_Locked_VTable = {
+  EC_Locked_Open,
+  EC_Locked_Close,
+  EC_Locked_ReadByte,
+  EC_Locked_ReadWord,
+  EC_Locked_WriteByte,
+  EC_Locked_WriteWord,
+  EC_Locked_GetFD,
+};
@@ -0,0 +1,17 @@
+#ifndef NBFC_EC_LOCKED_H_
+#define NBFC_EC_LOCKED_H_
+
+#include "ec.h"
+
+extern EC_VTable  EC_Locked_VTable;
+extern EC_VTable* EC_Locked_Controller;
+
+Error* EC_Locked_Open();
+void   EC_Locked_Close();
+Error* EC_Locked_WriteByte(uint8_t, uint8_t);
+Error* EC_Locked_WriteWord(uint8_t, uint16_t);
+Error* EC_Locked_ReadByte(uint8_t, uint8_t*);
+Error* EC_Locked_ReadWord(uint8_t, uint16_t*);
+int    EC_Locked_GetFD();
+
+#endif
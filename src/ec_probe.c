@@ -15,8 +15,12 @@
 #include "help/ec_probe.help.h"
 #include "program_name.c"
 #include "log.h"
+#include "register_history.h"
+#include "capture_file.h"
+#include "capture_analysis.h"
 
 #include <float.h>   // FLT_MAX
+#include <inttypes.h> // PRIu64
 #include <stdbool.h> // bool
 #include <stdio.h>   // printf, fprintf, fopen, fread, fclose
 #include <stdint.h>  // uint8_t, uint16_t
@@ -26,6 +30,8 @@
 #include <locale.h>  // setlocale, LC_NUMERIC
 #include <signal.h>  // signal, SIGINT, SIGTERM
 #include <unistd.h>  // geteuid, STDOUT_FILENO
+#include <time.h>    // clock_gettime, CLOCK_MONOTONIC
+#include <sys/timerfd.h> // timerfd_create, timerfd_settime
 
 #include "error.c"             // src
 #include "ec.c"                // src
@@ -47,6 +53,9 @@
 #include "stack_memory.c"      // src
 #include "trace.c"             // src
 #include "file_utils.c"        // src
+#include "register_history.c"  // src
+#include "capture_file.c"      // src
+#include "capture_analysis.c"  // src
 
 #define Console_Black       "\033[0;30m"
 #define Console_Red         "\033[0;31m"
@@ -71,17 +80,14 @@
 #define Console_Reset       "\033[0;0m"
 #define Console_Clear       "\033[1;1H\033[2J"
 
-#define             RegistersSize 256
-typedef uint8_t     RegisterBuf[RegistersSize];
 typedef const char* RegisterColors[RegistersSize];
-static RegisterBuf  Registers_Log[32768];
 
-static void         Register_PrintRegister(RegisterBuf*, RegisterColors);
+static void         Register_PrintRegister(const RegisterBuf*, RegisterColors);
 static inline void  Register_FromEC(RegisterBuf*);
 static inline void  Register_ToEC(RegisterBuf*);
-static void         Register_PrintWatch(RegisterBuf*, RegisterBuf*, RegisterBuf*);
-static void         Register_PrintMonitor(RegisterBuf*, int);
-static void         Register_WriteMonitorReport(RegisterBuf*, int, FILE*);
+static void         Register_PrintWatch(const RegisterHistory*);
+static void         Register_PrintMonitor(const RegisterHistory*);
+static void         Register_WriteMonitorReport(const RegisterHistory*, FILE*);
 static void         Register_PrintDump(RegisterBuf*, bool);
 static int          Register_LoadDump(RegisterBuf*, FILE*);
 static void         Handle_Signal(int);
@@ -95,6 +101,8 @@ static int Dump();
 static int Load();
 static int Monitor();
 static int Watch();
+static int Capture();
+static int Analyze();
 static int AcpiCall();
 static int Shell();
 
@@ -105,6 +113,8 @@ enum Command {
   Command_Load,
   Command_Monitor,
   Command_Watch,
+  Command_Capture,
+  Command_Analyze,
   Command_AcpiCall,
   Command_Shell,
   Command_Help,
@@ -112,7 +122,7 @@ enum Command {
 };
 
 static enum Command Command_FromString(const char* s) {
-  const char* cmds[] = { "read", "write", "dump", "load", "monitor", "watch", "acpi_call", "shell", "help" };
+  const char* cmds[] = { "read", "write", "dump", "load", "monitor", "watch", "capture", "analyze", "acpi_call", "shell", "help" };
 
   for (int i = 0; i < ARRAY_SSIZE(cmds); ++i)
     if (!strcmp(cmds[i], s))
@@ -128,6 +138,8 @@ static const char* HelpTexts[] = {
   EC_PROBE_LOAD_HELP_TEXT,
   EC_PROBE_MONITOR_HELP_TEXT,
   EC_PROBE_WATCH_HELP_TEXT,
+  EC_PROBE_CAPTURE_HELP_TEXT,
+  EC_PROBE_ANALYZE_HELP_TEXT,
   EC_PROBE_ACPI_CALL_HELP_TEXT,
   EC_PROBE_SHELL_HELP_TEXT,
   EC_PROBE_HELP_TEXT,
@@ -150,6 +162,10 @@ enum Option {
   Option_Decimal,
   Option_Timespan,
   Option_Interval,
+  Option_CaptureInterval,
+  Option_Hwmon,
+  Option_Top,
+  Option_MaxLag,
   Option_AcpiCallMethod,
   Option_AcpiCallArgument,
 };
@@ -207,6 +223,23 @@ static const cli99_option watch_command_options[] = {
   cli99_options_end()
 };
 
+static const cli99_option capture_command_options[] = {
+  cli99_include_options(&main_options),
+  {"-t|--timespan",            Option_Timespan,            1},
+  {"-i|--interval",            Option_CaptureInterval,     1},
+  {"-H|--hwmon",               Option_Hwmon,               0},
+  {"file",                     Option_File,                1|cli99_required_option},
+  cli99_options_end()
+};
+
+static const cli99_option analyze_command_options[] = {
+  cli99_include_options(&main_options),
+  {"-n|--top",                 Option_Top,                 1},
+  {"-l|--max-lag",             Option_MaxLag,              1},
+  {"file",                     Option_File,                1|cli99_required_option},
+  cli99_options_end()
+};
+
 static const cli99_option acpi_call_command_options[] = {
   cli99_include_options(&main_options),
   {"method",                   Option_AcpiCallMethod,      1|cli99_required_option},
@@ -228,6 +261,8 @@ static const cli99_option* Options[] = {
   load_command_options,
   monitor_command_options,
   watch_command_options,
+  capture_command_options,
+  analyze_command_options,
   acpi_call_command_options,
   main_options, // shell
   main_options, // help
@@ -242,6 +277,10 @@ enum UseColor {
 static struct {
   int           timespan;
   float         interval;
+  int           capture_interval;
+  bool          hwmon;
+  int           top;
+  int           max_lag;
   const char*   report;
   const char*   file;
   bool          clearly;
@@ -270,6 +309,9 @@ int main(int argc, char* const argv[]) {
   setlocale(LC_NUMERIC, "C"); // for parsing floats
 
   options.interval = 0.5;
+  options.capture_interval = 100;
+  options.top = 5;
+  options.max_lag = 30;
   ec = NULL;
   enum Command cmd = Command_Help;
 
@@ -313,6 +355,7 @@ int main(int argc, char* const argv[]) {
     case Option_Version:  printf("ec_probe " NBFC_VERSION "\n");   return 0;
     case Option_Clearly:  options.clearly  = 1;                    break;
     case Option_Decimal:  options.decimal  = 1;                    break;
+    case Option_Hwmon:    options.hwmon    = 1;                    break;
     case Option_Word:     options.use_word = 1;                    break;
     case Option_Report:   options.report   = p.optarg;             break;
     case Option_Color:    options.use_color = ColorEnable;         break;
@@ -348,6 +391,27 @@ int main(int argc, char* const argv[]) {
         return NBFC_EXIT_CMDLINE;
       }
       break;
+    case Option_CaptureInterval:
+      options.capture_interval = parse_number(p.optarg, 1, INT_MAX, &err);
+      if (err) {
+        Log_Error("-i|--interval: %s: %s\n", p.optarg, err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
+    case Option_Top:
+      options.top = parse_number(p.optarg, 1, CaptureAnalysis_MaxTop, &err);
+      if (err) {
+        Log_Error("-n|--top: %s: %s\n", p.optarg, err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
+    case Option_MaxLag:
+      options.max_lag = parse_number(p.optarg, 0, 3600, &err);
+      if (err) {
+        Log_Error("-l|--max-lag: %s: %s\n", p.optarg, err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
     case Option_AcpiCallMethod:
       options.acpi_call_method = p.optarg;
       break;
@@ -374,6 +438,10 @@ int main(int argc, char* const argv[]) {
     return NBFC_EXIT_CMDLINE;
   }
 
+  // Analyzing a capture does not need the embedded controller
+  if (cmd == Command_Analyze)
+    return Analyze();
+
   if (geteuid()) {
     Log_Error("This program must be run as root\n");
     return NBFC_EXIT_FAILURE;
@@ -397,6 +465,7 @@ int main(int argc, char* const argv[]) {
   case Command_Write:    return Write();
   case Command_Monitor:  return Monitor();
   case Command_Watch:    return Watch();
+  case Command_Capture:  return Capture();
   case Command_AcpiCall: return AcpiCall();
   case Command_Shell:    return Shell();
   default:               return NBFC_EXIT_FAILURE;
@@ -483,12 +552,15 @@ static int Monitor() {
   if (options.timespan)
     max_loops = options.timespan / options.interval;
 
-  RegisterBuf* regs = Registers_Log;
-  int size = ARRAY_SSIZE(Registers_Log);
-  int loops;
-  for (loops = 0; !quit && loops < max_loops && --size; ++loops) {
-    Register_FromEC(regs + loops);
-    Register_PrintMonitor(regs, loops);
+  RegisterHistory history;
+  RegisterHistory_Init(&history);
+
+  for (int loops = 0; !quit && loops < max_loops; ++loops) {
+    RegisterBuf regs;
+    Register_FromEC(&regs);
+    Error* e = RegisterHistory_Add(&history, &regs);
+    e_die();
+    Register_PrintMonitor(&history);
     sleep_ms(options.interval * 1000);
   }
 
@@ -496,12 +568,14 @@ static int Monitor() {
     FILE* fh = fopen(options.report, "w");
     if (! fh) {
       Log_Error("%s: %s\n", options.report, strerror(errno));
+      RegisterHistory_Close(&history);
       return NBFC_EXIT_FAILURE;
     }
-    Register_WriteMonitorReport(regs, loops, fh);
+    Register_WriteMonitorReport(&history, fh);
     fclose(fh);
   }
 
+  RegisterHistory_Close(&history);
   return 0;
 }
 
@@ -511,18 +585,173 @@ static int Watch() {
   if (options.timespan)
     max_loops = options.timespan / options.interval;
 
-  int size = ARRAY_SSIZE(Registers_Log);
-  RegisterBuf* regs = Registers_Log;
-  Register_FromEC(regs);
-  for (int loops = 1; !quit && loops < max_loops && --size; ++loops) {
-    Register_FromEC(regs + loops);
-    Register_PrintWatch(regs , regs + loops, regs + loops - 1);
+  RegisterHistory history;
+  RegisterHistory_Init(&history);
+
+  for (int loops = 0; !quit && loops < max_loops; ++loops) {
+    RegisterBuf regs;
+    Register_FromEC(&regs);
+    Error* e = RegisterHistory_Add(&history, &regs);
+    e_die();
+    if (loops)
+      Register_PrintWatch(&history);
     sleep_ms(options.interval * 1000);
   }
 
+  RegisterHistory_Close(&history);
   return 0;
 }
 
+static uint64_t Capture_Now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static int Capture() {
+  CaptureWriter writer;
+  Error* e = CaptureWriter_Open(&writer, options.file, options.capture_interval, options.hwmon);
+  e_die();
+
+  // A periodic timer keeps the schedule independent of how long a sample takes
+  const int timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (timer < 0) {
+    Log_Error("timerfd_create(): %s\n", strerror(errno));
+    CaptureWriter_Close(&writer);
+    return NBFC_EXIT_FAILURE;
+  }
+
+  struct itimerspec spec;
+  spec.it_interval.tv_sec  = options.capture_interval / 1000;
+  spec.it_interval.tv_nsec = (options.capture_interval % 1000) * 1000000;
+  spec.it_value = spec.it_interval;
+
+  if (timerfd_settime(timer, 0, &spec, NULL) < 0) {
+    Log_Error("timerfd_settime(): %s\n", strerror(errno));
+    close(timer);
+    CaptureWriter_Close(&writer);
+    return NBFC_EXIT_FAILURE;
+  }
+
+  const uint64_t timespan = (uint64_t) options.timespan * 1000000000;
+  const uint64_t start = Capture_Now();
+  uint64_t samples = 0;
+  uint64_t missed = 0;
+
+  while (! quit) {
+    const uint64_t timestamp = Capture_Now() - start;
+    if (options.timespan && timestamp >= timespan)
+      break;
+
+    RegisterBuf regs;
+    Register_FromEC(&regs);
+    e = CaptureWriter_Write(&writer, timestamp, &regs);
+    if (e)
+      break;
+    samples++;
+
+    uint64_t expirations;
+    if (read(timer, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+      if (errno == EINTR)
+        continue;
+      e = err_stdlib(0, "read(timerfd)");
+      break;
+    }
+
+    missed += expirations - 1;
+  }
+
+  close(timer);
+
+  if (! e)
+    e = CaptureWriter_Close(&writer);
+  else
+    CaptureWriter_Close(&writer);
+
+  if (e) {
+    Log_Error("%s: %s\n", options.file, err_print_all(e));
+    return NBFC_EXIT_FAILURE;
+  }
+
+  Log_Info("Captured %" PRIu64 " samples (%" PRIu64 " intervals missed)\n", samples, missed);
+  return NBFC_EXIT_SUCCESS;
+}
+
+static void Analyze_PrintCandidate(const CaptureCandidate* c, uint32_t interval) {
+  char name[32];
+
+  switch (c->type) {
+  case CaptureCandidate_Byte:
+    snprintf(name, sizeof(name), "0x%.2X", c->register_);
+    break;
+  case CaptureCandidate_WordLE:
+    snprintf(name, sizeof(name), "0x%.2X (word)", c->register_);
+    break;
+  case CaptureCandidate_WordBE:
+    snprintf(name, sizeof(name), "0x%.2X (word, BE)", c->register_);
+    break;
+  }
+
+  printf("  %-18s %6.3f %8.3f %9.3f %+8.2fs %8.3f %6d..%d\n",
+    name, c->score, c->pearson, c->spearman,
+    c->lag * (interval / 1000.0), c->lagged, c->min, c->max);
+}
+
+static int Analyze() {
+  CaptureReader reader;
+  Error* e = CaptureReader_Open(&reader, options.file);
+  if (e) {
+    Log_Error("%s\n", err_print_all(e));
+    return NBFC_EXIT_FAILURE;
+  }
+
+  const int channels = reader.header->channels;
+  if (! channels) {
+    Log_Error("%s: Capture contains no hwmon channels (use `capture --hwmon`)\n", options.file);
+    CaptureReader_Close(&reader);
+    return NBFC_EXIT_FAILURE;
+  }
+
+  const uint32_t interval = max(reader.header->interval, 1);
+  const int max_lag = (options.max_lag * 1000) / interval;
+  CaptureAnalysis_Result* results = Mem_Calloc(channels, sizeof(*results));
+
+  e = CaptureAnalysis_Run(&reader, options.top, max_lag, results);
+  if (e) {
+    Log_Error("%s: %s\n", options.file, err_print_all(e));
+    Mem_Free(results);
+    CaptureReader_Close(&reader);
+    return NBFC_EXIT_FAILURE;
+  }
+
+  printf("%d samples, %.1f seconds\n", reader.samples_size,
+    CaptureReader_Sample(&reader, reader.samples_size - 1)->timestamp / 1e9);
+
+  for (int c = 0; c < channels; ++c) {
+    const CaptureFile_Channel* channel = &reader.channels[c];
+    const bool is_temperature = (channel->type == CaptureChannel_Temperature);
+
+    printf("\n%.*s ", (int) sizeof(channel->name), channel->name);
+    if (is_temperature)
+      printf("(temperature, %.1f..%.1f C)\n", results[c].min / 1000.0, results[c].max / 1000.0);
+    else
+      printf("(fan, %d..%d RPM)\n", results[c].min, results[c].max);
+
+    if (! results[c].valid) {
+      printf("  Channel did not change\n");
+      continue;
+    }
+
+    printf("  %-18s %6s %8s %9s %9s %8s %s\n", "Register", "Score", "Pearson", "Spearman", "Lag", "Lagged", "Range");
+    for (int i = 0; i < results[c].top_size; ++i)
+      Analyze_PrintCandidate(&results[c].top[i], interval);
+  }
+
+  Mem_Free(results);
+  CaptureReader_Close(&reader);
+  return NBFC_EXIT_SUCCESS;
+}
+
 static int AcpiCall() {
   Error* e;
   char cmd[1024];
@@ -566,7 +795,7 @@ static void Handle_Signal(int sig) {
 // Registers code
 // ============================================================================
 
-static void Register_PrintRegister(RegisterBuf* self, RegisterColors color) {
+static void Register_PrintRegister(const RegisterBuf* self, RegisterColors color) {
   if (color)
     printf(Console_Reset);
 
@@ -601,52 +830,38 @@ static inline void Register_ToEC(RegisterBuf* self) {
     ec->WriteByte(i, my[i]);
 }
 
-static void Register_PrintWatch(RegisterBuf* all_readings, RegisterBuf* current, RegisterBuf* previous) {
+static void Register_PrintWatch(const RegisterHistory* history) {
   RegisterColors colors;
+  const RegisterBuf* current = RegisterHistory_Recent(history, 0);
 
   for (int register_ = 0; register_ < RegistersSize; ++register_) {
     const uint8_t byte = (*current)[register_];
-    const uint8_t diff = byte - (*previous)[register_];
-    bool has_changed = false;
-
-    uint8_t save = byte;
-    for (range(RegisterBuf*, r, all_readings, previous)) {
-      if (save != (*r)[register_]) {
-        has_changed = true;
-        break;
-      }
-    }
 
-    /**/ if (diff)          colors[register_] = Console_Yelllow;
-    else if (has_changed)   colors[register_] = Console_BoldBlue;
-    else if (byte == 0xFF)  colors[register_] = Console_White;
-    else if (byte)          colors[register_] = Console_BoldWhite;
-    else                    colors[register_] = Console_BoldBlack;
+    /**/ if (RegisterMask_Test(history->last_delta, register_))  colors[register_] = Console_Yelllow;
+    else if (RegisterMask_Test(history->changed, register_))     colors[register_] = Console_BoldBlue;
+    else if (byte == 0xFF)                                        colors[register_] = Console_White;
+    else if (byte)                                                colors[register_] = Console_BoldWhite;
+    else                                                          colors[register_] = Console_BoldBlack;
   }
 
   Register_PrintRegister(current, colors);
 }
 
-static void Register_PrintMonitor(RegisterBuf* readings, int size) {
+static void Register_PrintMonitor(const RegisterHistory* history) {
   printf(Console_Clear);
 
-  for (int register_ = 0; register_ < RegistersSize; ++register_) {
-    bool register_has_changed = false;
-    for (range(int, i, 0, size)) {
-      if (readings[0][register_] != readings[i][register_]) {
-        register_has_changed = true;
-        break;
-      }
-    }
+  const int shown = min(history->size, 24);
+  const int first_shown = history->size - shown;
 
-    if (! register_has_changed)
-      continue;
+  for_each_register_in_mask(register_, history->changed) {
+    // Only compare against the previous samples if the register changed in the shown range
+    const bool changed_recently = (history->last_change[register_] >= first_shown);
 
     printf(Console_Green "0x%.2X:", register_);
-    uint8_t byte = readings[0][register_];
-    for (range(int, i, max(size - 24, 0), size)) {
-      const uint8_t diff = byte - readings[i][register_];
-      byte = readings[i][register_];
+    for (int n = shown - 1; n >= 0; --n) {
+      const uint8_t byte = (*RegisterHistory_Recent(history, n))[register_];
+      const bool diff = (changed_recently && n + 1 < history->size &&
+                         byte != (*RegisterHistory_Recent(history, n + 1))[register_]);
       if (diff)
         printf(Console_BoldBlue " %.2X", byte);
       else
@@ -656,28 +871,22 @@ static void Register_PrintMonitor(RegisterBuf* readings, int size) {
   }
 }
 
-static void Register_WriteMonitorReport(RegisterBuf* readings, int size, FILE* fh) {
-  for (int register_ = 0; register_ < RegistersSize; ++register_) {
-    bool register_has_changed = false;
-    for (range(int, i, 0, size)) {
-      if (readings[0][register_] != readings[i][register_]) {
-        register_has_changed = true;
-        break;
-      }
-    }
-
-    if (! register_has_changed)
-      continue;
-
+static void Register_WriteMonitorReport(const RegisterHistory* history, FILE* fh) {
+  // Each register's values are streamed straight from the history, so the
+  // report needs no memory proportional to the number of samples
+  for_each_register_in_mask(register_, history->changed) {
     fprintf(fh, "%.2X", register_);
-    for (range(int, i, 0, size)) {
-      if (options.clearly && i > 0 && readings[i][register_] == readings[i - 1][register_])
+
+    RegisterHistory_Iter it;
+    RegisterHistory_IterInit(&it, history);
+    while (RegisterHistory_IterNext(&it)) {
+      if (options.clearly && it.index > 0 && ! RegisterMask_Test(it.delta, register_))
         continue;
 
       if (options.decimal)
-        fprintf(fh, ",%d", readings[i][register_]);
+        fprintf(fh, ",%d", it.regs[register_]);
       else
-        fprintf(fh, ",%.2X", readings[i][register_]);
+        fprintf(fh, ",%.2X", it.regs[register_]);
     }
     fprintf(fh, "\n");
   }
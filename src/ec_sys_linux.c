@@ -25,6 +25,12 @@ static inline Error* EC_SysLinux_LoadACPIKernelModule();
 Error* EC_SysLinux_Open() {
   EC_SysLinux_File = EC_SysLinux_EC0_IO_Path;
 
+  if (EC_InheritedFD >= 0) {
+    EC_SysLinux_FD = EC_InheritedFD;
+    EC_InheritedFD = -1;
+    return err_success();
+  }
+
   EC_SysLinux_FD = open(EC_SysLinux_EC0_IO_Path, O_RDWR);
   if (EC_SysLinux_FD != -1)
     return err_success();
@@ -42,6 +48,12 @@ Error* EC_SysLinux_Open() {
 Error* EC_SysLinux_ACPI_Open() {
   EC_SysLinux_File = EC_SysLinux_ACPI_EC_Path;
 
+  if (EC_InheritedFD >= 0) {
+    EC_SysLinux_FD = EC_InheritedFD;
+    EC_InheritedFD = -1;
+    return err_success();
+  }
+
   EC_SysLinux_FD = open(EC_SysLinux_ACPI_EC_Path, O_RDWR);
   if (EC_SysLinux_FD != -1)
     return err_success();
@@ -92,6 +104,10 @@ Error* EC_SysLinux_ReadWord(uint8_t register_, uint16_t* out) {
   return err_success();
 }
 
+int EC_SysLinux_GetFD() {
+  return EC_SysLinux_FD;
+}
+
 static inline Error* EC_SysLinux_LoadKernelModule() {
   switch (system(EC_SysLinux_Module_Cmd)) {
   case 0:  return err_success();
@@ -115,6 +131,7 @@ EC_VTable EC_SysLinux_VTable = {
   EC_SysLinux_ReadWord,
   EC_SysLinux_WriteByte,
   EC_SysLinux_WriteWord,
+  EC_SysLinux_GetFD,
 };
 
 EC_VTable EC_SysLinux_ACPI_VTable = {
@@ -124,4 +141,5 @@ EC_VTable EC_SysLinux_ACPI_VTable = {
   EC_SysLinux_ReadWord,
   EC_SysLinux_WriteByte,
   EC_SysLinux_WriteWord,
+  EC_SysLinux_GetFD,
 };
@@ -13,5 +13,6 @@ Error* EC_SysLinux_WriteByte(uint8_t, uint8_t);
 Error* EC_SysLinux_WriteWord(uint8_t, uint16_t);
 Error* EC_SysLinux_ReadByte(uint8_t, uint8_t*);
 Error* EC_SysLinux_ReadWord(uint8_t, uint16_t*);
+int    EC_SysLinux_GetFD();
 
 #endif
@@ -8,10 +8,28 @@
 #include <string.h>
 #include <stdarg.h>
 
-static Error error_stack[16];
+#define ERROR_STACK_SIZE 16
+
+// Each thread has its own error stack. An Error* must be printed by the thread that created it.
+//
+// error_stack[0] holds the root cause, each following entry adds context to the previous one.
+// If the stack is full, the entries right after the root cause are discarded, so that
+// the root cause and the most recent context are kept.
+static _Thread_local Error error_stack[ERROR_STACK_SIZE];
+static _Thread_local int   error_stack_dropped;
 
 static inline Error* err_allocate(Error* e) {
-  return e ? ++e : error_stack;
+  if (! e) {
+    error_stack_dropped = 0;
+    return error_stack;
+  }
+
+  if (e < &error_stack[ERROR_STACK_SIZE - 1])
+    return ++e;
+
+  memmove(&error_stack[1], &error_stack[2], (ERROR_STACK_SIZE - 2) * sizeof(Error));
+  error_stack_dropped++;
+  return e;
 }
 
 static void err_print(const Error* e, StringBuf* s) {
@@ -25,9 +43,9 @@ static void err_print(const Error* e, StringBuf* s) {
   }
 }
 
-const char* err_print_all(const Error* e) {
-  static char buf[4096];
-  StringBuf s = { buf, 0, sizeof(buf) - 1 };
+// Format the error chain into `buf`
+const char* err_format(const Error* e, char* buf, size_t size) {
+  StringBuf s = { buf, 0, (int) size };
 
   buf[0] = '\0';
 
@@ -38,6 +56,9 @@ const char* err_print_all(const Error* e) {
     err_print(e, &s);
     StringBuf_AddCh(&s, ':');
     StringBuf_AddCh(&s, ' ');
+
+    if (e == &error_stack[1] && error_stack_dropped)
+      StringBuf_Printf(&s, "(%d more): ", error_stack_dropped);
   }
 
   err_print(e, &s);
@@ -45,6 +66,12 @@ const char* err_print_all(const Error* e) {
   return buf;
 }
 
+// Format the error chain into a thread-local buffer
+const char* err_print_all(const Error* e) {
+  static _Thread_local char buf[4096];
+  return err_format(e, buf, sizeof(buf));
+}
+
 Error* err_string(Error* e, const char* message) {
   e = err_allocate(e);
   e->system = ErrorSystem_String;
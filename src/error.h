@@ -31,6 +31,7 @@ Error* err_string(Error*,  const char* message);
 Error* err_stringf(Error*, const char* message, ...);
 Error* err_stdlib(Error*,  const char* message);
 Error* err_nxjson(Error*,  const char* message);
+const char* err_format(const Error*, char*, size_t);
 const char* err_print_all(const Error*);
 
 #endif
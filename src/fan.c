@@ -6,6 +6,7 @@
 
 #include <math.h>    // fabs, round
 #include <errno.h>   // EINVAL
+#include <fcntl.h>   // O_RDONLY
 #include <string.h>  // strlen
 #include <stdbool.h>
 
@@ -14,6 +15,8 @@ extern EC_VTable* ec;
 Error* Fan_Init(Fan* self, FanConfiguration* cfg, ModelConfig* modelCfg) {
   my.fanConfig            = cfg;
   my.mode                 = Fan_ModeAuto;
+  my.lastWrittenValue     = -1;
+  my.loadBias             = 0;
   my.criticalTemperature  = modelCfg->CriticalTemperature;
   my.criticalTemperatureOffset = modelCfg->CriticalTemperatureOffset;
   my.readWriteWords       = modelCfg->ReadWriteWords;
@@ -26,9 +29,52 @@ Error* Fan_Init(Fan* self, FanConfiguration* cfg, ModelConfig* modelCfg) {
   my.maxSpeedValueReadAbs = max(my.minSpeedValueRead, my.maxSpeedValueRead);
   my.fanSpeedSteps        = my.maxSpeedValueReadAbs - my.minSpeedValueReadAbs;
 
+  my.speedFile.path       = NULL;
+  my.pwm.pwm.path         = NULL;
+  my.pwm.enable.path      = NULL;
+
   return ThresholdManager_Init(&my.threshMan, &cfg->TemperatureThresholds);
 }
 
+// Open the hwmon files used by the fan.
+// If a file cannot be opened, fall back to the EC or ACPI method if there is one.
+Error* Fan_Open(Fan* self) {
+  Error* e;
+  const FanConfiguration* cfg = my.fanConfig;
+
+  if (cfg->ReadHwmonFile) {
+    e = HwmonFile_Open(&my.speedFile, cfg->ReadHwmonFile, O_RDONLY);
+    if (e) {
+      e = err_string(e, "ReadHwmonFile");
+      if (! FanConfiguration_IsSet_ReadRegister(cfg) && ! FanConfiguration_IsSet_ReadAcpiMethod(cfg))
+        return e;
+      Log_Warn("%s (reading the fan speed from the embedded controller)\n", err_print_all(e));
+    }
+  }
+
+  if (cfg->WriteHwmonFile) {
+    e = HwmonPwm_Open(&my.pwm, cfg->WriteHwmonFile);
+    if (e) {
+      e = err_string(e, "WriteHwmonFile");
+      if (! FanConfiguration_IsSet_WriteRegister(cfg) && ! FanConfiguration_IsSet_WriteAcpiMethod(cfg))
+        return e;
+      Log_Warn("%s (writing the fan speed to the embedded controller)\n", err_print_all(e));
+    }
+  }
+
+  return err_success();
+}
+
+void Fan_Close(Fan* self) {
+  HwmonFile_Close(&my.speedFile);
+
+  Error* e = HwmonPwm_Close(&my.pwm);
+  if (e) {
+    e = err_string(e, "WriteHwmonFile");
+    e_warn();
+  }
+}
+
 // ============================================================================
 // PRIVATE
 // ============================================================================
@@ -37,6 +83,10 @@ static inline bool float_eq(const float a, const float b) {
   return fabs(a - b) < 0.06; /* ~ 0.05 */
 }
 
+static inline float Fan_AutoSpeed(const Fan* self, const TemperatureThreshold* threshold) {
+  return min(threshold->FanSpeed + my.loadBias, 100.0f);
+}
+
 static FanSpeedPercentageOverride* Fan_OverrideByValue(const Fan* self, uint16_t value) {
   for_each_array(FanSpeedPercentageOverride*, o, my.fanConfig->FanSpeedPercentageOverrides)
     if ((o->TargetOperation & OverrideTargetOperation_Read) &&
@@ -86,6 +136,9 @@ static float Fan_FanSpeedToPercentage(const Fan* self, uint16_t fanSpeed) {
 }
 
 static Error* Fan_ECWriteValue(Fan* self, uint16_t value) {
+  if (my.pwm.pwm.path)
+    return HwmonPwm_Write(&my.pwm, value);
+
   if (my.fanConfig->WriteAcpiMethod) {
     uint64_t out;
     Error* e = AcpiCall_CallTemplate(my.fanConfig->WriteAcpiMethod, value, &out);
@@ -130,6 +183,37 @@ static Error* Fan_ECReadValue(const Fan* self, uint16_t* out) {
   }
 }
 
+// Read the fan speed in RPM from ReadHwmonFile, bypassing the EC
+static Error* Fan_UpdateCurrentSpeedByHwmon(Fan* self) {
+  long rpm;
+  Error* e = HwmonFile_Read(&my.speedFile, &rpm);
+  if (e)
+    return e;
+
+  const float percentage = ((float)(rpm - my.fanConfig->MinSpeedRpm) /
+      (my.fanConfig->MaxSpeedRpm - my.fanConfig->MinSpeedRpm)) * 100.0f;
+
+  my.currentSpeed = max(percentage, 0.0f);
+  return err_success();
+}
+
+static Error* Fan_WriteResetValue(Fan* self) {
+  if (! my.fanConfig->ResetRequired)
+    return err_success();
+
+  if (my.fanConfig->ResetAcpiMethod) {
+    const ssize_t len = strlen(my.fanConfig->ResetAcpiMethod);
+    uint64_t out;
+    Error* e = AcpiCall_Call(my.fanConfig->ResetAcpiMethod, len, &out);
+    if (e)
+      return err_string(e, "ResetAcpiMethod");
+    else
+      return err_success();
+  }
+
+  return Fan_ECWriteValue(self, my.fanConfig->FanSpeedResetValue);
+}
+
 // ============================================================================
 // PUBLIC
 // ============================================================================
@@ -142,7 +226,9 @@ float Fan_GetRequestedSpeed(const Fan* self) {
   return my.requestedSpeed;
 }
 
-void Fan_SetTemperature(Fan* self, float temperature)
+// The critical mode follows the measured `temperature`, the thresholds are
+// selected by the `predicted_temperature`.
+void Fan_SetTemperature(Fan* self, float temperature, float predicted_temperature)
 {
   // HandleCritalMode
   if (temperature > my.criticalTemperature)
@@ -150,9 +236,9 @@ void Fan_SetTemperature(Fan* self, float temperature)
   else if (temperature < (my.criticalTemperature - my.criticalTemperatureOffset))
     my.isCritical = false;
 
-  TemperatureThreshold* threshold = ThresholdManager_AutoSelectThreshold(&my.threshMan, temperature);
+  TemperatureThreshold* threshold = ThresholdManager_AutoSelectThreshold(&my.threshMan, predicted_temperature);
   if (my.mode == Fan_ModeAuto)
-    my.targetFanSpeed = threshold->FanSpeed;
+    my.targetFanSpeed = Fan_AutoSpeed(self, threshold);
 }
 
 Error* Fan_SetFixedSpeed(Fan* self, float speed) {
@@ -177,7 +263,12 @@ Error* Fan_SetFixedSpeed(Fan* self, float speed) {
 
 void Fan_SetAutoSpeed(Fan* self) {
   my.mode = Fan_ModeAuto;
-  my.targetFanSpeed = ThresholdManager_GetCurrentThreshold(&my.threshMan)->FanSpeed;
+  my.targetFanSpeed = Fan_AutoSpeed(self, ThresholdManager_GetCurrentThreshold(&my.threshMan));
+}
+
+// The bias takes effect with the next call to Fan_SetTemperature()
+void Fan_SetLoadBias(Fan* self, float bias) {
+  my.loadBias = bias;
 }
 
 float Fan_GetCurrentSpeed(const Fan* self) {
@@ -185,7 +276,10 @@ float Fan_GetCurrentSpeed(const Fan* self) {
 }
 
 Error* Fan_UpdateCurrentSpeed(Fan* self) {
-  uint16_t speed;
+  uint16_t speed = 0;
+
+  if (my.speedFile.path)
+    return Fan_UpdateCurrentSpeedByHwmon(self);
 
   // If the value is out of range 3 or more times,
   // minFanSpeed and/or maxFanSpeed are probably wrong.
@@ -208,24 +302,40 @@ uint16_t Fan_GetSpeedSteps(const Fan* self) {
 }
 
 Error* Fan_ECReset(Fan* self) {
-  if (! my.fanConfig->ResetRequired)
-    return err_success();
-
-  if (my.fanConfig->ResetAcpiMethod) {
-    const ssize_t len = strlen(my.fanConfig->ResetAcpiMethod);
-    uint64_t out;
-    Error* e = AcpiCall_Call(my.fanConfig->ResetAcpiMethod, len, &out);
-    if (e)
-      return err_string(e, "ResetAcpiMethod");
-    else
-      return err_success();
+  Error* e = Fan_WriteResetValue(self);
+  my.lastWrittenValue = -1;
+
+  // Hand the fan back to the driver
+  if (my.pwm.pwm.path) {
+    Error* restore_error = HwmonPwm_Restore(&my.pwm);
+    if (! e)
+      e = restore_error;
   }
 
-  return Fan_ECWriteValue(self, my.fanConfig->FanSpeedResetValue);
+  return e;
+}
+
+// The value that is written to the EC for 100%
+uint16_t Fan_GetCriticalSpeedValue(const Fan* self) {
+  return Fan_PercentageToFanSpeed(self, 100.0f);
 }
 
 Error* Fan_ECFlush(Fan* self) {
   const float speed = Fan_GetTargetSpeed(self);
   const uint16_t value = Fan_PercentageToFanSpeed(self, speed);
-  return Fan_ECWriteValue(self, value);
+
+  // Unknown state (e.g. after a resume), don't trust the cached pwm value
+  if (my.lastWrittenValue < 0)
+    HwmonPwm_Invalidate(&my.pwm);
+
+  Error* e = Fan_ECWriteValue(self, value);
+  my.lastWrittenValue = e ? -1 : value;
+  my.lastWrittenSpeed = speed;
+  return e;
+}
+
+// Whether the target speed differs from what was last written to the EC
+bool Fan_NeedsFlush(const Fan* self) {
+  const uint16_t value = Fan_PercentageToFanSpeed(self, Fan_GetTargetSpeed(self));
+  return my.lastWrittenValue != value;
 }
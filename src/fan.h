@@ -5,6 +5,7 @@
 #include "error.h"
 #include "temperature_threshold_manager.h"
 #include "model_config.h"
+#include "hwmon.h"
 
 #include <stdbool.h>
 
@@ -29,26 +30,36 @@ struct Fan {
 
   ThresholdManager threshMan;
   float targetFanSpeed;
+  float loadBias;                     // Added to the threshold speed in auto mode
   float requestedSpeed;
   float currentSpeed;
   Fan_Mode mode;
   bool isCritical;
+  int32_t lastWrittenValue;           // -1 if unknown
+  float lastWrittenSpeed;
+  HwmonFile speedFile;                // Open if the speed is read from ReadHwmonFile
+  HwmonPwm  pwm;                      // Open if the speed is written to WriteHwmonFile
 };
 
 Error*   Fan_Init(Fan*, FanConfiguration*, ModelConfig*);
+Error*   Fan_Open(Fan*);
+void     Fan_Close(Fan*);
 
 Error*   Fan_UpdateCurrentSpeed(Fan*);
 float    Fan_GetCurrentSpeed(const Fan*);
 float    Fan_GetTargetSpeed(const Fan*);
 float    Fan_GetRequestedSpeed(const Fan*);
 uint16_t Fan_GetSpeedSteps(const Fan*);
+uint16_t Fan_GetCriticalSpeedValue(const Fan*);
 
-void     Fan_SetTemperature(Fan*, float temperature);
+void     Fan_SetTemperature(Fan*, float temperature, float predicted_temperature);
 Error*   Fan_SetFixedSpeed(Fan*, float speed);
 void     Fan_SetAutoSpeed(Fan*);
+void     Fan_SetLoadBias(Fan*, float bias);
 
 Error*   Fan_ECReset(Fan*);
 Error*   Fan_ECFlush(Fan*);
+bool     Fan_NeedsFlush(const Fan*);
 
 declare_array_of(Fan);
 
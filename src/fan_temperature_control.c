@@ -4,6 +4,7 @@
 #include "memory.h"
 
 #include <float.h>
+#include <math.h>
 #include <string.h>
 
 static const char* const CPUSensorNames[] = {
@@ -194,6 +195,10 @@ static Error* FanTemperatureControl_SetDefaults(array_of(FanTemperatureControl)*
   for_each_array(FanTemperatureControl*, ftc, *fans) {
     ftc->TemperatureAlgorithmType = TemperatureAlgorithmType_Average;
     ftc->TemperatureSourcesSize = 0;
+    ftc->LoadSource = LoadSource_Utilization;
+    ftc->LoadFeedforward = 0;
+    ftc->LoadThreshold = 50;
+    ftc->LoadBias = 0;
 
     for_each_array(FS_TemperatureSource*, ts, FS_Sensors_Sources) {
       if (IsCPUSensorName(ts->name)) {
@@ -216,6 +221,15 @@ static Error* FanTemperatureControl_SetByModelConfig0(
   if (FanConfiguration_IsSet_TemperatureAlgorithmType(fc))
     ftc->TemperatureAlgorithmType = fc->TemperatureAlgorithmType;
 
+  if (FanConfiguration_IsSet_LoadSource(fc))
+    ftc->LoadSource = fc->LoadSource;
+
+  if (FanConfiguration_IsSet_LoadFeedforward(fc))
+    ftc->LoadFeedforward = fc->LoadFeedforward;
+
+  if (FanConfiguration_IsSet_LoadThreshold(fc))
+    ftc->LoadThreshold = fc->LoadThreshold;
+
   // Use default sensor names
   if (! fc->Sensors.size)
     return err_success();
@@ -267,6 +281,15 @@ static Error* FanTemperatureControl_SetByServiceConfig(
     if (FanTemperatureSourceConfig_IsSet_TemperatureAlgorithmType(ftsc))
       ftc->TemperatureAlgorithmType = ftsc->TemperatureAlgorithmType;
 
+    if (FanTemperatureSourceConfig_IsSet_LoadSource(ftsc))
+      ftc->LoadSource = ftsc->LoadSource;
+
+    if (FanTemperatureSourceConfig_IsSet_LoadFeedforward(ftsc))
+      ftc->LoadFeedforward = ftsc->LoadFeedforward;
+
+    if (FanTemperatureSourceConfig_IsSet_LoadThreshold(ftsc))
+      ftc->LoadThreshold = ftsc->LoadThreshold;
+
     // If no sensors are given, use the defaults
     if (! ftsc->Sensors.size)
       continue;
@@ -324,10 +347,13 @@ Error* FanTemperatureControl_Init(
     return e;
 
   // Initialize the temperature filters
-  e = FanTemperatureControl_InitializeTemperatureFilters(fans, model_config->EcPollInterval);
+  e = FanTemperatureControl_InitializeTemperatureFilters(fans, model_config->TemperaturePollInterval);
   if (e)
     return e;
 
+  for_each_array(FanTemperatureControl*, ftc, *fans)
+    ftc->PredictionHorizon = model_config->TemperaturePredictionHorizon;
+
   return err_success();
 }
 
@@ -337,10 +363,26 @@ Error* FanTemperatureControl_UpdateFanTemperature(FanTemperatureControl* ftc) {
   if (e)
     return e;
 
+  ftc->RawTemperature = temp;
   ftc->Temperature = TemperatureFilter_FilterTemperature(&ftc->TemperatureFilter, temp);
+  ftc->PredictedTemperature = TemperatureFilter_Predict(&ftc->TemperatureFilter, ftc->Temperature, ftc->PredictionHorizon);
   return err_success();
 }
 
+// Bias the fan speed by the amount the sustained CPU load exceeds LoadThreshold.
+// The bias is quantized so that small load changes don't cause EC writes.
+void FanTemperatureControl_SetLoad(FanTemperatureControl* ftc, float load) {
+  float bias = 0;
+
+  if (ftc->LoadFeedforward > 0 && load > ftc->LoadThreshold) {
+    bias = ftc->LoadFeedforward * (load - ftc->LoadThreshold) / (100.0f - ftc->LoadThreshold);
+    bias = floorf(bias / FAN_TEMPERATURE_CONTROL_LOAD_STEP) * FAN_TEMPERATURE_CONTROL_LOAD_STEP;
+  }
+
+  ftc->LoadBias = bias;
+  Fan_SetLoadBias(&ftc->Fan, bias);
+}
+
 void FanTemperatureControl_Log(array_of(FanTemperatureControl)* fans, ModelConfig* model_config) {
   for_enumerate_array(int, fan_index, *fans) {
     FanTemperatureControl* ftc = &fans->data[fan_index];
@@ -352,5 +394,13 @@ void FanTemperatureControl_Log(array_of(FanTemperatureControl)* fans, ModelConfi
         ftc->TemperatureSources[i]->name,
         ftc->TemperatureSources[i]->file,
         TemperatureAlgorithmType_ToString(ftc->TemperatureAlgorithmType));
+
+    if (ftc->LoadFeedforward > 0)
+      Log_Info("Fan #%d (%s) adds up to %.0f%% above %.0f%% CPU load (%s)\n",
+        fan_index,
+        model_config->FanConfigurations.data[fan_index].FanDisplayName,
+        ftc->LoadFeedforward,
+        ftc->LoadThreshold,
+        LoadSource_ToString(ftc->LoadSource));
   }
 }
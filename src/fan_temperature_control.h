@@ -7,6 +7,7 @@
 #include "temperature_filter.h"
 
 #define FAN_TEMPERATURE_CONTROL_MAX_SOURCES 32
+#define FAN_TEMPERATURE_CONTROL_LOAD_STEP   5.0f // Granularity of the load bias in percent
 
 struct FanTemperatureControl {
   Fan                      Fan;
@@ -14,13 +15,22 @@ struct FanTemperatureControl {
   int                      TemperatureSourcesSize;
   TemperatureAlgorithmType TemperatureAlgorithmType;
   TemperatureFilter        TemperatureFilter;
+  float                    RawTemperature;
+  float                    AppliedTemperature; // Temperature passed to the fan
   float                    Temperature;
+  float                    PredictedTemperature;
+  int                      PredictionHorizon;  // Milliseconds, 0 if disabled
+  LoadSource               LoadSource;
+  float                    LoadFeedforward;    // Percent added at full load, 0 if disabled
+  float                    LoadThreshold;      // Load in percent where the bias starts
+  float                    LoadBias;           // Percent currently added to the fan speed
 };
 typedef struct FanTemperatureControl FanTemperatureControl;
 declare_array_of(FanTemperatureControl);
 
 Error* FanTemperatureControl_Init(array_of(FanTemperatureControl)*, ServiceConfig*, ModelConfig*);
 Error* FanTemperatureControl_UpdateFanTemperature(FanTemperatureControl*);
+void   FanTemperatureControl_SetLoad(FanTemperatureControl*, float load);
 void   FanTemperatureControl_Log(array_of(FanTemperatureControl)*, ModelConfig*);
 
 #endif
@@ -1,7 +1,9 @@
 #include "file_utils.h"
 
 #include <errno.h>
+#include <stdio.h>  // snprintf, rename
 #include <unistd.h>
+#include <linux/limits.h> // PATH_MAX
 
 ssize_t slurp_file(char* buf, ssize_t size, const char* file) {
   ssize_t   nread = -1;
@@ -38,3 +40,40 @@ ssize_t write_file(const char* file, int flags, mode_t mode, const char* content
 
   return nwritten;
 }
+
+// Write `content` to `file` by writing to a temporary file and renaming it,
+// so readers never see a partially written file.
+int write_file_atomic(const char* file, mode_t mode, const char* content, ssize_t size) {
+  char tmp_file[PATH_MAX];
+  if (snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", file) >= (int) sizeof(tmp_file)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+
+  const int fd = open(tmp_file, O_WRONLY|O_CREAT|O_TRUNC, mode);
+  if (fd == -1)
+    return -1;
+
+  ssize_t nwritten = write(fd, content, size);
+  if (nwritten >= 0 && nwritten != size)
+    errno = ENOSPC;
+
+  if (nwritten != size || fsync(fd) == -1) {
+    int old_errno = errno;
+    close(fd);
+    unlink(tmp_file);
+    errno = old_errno;
+    return -1;
+  }
+
+  close(fd);
+
+  if (rename(tmp_file, file) == -1) {
+    int old_errno = errno;
+    unlink(tmp_file);
+    errno = old_errno;
+    return -1;
+  }
+
+  return 0;
+}
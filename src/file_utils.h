@@ -7,5 +7,6 @@
 
 ssize_t slurp_file(char*, ssize_t, const char*);
 ssize_t write_file(const char*, int, mode_t, const char*, ssize_t);
+int     write_file_atomic(const char*, mode_t, const char*, ssize_t);
 
 #endif
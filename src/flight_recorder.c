@@ -0,0 +1,155 @@
+#include "flight_recorder.h"
+
+#include "macros.h"
+
+#include <fcntl.h>    // open, O_RDWR, O_CREAT
+#include <string.h>   // memcmp, memcpy, memset
+#include <unistd.h>   // close, ftruncate, pread
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+
+static bool FlightRecorder_HeaderMatches(const FlightRecorder_Header* header, size_t file_size, int fans) {
+  return file_size == sizeof(FlightRecorder_Header) + FlightRecorder_Capacity * FlightRecorder_RecordSize(fans)
+    && !memcmp(header->magic, FlightRecorder_Magic, sizeof(header->magic))
+    && header->record_size == FlightRecorder_RecordSize(fans)
+    && header->capacity == FlightRecorder_Capacity
+    && header->fans == (uint32_t) fans;
+}
+
+// Open the flight recorder for writing.
+// An existing file with the same layout is continued, so the history survives a restart.
+Error* FlightRecorder_Open(FlightRecorder* self, const char* file, int fans) {
+  Error* e = err_success();
+  struct stat st;
+  const size_t size = sizeof(FlightRecorder_Header) + FlightRecorder_Capacity * FlightRecorder_RecordSize(fans);
+
+  memset(self, 0, sizeof(*self));
+
+  const int fd = open(file, O_RDWR|O_CREAT, 0644);
+  if (fd < 0)
+    return err_stdlib(0, file);
+
+  if (fstat(fd, &st) < 0) {
+    e = err_stdlib(0, file);
+    goto end;
+  }
+
+  bool reuse = false;
+  if ((size_t) st.st_size == size) {
+    FlightRecorder_Header header;
+    reuse = pread(fd, &header, sizeof(header), 0) == sizeof(header)
+      && FlightRecorder_HeaderMatches(&header, st.st_size, fans);
+  }
+
+  if (! reuse && (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0)) {
+    e = err_stdlib(0, file);
+    goto end;
+  }
+
+  my.map = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  if (my.map == MAP_FAILED) {
+    my.map = NULL;
+    e = err_stdlib(0, file);
+    goto end;
+  }
+  my.map_size = size;
+  my.header = my.map;
+  my.records = (uint8_t*) my.map + sizeof(FlightRecorder_Header);
+
+  if (! reuse) {
+    memcpy(my.header->magic, FlightRecorder_Magic, sizeof(my.header->magic));
+    my.header->record_size = FlightRecorder_RecordSize(fans);
+    my.header->capacity = FlightRecorder_Capacity;
+    my.header->fans = fans;
+    my.header->next = 0;
+  }
+
+end:
+  close(fd);
+  return e;
+}
+
+// Append a record. The sequence number of `record` is ignored.
+void FlightRecorder_Write(FlightRecorder* self, FlightRecorder_Record* record) {
+  if (! my.map)
+    return;
+
+  const uint64_t n = my.header->next;
+  FlightRecorder_Record* slot = (FlightRecorder_Record*) (my.records + (n % my.header->capacity) * my.header->record_size);
+
+  // The fence keeps the copy from becoming visible before the slot is invalidated
+  __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy((uint8_t*) slot + sizeof(slot->sequence),
+         (uint8_t*) record + sizeof(record->sequence),
+         my.header->record_size - sizeof(record->sequence));
+  __atomic_store_n(&slot->sequence, n + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&my.header->next, n + 1, __ATOMIC_RELEASE);
+}
+
+void FlightRecorder_Close(FlightRecorder* self) {
+  if (my.map)
+    munmap(my.map, my.map_size);
+  memset(self, 0, sizeof(*self));
+}
+
+// Open the flight recorder for reading. Use FlightRecorder_Close() afterwards.
+Error* FlightRecorder_OpenRead(FlightRecorder* self, const char* file) {
+  Error* e = err_success();
+  struct stat st;
+
+  memset(self, 0, sizeof(*self));
+
+  const int fd = open(file, O_RDONLY);
+  if (fd < 0)
+    return err_stdlib(0, file);
+
+  if (fstat(fd, &st) < 0) {
+    e = err_stdlib(0, file);
+    goto end;
+  }
+
+  if ((size_t) st.st_size < sizeof(FlightRecorder_Header)) {
+    e = err_string(0, "File is not a flight recorder file");
+    goto end;
+  }
+
+  my.map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  if (my.map == MAP_FAILED) {
+    my.map = NULL;
+    e = err_stdlib(0, file);
+    goto end;
+  }
+  my.map_size = st.st_size;
+  my.header = my.map;
+  my.records = (uint8_t*) my.map + sizeof(FlightRecorder_Header);
+
+  if (memcmp(my.header->magic, FlightRecorder_Magic, sizeof(my.header->magic))) {
+    e = err_string(0, "File is not a flight recorder file");
+    goto end;
+  }
+
+  if (! FlightRecorder_HeaderMatches(my.header, my.map_size, my.header->fans)) {
+    e = err_string(0, "Invalid flight recorder header");
+    goto end;
+  }
+
+end:
+  close(fd);
+  if (e)
+    FlightRecorder_Close(self);
+  return e;
+}
+
+// Copy record number `n`. Returns false if it has been overwritten or is being written.
+bool FlightRecorder_Read(const FlightRecorder* self, uint64_t n, FlightRecorder_Record* out) {
+  const FlightRecorder_Record* slot = (const FlightRecorder_Record*) (my.records + (n % my.header->capacity) * my.header->record_size);
+
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != n + 1)
+    return false;
+
+  memcpy(out, slot, my.header->record_size);
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+  return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == n + 1;
+}
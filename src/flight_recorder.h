@@ -0,0 +1,102 @@
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include "error.h"
+
+#include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint8_t, uint16_t, uint32_t, uint64_t
+#include <time.h>    // clock_gettime
+
+/*
+ * Ring file of control loop ticks written by nbfc_service and read by `nbfc dump`.
+ *
+ * Layout (native byte order):
+ *   FlightRecorder_Header
+ *   FlightRecorder_Record[header.capacity]  (header.record_size bytes each)
+ *
+ * Record number N (counting from 0) is stored in slot N % capacity. A slot
+ * holds a complete record if its sequence number is N + 1.
+ */
+
+#define FlightRecorder_Magic    "NBFCFLT4"
+#define FlightRecorder_Capacity 4096
+
+enum FlightRecorder_Phase {
+  FlightRecorder_Phase_ReadSpeeds,     // Reading the current fan speeds
+  FlightRecorder_Phase_RegisterWrites, // Applying RegisterWriteConfigurations
+  FlightRecorder_Phase_Temperatures,   // Reading and filtering the temperatures
+  FlightRecorder_Phase_WriteSpeeds,    // Writing the fan speeds
+  FlightRecorder_Phase_Count,
+};
+typedef enum FlightRecorder_Phase FlightRecorder_Phase;
+
+enum FlightRecorder_Flags {
+  FlightRecorder_ReInit = 0x1,         // Fan speeds were off, register writes were re-applied
+  FlightRecorder_Error  = 0x2,         // The tick failed
+  FlightRecorder_PowerSave = 0x4,      // The power save policy was active
+  FlightRecorder_Resume = 0x8,         // First tick after a resume from suspend
+};
+
+struct FlightRecorder_Header {
+  char     magic[8];
+  uint32_t record_size;                // Size of a record in bytes
+  uint32_t capacity;                   // Number of records in the ring
+  uint32_t fans;                       // Number of fans per record
+  uint32_t reserved;
+  uint64_t next;                       // Number of records written so far
+};
+typedef struct FlightRecorder_Header FlightRecorder_Header;
+
+struct FlightRecorder_Fan {
+  float    raw_temperature;            // Before the temperature filter
+  float    temperature;                // After the temperature filter
+  float    predicted_temperature;      // Used for selecting the threshold
+  float    load_bias;                  // Percent added to the threshold speed by the CPU load
+  float    target_speed;
+  float    current_speed;
+  int16_t  threshold;                  // Index of the selected threshold, -1 if none
+  uint8_t  mode;                       // Fan_Mode
+  uint8_t  critical;
+};
+typedef struct FlightRecorder_Fan FlightRecorder_Fan;
+
+struct FlightRecorder_Record {
+  uint64_t sequence;                   // Record number + 1, 0 while being written
+  uint64_t timestamp;                  // Realtime clock, microseconds
+  uint32_t duration[FlightRecorder_Phase_Count]; // Microseconds
+  uint32_t total;                      // Duration of the whole tick, microseconds
+  uint32_t lateness;                   // How late the tick started, microseconds
+  uint16_t ec_writes;                  // Number of EC writes (or ACPI calls) issued
+  uint8_t  fans;
+  uint8_t  flags;                      // FlightRecorder_Flags
+  FlightRecorder_Fan fan[];
+};
+typedef struct FlightRecorder_Record FlightRecorder_Record;
+
+struct FlightRecorder {
+  FlightRecorder_Header* header;
+  uint8_t*               records;
+  void*                  map;
+  size_t                 map_size;
+};
+typedef struct FlightRecorder FlightRecorder;
+
+static inline size_t FlightRecorder_RecordSize(int fans) {
+  return sizeof(FlightRecorder_Record) + fans * sizeof(FlightRecorder_Fan);
+}
+
+static inline uint64_t FlightRecorder_Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+Error* FlightRecorder_Open(FlightRecorder*, const char*, int);
+void   FlightRecorder_Write(FlightRecorder*, FlightRecorder_Record*);
+void   FlightRecorder_Close(FlightRecorder*);
+
+Error* FlightRecorder_OpenRead(FlightRecorder*, const char*);
+bool   FlightRecorder_Read(const FlightRecorder*, uint64_t, FlightRecorder_Record*);
+
+#endif
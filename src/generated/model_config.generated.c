@@ -202,12 +202,24 @@ Error* FanConfiguration_ValidateFields(FanConfiguration* self) {
 	if (false)
 		return err_stringf(0, "%s: %s", "ReadAcpiMethod", "Missing option");
 
+	if (false)
+		return err_stringf(0, "%s: %s", "ReadHwmonFile", "Missing option");
+
+	if (! FanConfiguration_IsSet_MinSpeedRpm(self))
+		self->MinSpeedRpm = 0;
+
+	if (false)
+		return err_stringf(0, "%s: %s", "MaxSpeedRpm", "Missing option");
+
 	if (false)
 		return err_stringf(0, "%s: %s", "WriteRegister", "Missing option");
 
 	if (false)
 		return err_stringf(0, "%s: %s", "WriteAcpiMethod", "Missing option");
 
+	if (false)
+		return err_stringf(0, "%s: %s", "WriteHwmonFile", "Missing option");
+
 	if (! FanConfiguration_IsSet_MinSpeedValue(self))
 		return err_stringf(0, "%s: %s", "MinSpeedValue", "Missing option");
 
@@ -238,6 +250,19 @@ Error* FanConfiguration_ValidateFields(FanConfiguration* self) {
 	if (false)
 		return err_stringf(0, "%s: %s", "Sensors", "Missing option");
 
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadSource", "Missing option");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadFeedforward", "Missing option");
+	else if (! (self->LoadFeedforward >= 0.0 && self->LoadFeedforward <= 100.0))
+		return err_stringf(0, "%s: %s", "LoadFeedforward", "requires: parameter >= 0.0 && parameter <= 100.0");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadThreshold", "Missing option");
+	else if (! (self->LoadThreshold >= 0.0 && self->LoadThreshold < 100.0))
+		return err_stringf(0, "%s: %s", "LoadThreshold", "requires: parameter >= 0.0 && parameter < 100.0");
+
 	if (false)
 		return err_stringf(0, "%s: %s", "TemperatureThresholds", "Missing option");
 
@@ -271,6 +296,21 @@ Error* FanConfiguration_FromJson(FanConfiguration* obj, const nx_json* json) {
 			if (!e)
 				FanConfiguration_Set_ReadAcpiMethod(obj);
 		}
+		else if (!strcmp(c->key, "ReadHwmonFile")) {
+			e = str_FromJson(&obj->ReadHwmonFile, c);
+			if (!e)
+				FanConfiguration_Set_ReadHwmonFile(obj);
+		}
+		else if (!strcmp(c->key, "MinSpeedRpm")) {
+			e = uint16_t_FromJson(&obj->MinSpeedRpm, c);
+			if (!e)
+				FanConfiguration_Set_MinSpeedRpm(obj);
+		}
+		else if (!strcmp(c->key, "MaxSpeedRpm")) {
+			e = uint16_t_FromJson(&obj->MaxSpeedRpm, c);
+			if (!e)
+				FanConfiguration_Set_MaxSpeedRpm(obj);
+		}
 		else if (!strcmp(c->key, "WriteRegister")) {
 			e = uint8_t_FromJson(&obj->WriteRegister, c);
 			if (!e)
@@ -281,6 +321,11 @@ Error* FanConfiguration_FromJson(FanConfiguration* obj, const nx_json* json) {
 			if (!e)
 				FanConfiguration_Set_WriteAcpiMethod(obj);
 		}
+		else if (!strcmp(c->key, "WriteHwmonFile")) {
+			e = str_FromJson(&obj->WriteHwmonFile, c);
+			if (!e)
+				FanConfiguration_Set_WriteHwmonFile(obj);
+		}
 		else if (!strcmp(c->key, "MinSpeedValue")) {
 			e = uint16_t_FromJson(&obj->MinSpeedValue, c);
 			if (!e)
@@ -331,6 +376,21 @@ Error* FanConfiguration_FromJson(FanConfiguration* obj, const nx_json* json) {
 			if (!e)
 				FanConfiguration_Set_Sensors(obj);
 		}
+		else if (!strcmp(c->key, "LoadSource")) {
+			e = LoadSource_FromJson(&obj->LoadSource, c);
+			if (!e)
+				FanConfiguration_Set_LoadSource(obj);
+		}
+		else if (!strcmp(c->key, "LoadFeedforward")) {
+			e = float_FromJson(&obj->LoadFeedforward, c);
+			if (!e)
+				FanConfiguration_Set_LoadFeedforward(obj);
+		}
+		else if (!strcmp(c->key, "LoadThreshold")) {
+			e = float_FromJson(&obj->LoadThreshold, c);
+			if (!e)
+				FanConfiguration_Set_LoadThreshold(obj);
+		}
 		else if (!strcmp(c->key, "TemperatureThresholds")) {
 			e = array_of_TemperatureThreshold_FromJson(&obj->TemperatureThresholds, c);
 			if (!e)
@@ -413,6 +473,29 @@ Error* ModelConfig_ValidateFields(ModelConfig* self) {
 	if (! ModelConfig_IsSet_EcPollInterval(self))
 		self->EcPollInterval = 3000;
 
+	if (! ModelConfig_IsSet_TemperaturePollInterval(self))
+		self->TemperaturePollInterval = self->EcPollInterval;
+	else if (! (self->TemperaturePollInterval > 0))
+		return err_stringf(0, "%s: %s", "TemperaturePollInterval", "requires: parameter > 0");
+
+	if (! ModelConfig_IsSet_FanSpeedReadInterval(self))
+		self->FanSpeedReadInterval = self->EcPollInterval;
+	else if (! (self->FanSpeedReadInterval > 0))
+		return err_stringf(0, "%s: %s", "FanSpeedReadInterval", "requires: parameter > 0");
+
+	if (! ModelConfig_IsSet_RegisterWriteInterval(self))
+		self->RegisterWriteInterval = self->EcPollInterval;
+	else if (! (self->RegisterWriteInterval > 0))
+		return err_stringf(0, "%s: %s", "RegisterWriteInterval", "requires: parameter > 0");
+
+	if (! ModelConfig_IsSet_FanWriteInterval(self))
+		self->FanWriteInterval = self->EcPollInterval;
+	else if (! (self->FanWriteInterval > 0))
+		return err_stringf(0, "%s: %s", "FanWriteInterval", "requires: parameter > 0");
+
+	if (! ModelConfig_IsSet_TemperaturePredictionHorizon(self))
+		self->TemperaturePredictionHorizon = 0;
+
 	if (! ModelConfig_IsSet_CriticalTemperature(self))
 		self->CriticalTemperature = 75;
 
@@ -465,6 +548,31 @@ Error* ModelConfig_FromJson(ModelConfig* obj, const nx_json* json) {
 			if (!e)
 				ModelConfig_Set_EcPollInterval(obj);
 		}
+		else if (!strcmp(c->key, "TemperaturePollInterval")) {
+			e = uint16_t_FromJson(&obj->TemperaturePollInterval, c);
+			if (!e)
+				ModelConfig_Set_TemperaturePollInterval(obj);
+		}
+		else if (!strcmp(c->key, "FanSpeedReadInterval")) {
+			e = uint16_t_FromJson(&obj->FanSpeedReadInterval, c);
+			if (!e)
+				ModelConfig_Set_FanSpeedReadInterval(obj);
+		}
+		else if (!strcmp(c->key, "RegisterWriteInterval")) {
+			e = uint16_t_FromJson(&obj->RegisterWriteInterval, c);
+			if (!e)
+				ModelConfig_Set_RegisterWriteInterval(obj);
+		}
+		else if (!strcmp(c->key, "FanWriteInterval")) {
+			e = uint16_t_FromJson(&obj->FanWriteInterval, c);
+			if (!e)
+				ModelConfig_Set_FanWriteInterval(obj);
+		}
+		else if (!strcmp(c->key, "TemperaturePredictionHorizon")) {
+			e = uint16_t_FromJson(&obj->TemperaturePredictionHorizon, c);
+			if (!e)
+				ModelConfig_Set_TemperaturePredictionHorizon(obj);
+		}
 		else if (!strcmp(c->key, "CriticalTemperature")) {
 			e = int16_t_FromJson(&obj->CriticalTemperature, c);
 			if (!e)
@@ -511,6 +619,19 @@ Error* FanTemperatureSourceConfig_ValidateFields(FanTemperatureSourceConfig* sel
 
 	if (false)
 		return err_stringf(0, "%s: %s", "Sensors", "Missing option");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadSource", "Missing option");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadFeedforward", "Missing option");
+	else if (! (self->LoadFeedforward >= 0.0 && self->LoadFeedforward <= 100.0))
+		return err_stringf(0, "%s: %s", "LoadFeedforward", "requires: parameter >= 0.0 && parameter <= 100.0");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "LoadThreshold", "Missing option");
+	else if (! (self->LoadThreshold >= 0.0 && self->LoadThreshold < 100.0))
+		return err_stringf(0, "%s: %s", "LoadThreshold", "requires: parameter >= 0.0 && parameter < 100.0");
 	return err_success();
 }
 
@@ -539,6 +660,21 @@ Error* FanTemperatureSourceConfig_FromJson(FanTemperatureSourceConfig* obj, cons
 			if (!e)
 				FanTemperatureSourceConfig_Set_Sensors(obj);
 		}
+		else if (!strcmp(c->key, "LoadSource")) {
+			e = LoadSource_FromJson(&obj->LoadSource, c);
+			if (!e)
+				FanTemperatureSourceConfig_Set_LoadSource(obj);
+		}
+		else if (!strcmp(c->key, "LoadFeedforward")) {
+			e = float_FromJson(&obj->LoadFeedforward, c);
+			if (!e)
+				FanTemperatureSourceConfig_Set_LoadFeedforward(obj);
+		}
+		else if (!strcmp(c->key, "LoadThreshold")) {
+			e = float_FromJson(&obj->LoadThreshold, c);
+			if (!e)
+				FanTemperatureSourceConfig_Set_LoadThreshold(obj);
+		}
 		else
 			e = err_string(0, "Unknown option");
 		if (e) return err_string(e, c->key);
@@ -558,6 +694,16 @@ Error* ServiceConfig_ValidateFields(ServiceConfig* self) {
 
 	if (false)
 		return err_stringf(0, "%s: %s", "FanTemperatureSources", "Missing option");
+
+	if (! ServiceConfig_IsSet_PowerSaveIntervalFactor(self))
+		self->PowerSaveIntervalFactor = 2.0f;
+	else if (! (self->PowerSaveIntervalFactor >= 1.0))
+		return err_stringf(0, "%s: %s", "PowerSaveIntervalFactor", "requires: parameter >= 1.0");
+
+	if (! ServiceConfig_IsSet_PowerSaveHysteresis(self))
+		self->PowerSaveHysteresis = 2.0f;
+	else if (! (self->PowerSaveHysteresis >= 0.0))
+		return err_stringf(0, "%s: %s", "PowerSaveHysteresis", "requires: parameter >= 0.0");
 	return err_success();
 }
 
@@ -591,6 +737,16 @@ Error* ServiceConfig_FromJson(ServiceConfig* obj, const nx_json* json) {
 			if (!e)
 				ServiceConfig_Set_FanTemperatureSources(obj);
 		}
+		else if (!strcmp(c->key, "PowerSaveIntervalFactor")) {
+			e = float_FromJson(&obj->PowerSaveIntervalFactor, c);
+			if (!e)
+				ServiceConfig_Set_PowerSaveIntervalFactor(obj);
+		}
+		else if (!strcmp(c->key, "PowerSaveHysteresis")) {
+			e = float_FromJson(&obj->PowerSaveHysteresis, c);
+			if (!e)
+				ServiceConfig_Set_PowerSaveHysteresis(obj);
+		}
 		else
 			e = err_string(0, "Unknown option");
 		if (e) return err_string(e, c->key);
@@ -720,6 +876,12 @@ Error* ServiceInfo_ValidateFields(ServiceInfo* self) {
 	if (! ServiceInfo_IsSet_ReadOnly(self))
 		return err_stringf(0, "%s: %s", "ReadOnly", "Missing option");
 
+	if (false)
+		return err_stringf(0, "%s: %s", "PowerPolicy", "Missing option");
+
+	if (false)
+		return err_stringf(0, "%s: %s", "WakeupsPerMinute", "Missing option");
+
 	if (! ServiceInfo_IsSet_Fans(self))
 		return err_stringf(0, "%s: %s", "Fans", "Missing option");
 	return err_success();
@@ -750,6 +912,16 @@ Error* ServiceInfo_FromJson(ServiceInfo* obj, const nx_json* json) {
 			if (!e)
 				ServiceInfo_Set_ReadOnly(obj);
 		}
+		else if (!strcmp(c->key, "PowerPolicy")) {
+			e = str_FromJson(&obj->PowerPolicy, c);
+			if (!e)
+				ServiceInfo_Set_PowerPolicy(obj);
+		}
+		else if (!strcmp(c->key, "WakeupsPerMinute")) {
+			e = float_FromJson(&obj->WakeupsPerMinute, c);
+			if (!e)
+				ServiceInfo_Set_WakeupsPerMinute(obj);
+		}
 		else if (!strcmp(c->key, "Fans")) {
 			e = array_of_FanInfo_FromJson(&obj->Fans, c);
 			if (!e)
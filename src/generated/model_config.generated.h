@@ -239,8 +239,12 @@ struct FanConfiguration {
 	const char*     FanDisplayName;
 	uint8_t         ReadRegister;
 	const char*     ReadAcpiMethod;
+	const char*     ReadHwmonFile;
+	uint16_t        MinSpeedRpm;
+	uint16_t        MaxSpeedRpm;
 	uint8_t         WriteRegister;
 	const char*     WriteAcpiMethod;
+	const char*     WriteHwmonFile;
 	uint16_t        MinSpeedValue;
 	uint16_t        MaxSpeedValue;
 	uint16_t        MinSpeedValueRead;
@@ -251,6 +255,9 @@ struct FanConfiguration {
 	const char*     ResetAcpiMethod;
 	TemperatureAlgorithmType TemperatureAlgorithmType;
 	array_of(str)   Sensors;
+	LoadSource      LoadSource;
+	float           LoadFeedforward;
+	float           LoadThreshold;
 	array_of(TemperatureThreshold) TemperatureThresholds;
 	array_of(FanSpeedPercentageOverride) FanSpeedPercentageOverrides;
 	uint32_t        _set;
@@ -297,174 +304,258 @@ static inline bool FanConfiguration_IsSet_ReadAcpiMethod(const FanConfiguration*
 	return o->_set & (1 << 2);
 }
 
-static inline void FanConfiguration_Set_WriteRegister(FanConfiguration* o) {
+static inline void FanConfiguration_Set_ReadHwmonFile(FanConfiguration* o) {
 	o->_set |= (1 << 3);
 }
 
-static inline void FanConfiguration_UnSet_WriteRegister(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_ReadHwmonFile(FanConfiguration* o) {
 	o->_set &= ~(1 << 3);
 }
 
-static inline bool FanConfiguration_IsSet_WriteRegister(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_ReadHwmonFile(const FanConfiguration* o) {
 	return o->_set & (1 << 3);
 }
 
-static inline void FanConfiguration_Set_WriteAcpiMethod(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MinSpeedRpm(FanConfiguration* o) {
 	o->_set |= (1 << 4);
 }
 
-static inline void FanConfiguration_UnSet_WriteAcpiMethod(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MinSpeedRpm(FanConfiguration* o) {
 	o->_set &= ~(1 << 4);
 }
 
-static inline bool FanConfiguration_IsSet_WriteAcpiMethod(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MinSpeedRpm(const FanConfiguration* o) {
 	return o->_set & (1 << 4);
 }
 
-static inline void FanConfiguration_Set_MinSpeedValue(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MaxSpeedRpm(FanConfiguration* o) {
 	o->_set |= (1 << 5);
 }
 
-static inline void FanConfiguration_UnSet_MinSpeedValue(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MaxSpeedRpm(FanConfiguration* o) {
 	o->_set &= ~(1 << 5);
 }
 
-static inline bool FanConfiguration_IsSet_MinSpeedValue(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MaxSpeedRpm(const FanConfiguration* o) {
 	return o->_set & (1 << 5);
 }
 
-static inline void FanConfiguration_Set_MaxSpeedValue(FanConfiguration* o) {
+static inline void FanConfiguration_Set_WriteRegister(FanConfiguration* o) {
 	o->_set |= (1 << 6);
 }
 
-static inline void FanConfiguration_UnSet_MaxSpeedValue(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_WriteRegister(FanConfiguration* o) {
 	o->_set &= ~(1 << 6);
 }
 
-static inline bool FanConfiguration_IsSet_MaxSpeedValue(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_WriteRegister(const FanConfiguration* o) {
 	return o->_set & (1 << 6);
 }
 
-static inline void FanConfiguration_Set_MinSpeedValueRead(FanConfiguration* o) {
+static inline void FanConfiguration_Set_WriteAcpiMethod(FanConfiguration* o) {
 	o->_set |= (1 << 7);
 }
 
-static inline void FanConfiguration_UnSet_MinSpeedValueRead(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_WriteAcpiMethod(FanConfiguration* o) {
 	o->_set &= ~(1 << 7);
 }
 
-static inline bool FanConfiguration_IsSet_MinSpeedValueRead(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_WriteAcpiMethod(const FanConfiguration* o) {
 	return o->_set & (1 << 7);
 }
 
-static inline void FanConfiguration_Set_MaxSpeedValueRead(FanConfiguration* o) {
+static inline void FanConfiguration_Set_WriteHwmonFile(FanConfiguration* o) {
 	o->_set |= (1 << 8);
 }
 
-static inline void FanConfiguration_UnSet_MaxSpeedValueRead(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_WriteHwmonFile(FanConfiguration* o) {
 	o->_set &= ~(1 << 8);
 }
 
-static inline bool FanConfiguration_IsSet_MaxSpeedValueRead(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_WriteHwmonFile(const FanConfiguration* o) {
 	return o->_set & (1 << 8);
 }
 
-static inline void FanConfiguration_Set_IndependentReadMinMaxValues(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MinSpeedValue(FanConfiguration* o) {
 	o->_set |= (1 << 9);
 }
 
-static inline void FanConfiguration_UnSet_IndependentReadMinMaxValues(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MinSpeedValue(FanConfiguration* o) {
 	o->_set &= ~(1 << 9);
 }
 
-static inline bool FanConfiguration_IsSet_IndependentReadMinMaxValues(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MinSpeedValue(const FanConfiguration* o) {
 	return o->_set & (1 << 9);
 }
 
-static inline void FanConfiguration_Set_ResetRequired(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MaxSpeedValue(FanConfiguration* o) {
 	o->_set |= (1 << 10);
 }
 
-static inline void FanConfiguration_UnSet_ResetRequired(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MaxSpeedValue(FanConfiguration* o) {
 	o->_set &= ~(1 << 10);
 }
 
-static inline bool FanConfiguration_IsSet_ResetRequired(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MaxSpeedValue(const FanConfiguration* o) {
 	return o->_set & (1 << 10);
 }
 
-static inline void FanConfiguration_Set_FanSpeedResetValue(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MinSpeedValueRead(FanConfiguration* o) {
 	o->_set |= (1 << 11);
 }
 
-static inline void FanConfiguration_UnSet_FanSpeedResetValue(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MinSpeedValueRead(FanConfiguration* o) {
 	o->_set &= ~(1 << 11);
 }
 
-static inline bool FanConfiguration_IsSet_FanSpeedResetValue(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MinSpeedValueRead(const FanConfiguration* o) {
 	return o->_set & (1 << 11);
 }
 
-static inline void FanConfiguration_Set_ResetAcpiMethod(FanConfiguration* o) {
+static inline void FanConfiguration_Set_MaxSpeedValueRead(FanConfiguration* o) {
 	o->_set |= (1 << 12);
 }
 
-static inline void FanConfiguration_UnSet_ResetAcpiMethod(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_MaxSpeedValueRead(FanConfiguration* o) {
 	o->_set &= ~(1 << 12);
 }
 
-static inline bool FanConfiguration_IsSet_ResetAcpiMethod(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_MaxSpeedValueRead(const FanConfiguration* o) {
 	return o->_set & (1 << 12);
 }
 
-static inline void FanConfiguration_Set_TemperatureAlgorithmType(FanConfiguration* o) {
+static inline void FanConfiguration_Set_IndependentReadMinMaxValues(FanConfiguration* o) {
 	o->_set |= (1 << 13);
 }
 
-static inline void FanConfiguration_UnSet_TemperatureAlgorithmType(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_IndependentReadMinMaxValues(FanConfiguration* o) {
 	o->_set &= ~(1 << 13);
 }
 
-static inline bool FanConfiguration_IsSet_TemperatureAlgorithmType(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_IndependentReadMinMaxValues(const FanConfiguration* o) {
 	return o->_set & (1 << 13);
 }
 
-static inline void FanConfiguration_Set_Sensors(FanConfiguration* o) {
+static inline void FanConfiguration_Set_ResetRequired(FanConfiguration* o) {
 	o->_set |= (1 << 14);
 }
 
-static inline void FanConfiguration_UnSet_Sensors(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_ResetRequired(FanConfiguration* o) {
 	o->_set &= ~(1 << 14);
 }
 
-static inline bool FanConfiguration_IsSet_Sensors(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_ResetRequired(const FanConfiguration* o) {
 	return o->_set & (1 << 14);
 }
 
-static inline void FanConfiguration_Set_TemperatureThresholds(FanConfiguration* o) {
+static inline void FanConfiguration_Set_FanSpeedResetValue(FanConfiguration* o) {
 	o->_set |= (1 << 15);
 }
 
-static inline void FanConfiguration_UnSet_TemperatureThresholds(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_FanSpeedResetValue(FanConfiguration* o) {
 	o->_set &= ~(1 << 15);
 }
 
-static inline bool FanConfiguration_IsSet_TemperatureThresholds(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_FanSpeedResetValue(const FanConfiguration* o) {
 	return o->_set & (1 << 15);
 }
 
-static inline void FanConfiguration_Set_FanSpeedPercentageOverrides(FanConfiguration* o) {
+static inline void FanConfiguration_Set_ResetAcpiMethod(FanConfiguration* o) {
 	o->_set |= (1 << 16);
 }
 
-static inline void FanConfiguration_UnSet_FanSpeedPercentageOverrides(FanConfiguration* o) {
+static inline void FanConfiguration_UnSet_ResetAcpiMethod(FanConfiguration* o) {
 	o->_set &= ~(1 << 16);
 }
 
-static inline bool FanConfiguration_IsSet_FanSpeedPercentageOverrides(const FanConfiguration* o) {
+static inline bool FanConfiguration_IsSet_ResetAcpiMethod(const FanConfiguration* o) {
 	return o->_set & (1 << 16);
 }
 
+static inline void FanConfiguration_Set_TemperatureAlgorithmType(FanConfiguration* o) {
+	o->_set |= (1 << 17);
+}
+
+static inline void FanConfiguration_UnSet_TemperatureAlgorithmType(FanConfiguration* o) {
+	o->_set &= ~(1 << 17);
+}
+
+static inline bool FanConfiguration_IsSet_TemperatureAlgorithmType(const FanConfiguration* o) {
+	return o->_set & (1 << 17);
+}
+
+static inline void FanConfiguration_Set_Sensors(FanConfiguration* o) {
+	o->_set |= (1 << 18);
+}
+
+static inline void FanConfiguration_UnSet_Sensors(FanConfiguration* o) {
+	o->_set &= ~(1 << 18);
+}
+
+static inline bool FanConfiguration_IsSet_Sensors(const FanConfiguration* o) {
+	return o->_set & (1 << 18);
+}
+
+static inline void FanConfiguration_Set_LoadSource(FanConfiguration* o) {
+	o->_set |= (1 << 19);
+}
+
+static inline void FanConfiguration_UnSet_LoadSource(FanConfiguration* o) {
+	o->_set &= ~(1 << 19);
+}
+
+static inline bool FanConfiguration_IsSet_LoadSource(const FanConfiguration* o) {
+	return o->_set & (1 << 19);
+}
+
+static inline void FanConfiguration_Set_LoadFeedforward(FanConfiguration* o) {
+	o->_set |= (1 << 20);
+}
+
+static inline void FanConfiguration_UnSet_LoadFeedforward(FanConfiguration* o) {
+	o->_set &= ~(1 << 20);
+}
+
+static inline bool FanConfiguration_IsSet_LoadFeedforward(const FanConfiguration* o) {
+	return o->_set & (1 << 20);
+}
+
+static inline void FanConfiguration_Set_LoadThreshold(FanConfiguration* o) {
+	o->_set |= (1 << 21);
+}
+
+static inline void FanConfiguration_UnSet_LoadThreshold(FanConfiguration* o) {
+	o->_set &= ~(1 << 21);
+}
+
+static inline bool FanConfiguration_IsSet_LoadThreshold(const FanConfiguration* o) {
+	return o->_set & (1 << 21);
+}
+
+static inline void FanConfiguration_Set_TemperatureThresholds(FanConfiguration* o) {
+	o->_set |= (1 << 22);
+}
+
+static inline void FanConfiguration_UnSet_TemperatureThresholds(FanConfiguration* o) {
+	o->_set &= ~(1 << 22);
+}
+
+static inline bool FanConfiguration_IsSet_TemperatureThresholds(const FanConfiguration* o) {
+	return o->_set & (1 << 22);
+}
+
+static inline void FanConfiguration_Set_FanSpeedPercentageOverrides(FanConfiguration* o) {
+	o->_set |= (1 << 23);
+}
+
+static inline void FanConfiguration_UnSet_FanSpeedPercentageOverrides(FanConfiguration* o) {
+	o->_set &= ~(1 << 23);
+}
+
+static inline bool FanConfiguration_IsSet_FanSpeedPercentageOverrides(const FanConfiguration* o) {
+	return o->_set & (1 << 23);
+}
+
 struct Sponsor {
 	const char*     Name;
 	const char*     Description;
@@ -531,6 +622,11 @@ struct ModelConfig {
 	const char*     Author;
 	bool            LegacyTemperatureThresholdsBehaviour;
 	uint16_t        EcPollInterval;
+	uint16_t        TemperaturePollInterval;
+	uint16_t        FanSpeedReadInterval;
+	uint16_t        RegisterWriteInterval;
+	uint16_t        FanWriteInterval;
+	uint16_t        TemperaturePredictionHorizon;
 	int16_t         CriticalTemperature;
 	uint16_t        CriticalTemperatureOffset;
 	bool            ReadWriteWords;
@@ -593,82 +689,145 @@ static inline bool ModelConfig_IsSet_EcPollInterval(const ModelConfig* o) {
 	return o->_set & (1 << 3);
 }
 
-static inline void ModelConfig_Set_CriticalTemperature(ModelConfig* o) {
+static inline void ModelConfig_Set_TemperaturePollInterval(ModelConfig* o) {
 	o->_set |= (1 << 4);
 }
 
-static inline void ModelConfig_UnSet_CriticalTemperature(ModelConfig* o) {
+static inline void ModelConfig_UnSet_TemperaturePollInterval(ModelConfig* o) {
 	o->_set &= ~(1 << 4);
 }
 
-static inline bool ModelConfig_IsSet_CriticalTemperature(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_TemperaturePollInterval(const ModelConfig* o) {
 	return o->_set & (1 << 4);
 }
 
-static inline void ModelConfig_Set_CriticalTemperatureOffset(ModelConfig* o) {
+static inline void ModelConfig_Set_FanSpeedReadInterval(ModelConfig* o) {
 	o->_set |= (1 << 5);
 }
 
-static inline void ModelConfig_UnSet_CriticalTemperatureOffset(ModelConfig* o) {
+static inline void ModelConfig_UnSet_FanSpeedReadInterval(ModelConfig* o) {
 	o->_set &= ~(1 << 5);
 }
 
-static inline bool ModelConfig_IsSet_CriticalTemperatureOffset(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_FanSpeedReadInterval(const ModelConfig* o) {
 	return o->_set & (1 << 5);
 }
 
-static inline void ModelConfig_Set_ReadWriteWords(ModelConfig* o) {
+static inline void ModelConfig_Set_RegisterWriteInterval(ModelConfig* o) {
 	o->_set |= (1 << 6);
 }
 
-static inline void ModelConfig_UnSet_ReadWriteWords(ModelConfig* o) {
+static inline void ModelConfig_UnSet_RegisterWriteInterval(ModelConfig* o) {
 	o->_set &= ~(1 << 6);
 }
 
-static inline bool ModelConfig_IsSet_ReadWriteWords(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_RegisterWriteInterval(const ModelConfig* o) {
 	return o->_set & (1 << 6);
 }
 
-static inline void ModelConfig_Set_Sponsor(ModelConfig* o) {
+static inline void ModelConfig_Set_FanWriteInterval(ModelConfig* o) {
 	o->_set |= (1 << 7);
 }
 
-static inline void ModelConfig_UnSet_Sponsor(ModelConfig* o) {
+static inline void ModelConfig_UnSet_FanWriteInterval(ModelConfig* o) {
 	o->_set &= ~(1 << 7);
 }
 
-static inline bool ModelConfig_IsSet_Sponsor(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_FanWriteInterval(const ModelConfig* o) {
 	return o->_set & (1 << 7);
 }
 
-static inline void ModelConfig_Set_FanConfigurations(ModelConfig* o) {
+static inline void ModelConfig_Set_TemperaturePredictionHorizon(ModelConfig* o) {
 	o->_set |= (1 << 8);
 }
 
-static inline void ModelConfig_UnSet_FanConfigurations(ModelConfig* o) {
+static inline void ModelConfig_UnSet_TemperaturePredictionHorizon(ModelConfig* o) {
 	o->_set &= ~(1 << 8);
 }
 
-static inline bool ModelConfig_IsSet_FanConfigurations(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_TemperaturePredictionHorizon(const ModelConfig* o) {
 	return o->_set & (1 << 8);
 }
 
-static inline void ModelConfig_Set_RegisterWriteConfigurations(ModelConfig* o) {
+static inline void ModelConfig_Set_CriticalTemperature(ModelConfig* o) {
 	o->_set |= (1 << 9);
 }
 
-static inline void ModelConfig_UnSet_RegisterWriteConfigurations(ModelConfig* o) {
+static inline void ModelConfig_UnSet_CriticalTemperature(ModelConfig* o) {
 	o->_set &= ~(1 << 9);
 }
 
-static inline bool ModelConfig_IsSet_RegisterWriteConfigurations(const ModelConfig* o) {
+static inline bool ModelConfig_IsSet_CriticalTemperature(const ModelConfig* o) {
 	return o->_set & (1 << 9);
 }
 
+static inline void ModelConfig_Set_CriticalTemperatureOffset(ModelConfig* o) {
+	o->_set |= (1 << 10);
+}
+
+static inline void ModelConfig_UnSet_CriticalTemperatureOffset(ModelConfig* o) {
+	o->_set &= ~(1 << 10);
+}
+
+static inline bool ModelConfig_IsSet_CriticalTemperatureOffset(const ModelConfig* o) {
+	return o->_set & (1 << 10);
+}
+
+static inline void ModelConfig_Set_ReadWriteWords(ModelConfig* o) {
+	o->_set |= (1 << 11);
+}
+
+static inline void ModelConfig_UnSet_ReadWriteWords(ModelConfig* o) {
+	o->_set &= ~(1 << 11);
+}
+
+static inline bool ModelConfig_IsSet_ReadWriteWords(const ModelConfig* o) {
+	return o->_set & (1 << 11);
+}
+
+static inline void ModelConfig_Set_Sponsor(ModelConfig* o) {
+	o->_set |= (1 << 12);
+}
+
+static inline void ModelConfig_UnSet_Sponsor(ModelConfig* o) {
+	o->_set &= ~(1 << 12);
+}
+
+static inline bool ModelConfig_IsSet_Sponsor(const ModelConfig* o) {
+	return o->_set & (1 << 12);
+}
+
+static inline void ModelConfig_Set_FanConfigurations(ModelConfig* o) {
+	o->_set |= (1 << 13);
+}
+
+static inline void ModelConfig_UnSet_FanConfigurations(ModelConfig* o) {
+	o->_set &= ~(1 << 13);
+}
+
+static inline bool ModelConfig_IsSet_FanConfigurations(const ModelConfig* o) {
+	return o->_set & (1 << 13);
+}
+
+static inline void ModelConfig_Set_RegisterWriteConfigurations(ModelConfig* o) {
+	o->_set |= (1 << 14);
+}
+
+static inline void ModelConfig_UnSet_RegisterWriteConfigurations(ModelConfig* o) {
+	o->_set &= ~(1 << 14);
+}
+
+static inline bool ModelConfig_IsSet_RegisterWriteConfigurations(const ModelConfig* o) {
+	return o->_set & (1 << 14);
+}
+
 struct FanTemperatureSourceConfig {
 	uint8_t         FanIndex;
 	TemperatureAlgorithmType TemperatureAlgorithmType;
 	array_of(str)   Sensors;
+	LoadSource      LoadSource;
+	float           LoadFeedforward;
+	float           LoadThreshold;
 	uint8_t         _set;
 };
 
@@ -713,11 +872,49 @@ static inline bool FanTemperatureSourceConfig_IsSet_Sensors(const FanTemperature
 	return o->_set & (1 << 2);
 }
 
+static inline void FanTemperatureSourceConfig_Set_LoadSource(FanTemperatureSourceConfig* o) {
+	o->_set |= (1 << 3);
+}
+
+static inline void FanTemperatureSourceConfig_UnSet_LoadSource(FanTemperatureSourceConfig* o) {
+	o->_set &= ~(1 << 3);
+}
+
+static inline bool FanTemperatureSourceConfig_IsSet_LoadSource(const FanTemperatureSourceConfig* o) {
+	return o->_set & (1 << 3);
+}
+
+static inline void FanTemperatureSourceConfig_Set_LoadFeedforward(FanTemperatureSourceConfig* o) {
+	o->_set |= (1 << 4);
+}
+
+static inline void FanTemperatureSourceConfig_UnSet_LoadFeedforward(FanTemperatureSourceConfig* o) {
+	o->_set &= ~(1 << 4);
+}
+
+static inline bool FanTemperatureSourceConfig_IsSet_LoadFeedforward(const FanTemperatureSourceConfig* o) {
+	return o->_set & (1 << 4);
+}
+
+static inline void FanTemperatureSourceConfig_Set_LoadThreshold(FanTemperatureSourceConfig* o) {
+	o->_set |= (1 << 5);
+}
+
+static inline void FanTemperatureSourceConfig_UnSet_LoadThreshold(FanTemperatureSourceConfig* o) {
+	o->_set &= ~(1 << 5);
+}
+
+static inline bool FanTemperatureSourceConfig_IsSet_LoadThreshold(const FanTemperatureSourceConfig* o) {
+	return o->_set & (1 << 5);
+}
+
 struct ServiceConfig {
 	const char*     SelectedConfigId;
 	EmbeddedControllerType EmbeddedControllerType;
 	array_of(float) TargetFanSpeeds;
 	array_of(FanTemperatureSourceConfig) FanTemperatureSources;
+	float           PowerSaveIntervalFactor;
+	float           PowerSaveHysteresis;
 	uint8_t         _set;
 };
 
@@ -774,6 +971,30 @@ static inline bool ServiceConfig_IsSet_FanTemperatureSources(const ServiceConfig
 	return o->_set & (1 << 3);
 }
 
+static inline void ServiceConfig_Set_PowerSaveIntervalFactor(ServiceConfig* o) {
+	o->_set |= (1 << 4);
+}
+
+static inline void ServiceConfig_UnSet_PowerSaveIntervalFactor(ServiceConfig* o) {
+	o->_set &= ~(1 << 4);
+}
+
+static inline bool ServiceConfig_IsSet_PowerSaveIntervalFactor(const ServiceConfig* o) {
+	return o->_set & (1 << 4);
+}
+
+static inline void ServiceConfig_Set_PowerSaveHysteresis(ServiceConfig* o) {
+	o->_set |= (1 << 5);
+}
+
+static inline void ServiceConfig_UnSet_PowerSaveHysteresis(ServiceConfig* o) {
+	o->_set &= ~(1 << 5);
+}
+
+static inline bool ServiceConfig_IsSet_PowerSaveHysteresis(const ServiceConfig* o) {
+	return o->_set & (1 << 5);
+}
+
 struct ServiceState {
 	array_of(float) TargetFanSpeeds;
 	uint8_t         _set;
@@ -913,6 +1134,8 @@ struct ServiceInfo {
 	int             PID;
 	const char*     SelectedConfigId;
 	bool            ReadOnly;
+	const char*     PowerPolicy;
+	float           WakeupsPerMinute;
 	array_of(FanInfo) Fans;
 	uint8_t         _set;
 };
@@ -958,15 +1181,39 @@ static inline bool ServiceInfo_IsSet_ReadOnly(const ServiceInfo* o) {
 	return o->_set & (1 << 2);
 }
 
-static inline void ServiceInfo_Set_Fans(ServiceInfo* o) {
+static inline void ServiceInfo_Set_PowerPolicy(ServiceInfo* o) {
 	o->_set |= (1 << 3);
 }
 
-static inline void ServiceInfo_UnSet_Fans(ServiceInfo* o) {
+static inline void ServiceInfo_UnSet_PowerPolicy(ServiceInfo* o) {
 	o->_set &= ~(1 << 3);
 }
 
-static inline bool ServiceInfo_IsSet_Fans(const ServiceInfo* o) {
+static inline bool ServiceInfo_IsSet_PowerPolicy(const ServiceInfo* o) {
 	return o->_set & (1 << 3);
 }
 
+static inline void ServiceInfo_Set_WakeupsPerMinute(ServiceInfo* o) {
+	o->_set |= (1 << 4);
+}
+
+static inline void ServiceInfo_UnSet_WakeupsPerMinute(ServiceInfo* o) {
+	o->_set &= ~(1 << 4);
+}
+
+static inline bool ServiceInfo_IsSet_WakeupsPerMinute(const ServiceInfo* o) {
+	return o->_set & (1 << 4);
+}
+
+static inline void ServiceInfo_Set_Fans(ServiceInfo* o) {
+	o->_set |= (1 << 5);
+}
+
+static inline void ServiceInfo_UnSet_Fans(ServiceInfo* o) {
+	o->_set &= ~(1 << 5);
+}
+
+static inline bool ServiceInfo_IsSet_Fans(const ServiceInfo* o) {
+	return o->_set & (1 << 5);
+}
+
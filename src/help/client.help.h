@@ -17,6 +17,7 @@
  "    update              Download new configuration files\n"                  \
  "    wait-for-hwmon      Wait for /sys/class/hwmon/hwmon* files\n"            \
  "    get-model-name      Print out model name\n"                              \
+ "    dump                Print the flight recorder of the service\n"          \
  "    help                Show help\n"                                         \
  "    donate              Show how to support the project\n"                   \
  "    warranty            Show warranty\n"                                     \
@@ -33,12 +34,14 @@
  ""
 
 #define CLIENT_RESTART_HELP_TEXT                                               \
- "Usage: nbfc restart [-h] [-r]\n"                                             \
+ "Usage: nbfc restart [-h] [-r] [-l]\n"                                        \
  "\n"                                                                          \
  "Restart the NBFC service\n"                                                  \
  "\n"                                                                          \
  "Optional arguments:\n"                                                       \
  "  -r, --read-only       Restart in read-only mode\n"                         \
+ "  -l, --live            Re-execute the service without stopping the fan\n"   \
+ "                        control\n"                                           \
  "  -h, --help            Shows this message\n"                                \
  ""
 
@@ -127,7 +130,7 @@
  ""
 
 #define CLIENT_UPDATE_HELP_TEXT                                                \
- "Usage: nbfc update [-h] [-p NUM] [-q]\n"                                     \
+ "Usage: nbfc update [-h] [-p NUM] [-q] [-a]\n"                                \
  "\n"                                                                          \
  "Update the available configuration files and the model support database.\n"  \
  "\n"                                                                          \
@@ -135,6 +138,7 @@
  "  -h, --help            Show this help message and exit\n"                   \
  "  -p, --parallel NUM    Set the number of parallel downloads\n"              \
  "  -q, --quiet           Quiet mode\n"                                        \
+ "  -a, --archive         Download a single archive instead of each file\n"    \
  ""
 
 #define CLIENT_WAIT_FOR_HWMON_HELP_TEXT                                        \
@@ -165,6 +169,21 @@
  "  -h, --help            Shows this message and exit\n"                       \
  ""
 
+#define CLIENT_DUMP_HELP_TEXT                                                  \
+ "Usage: nbfc dump [-h] [-n COUNT] [-c] [-s] [FILE]\n"                         \
+ "\n"                                                                          \
+ "Print the control loop ticks recorded by the service.\n"                     \
+ "\n"                                                                          \
+ "Positional arguments:\n"                                                     \
+ "  FILE                  Flight recorder file to read\n"                      \
+ "\n"                                                                          \
+ "Optional arguments:\n"                                                       \
+ "  -h, --help            Show this help message and exit\n"                   \
+ "  -n, --count COUNT     Only print the last COUNT ticks\n"                   \
+ "  -c, --csv             Print comma separated values\n"                      \
+ "  -s, --stats           Print statistics of tick durations and lateness\n"   \
+ ""
+
 #define CLIENT_COMPLETE_FANS_HELP_TEXT                                         \
  "Usage: nbfc complete-fans [-h]\n"                                            \
  "\n"                                                                          \
@@ -15,6 +15,8 @@
  "  write                 Write a byte to a EC register\n"                     \
  "  monitor               Monitor all EC registers for changes\n"              \
  "  watch                 Monitor all EC registers for changes (alternative version)\n"\
+ "  capture               Record timestamped EC register samples to a file\n"  \
+ "  analyze               Find registers that follow temperatures and fan speeds\n" \
  "  acpi_call             Call an ACPI method\n"                               \
  "\n"                                                                          \
  "All input values are interpreted as decimal numbers by default. Hexadecimal values may be entered by prefixing them with \"0x\".\n"\
@@ -102,6 +104,39 @@
  "                        Sets how many seconds the program will run\n"        \
  ""
 
+#define EC_PROBE_CAPTURE_HELP_TEXT                                             \
+ "Usage: %s capture [-h] [-i milliseconds] [-t seconds] [-H] FILE\n"           \
+ "\n"                                                                          \
+ "Record timestamped EC register samples to a binary file\n"                   \
+ "\n"                                                                          \
+ "Positional arguments:\n"                                                     \
+ "  FILE                  Output file\n"                                       \
+ "\n"                                                                          \
+ "Optional arguments:\n"                                                       \
+ "  -h, --help            Show this help message and exit\n"                   \
+ "  -i milliseconds, --interval MILLISECONDS\n"                                \
+ "                        Sets the sampling interval in milliseconds (default: 100)\n"\
+ "  -t seconds, --timespan SECONDS\n"                                          \
+ "                        Sets how many seconds the program will run\n"        \
+ "  -H, --hwmon           Also record all hwmon temperatures and fan speeds\n" \
+ ""
+
+#define EC_PROBE_ANALYZE_HELP_TEXT                                             \
+ "Usage: %s analyze [-h] [-n COUNT] [-l seconds] FILE\n"                       \
+ "\n"                                                                          \
+ "Rank EC registers by their correlation to the hwmon channels of a capture\n" \
+ "\n"                                                                          \
+ "Positional arguments:\n"                                                     \
+ "  FILE                  Capture file (see `capture --hwmon`)\n"              \
+ "\n"                                                                          \
+ "Optional arguments:\n"                                                       \
+ "  -h, --help            Show this help message and exit\n"                   \
+ "  -n COUNT, --top COUNT\n"                                                   \
+ "                        Number of candidates to show per channel (default: 5)\n" \
+ "  -l seconds, --max-lag SECONDS\n"                                           \
+ "                        Maximum delay between register and channel (default: 30)\n" \
+ ""
+
 #define EC_PROBE_ACPI_CALL_HELP_TEXT                                           \
  "Usage: %s acpi_call [-h] METHOD [ARGUMENT...]\n"                             \
  "\n"                                                                          \
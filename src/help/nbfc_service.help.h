@@ -1,5 +1,5 @@
 #define NBFC_SERVICE_HELP_TEXT                                                 \
- "Usage: %s [-h] [-r] [-f] [-d] [-c config] [-s state.json] [-e EC]\n"         \
+ "Usage: %s [-h] [-r] [-f] [-d] [-c config] [-s state.json] [-e EC] [-R PRIO]\n"\
  "\n"                                                                          \
  "NoteBook FanControl service\n"                                               \
  "\n"                                                                          \
@@ -12,4 +12,11 @@
  "                        Use alternative config file (default " SYSCONFDIR "/nbfc/nbfc.json)\n"\
  "  -e EC, --embedded-controller EC\n"                                         \
  "                        Specify embedded controller to use\n"                \
+ "  -R PRIO, --realtime PRIO\n"                                                \
+ "                        Run the control loop with realtime priority PRIO (1-99)\n"\
+ "                        and lock the memory of the service\n"                \
+ "  --realtime-policy POLICY\n"                                                \
+ "                        Realtime scheduling policy: fifo (default) or rr\n"  \
+ "  --cpu-affinity CPUS\n"                                                     \
+ "                        Pin the control loop to CPUS (e.g. 0,2-3)\n"         \
  ""
@@ -0,0 +1,223 @@
+#include "hwmon.h"
+
+#include "macros.h"
+#include "memory.h"
+#include "file_utils.h"
+
+#include <dirent.h>  // opendir, readdir, closedir
+#include <errno.h>   // ENOENT, ENODATA, EINVAL
+#include <fcntl.h>   // open, O_CLOEXEC, O_RDWR
+#include <stdio.h>   // snprintf
+#include <stdlib.h>  // strtol
+#include <string.h>  // strchr, strcmp, strcspn
+#include <unistd.h>  // access, pread, pwrite, close
+#include <linux/limits.h> // PATH_MAX
+
+static const char Hwmon_Dir[] = "/sys/class/hwmon";
+
+// Resolve `spec` to a file path.
+// `spec` is either an absolute path or "NAME/FILE", where NAME is the name of a
+// hwmon device (as in /sys/class/hwmon/hwmon*/name). The hwmon numbering may
+// change between boots, the device names don't.
+Error* Hwmon_ResolvePath(const char* spec, char* path, int size) {
+  if (*spec == '/') {
+    snprintf(path, size, "%s", spec);
+    return err_success();
+  }
+
+  const char* slash = strchr(spec, '/');
+  if (! slash || slash == spec || strchr(slash + 1, '/'))
+    return (errno = EINVAL), err_stdlib(0, spec);
+
+  DIR* dir = opendir(Hwmon_Dir);
+  if (! dir)
+    return err_stdlib(0, Hwmon_Dir);
+
+  const int name_len = slash - spec;
+  struct dirent* entry;
+
+  while ((entry = readdir(dir))) {
+    char file[PATH_MAX], name[256];
+
+    if (entry->d_name[0] == '.')
+      continue;
+
+    snprintf(file, sizeof(file), "%s/%s/name", Hwmon_Dir, entry->d_name);
+    if (slurp_file(name, sizeof(name), file) < 0)
+      continue;
+
+    name[strcspn(name, "\n")] = '\0';
+    if (strncmp(name, spec, name_len) || name[name_len] != '\0')
+      continue;
+
+    // The attributes may also live in the device directory
+    snprintf(path, size, "%s/%s/%s", Hwmon_Dir, entry->d_name, slash + 1);
+    if (access(path, F_OK) == 0)
+      goto found;
+
+    snprintf(path, size, "%s/%s/device/%s", Hwmon_Dir, entry->d_name, slash + 1);
+    if (access(path, F_OK) == 0)
+      goto found;
+  }
+
+  closedir(dir);
+  return (errno = ENOENT), err_stdlib(0, spec);
+
+found:
+  closedir(dir);
+  return err_success();
+}
+
+Error* HwmonFile_Open(HwmonFile* self, const char* spec, int flags) {
+  char path[PATH_MAX];
+
+  Error* e = Hwmon_ResolvePath(spec, path, sizeof(path));
+  if (e)
+    return e;
+
+  my.fd = open(path, flags | O_CLOEXEC);
+  if (my.fd < 0)
+    return err_stdlib(0, path);
+
+  my.path = Mem_Strdup(path);
+  return err_success();
+}
+
+Error* HwmonFile_Read(const HwmonFile* self, long* out) {
+  char buf[32];
+
+  const ssize_t nread = pread(my.fd, buf, sizeof(buf) - 1, 0);
+  if (nread < 0)
+    return err_stdlib(0, my.path);
+
+  if (nread == 0)
+    return (errno = ENODATA), err_stdlib(0, my.path);
+
+  buf[nread] = '\0';
+
+  char* end;
+  errno = 0;
+  *out = strtol(buf, &end, 10);
+  if (end == buf)
+    errno = EINVAL;
+  if (errno)
+    return err_stdlib(0, my.path);
+
+  return err_success();
+}
+
+Error* HwmonFile_Write(const HwmonFile* self, long value) {
+  char buf[32];
+  const int len = snprintf(buf, sizeof(buf), "%ld", value);
+
+  if (pwrite(my.fd, buf, len, 0) != len)
+    return err_stdlib(0, my.path);
+
+  return err_success();
+}
+
+void HwmonFile_Close(HwmonFile* self) {
+  if (! my.path)
+    return;
+
+  close(my.fd);
+  Mem_Free(my.path);
+  my.path = NULL;
+}
+
+// ============================================================================
+// HwmonPwm
+// ============================================================================
+
+#define HWMON_PWM_MANUAL 1
+
+Error* HwmonPwm_Open(HwmonPwm* self, const char* spec) {
+  Error* e;
+  char enable[PATH_MAX];
+
+  my.enable.path = NULL;
+  my.manual = false;
+  my.valid = false;
+
+  e = HwmonFile_Open(&my.pwm, spec, O_RDWR);
+  if (e)
+    return e;
+
+  // Not every driver (or vendor file) has a pwmN_enable
+  snprintf(enable, sizeof(enable), "%s_enable", my.pwm.path);
+  if (access(enable, F_OK) != 0)
+    return err_success();
+
+  // Manual mode is taken on the first write
+  e = HwmonFile_Open(&my.enable, enable, O_RDWR);
+  if (! e)
+    e = HwmonFile_Read(&my.enable, &my.mode);
+  if (e) {
+    HwmonPwm_Close(self);
+    return e;
+  }
+
+  return err_success();
+}
+
+// Write `value` to pwmN, unless it is already there
+Error* HwmonPwm_Write(HwmonPwm* self, long value) {
+  Error* e;
+
+  if (my.valid && my.value == value)
+    return err_success();
+
+  // First write, or the firmware may have taken the fan back (e.g. after a resume)
+  if (my.enable.path && (! __atomic_load_n(&my.manual, __ATOMIC_ACQUIRE) || ! my.valid)) {
+    e = HwmonFile_Write(&my.enable, HWMON_PWM_MANUAL);
+    if (e)
+      return e;
+    __atomic_store_n(&my.manual, true, __ATOMIC_RELEASE);
+  }
+
+  e = HwmonFile_Write(&my.pwm, value);
+  my.value = value;
+  my.valid = !e;
+  return e;
+}
+
+// Write `value` from the critical watchdog thread. Manual mode is always
+// asserted, since the firmware may have taken the fan back. The cached value
+// belongs to the control loop and is left alone.
+Error* HwmonPwm_WriteCritical(HwmonPwm* self, long value) {
+  if (my.enable.path) {
+    Error* e = HwmonFile_Write(&my.enable, HWMON_PWM_MANUAL);
+    if (e)
+      return e;
+    __atomic_store_n(&my.manual, true, __ATOMIC_RELEASE);
+  }
+
+  return HwmonFile_Write(&my.pwm, value);
+}
+
+// Force the next HwmonPwm_Write() to write
+void HwmonPwm_Invalidate(HwmonPwm* self) {
+  my.valid = false;
+}
+
+// Restore the original pwmN_enable
+Error* HwmonPwm_Restore(HwmonPwm* self) {
+  my.valid = false;
+
+  if (! my.enable.path || ! __atomic_load_n(&my.manual, __ATOMIC_ACQUIRE))
+    return err_success();
+
+  Error* e = HwmonFile_Write(&my.enable, my.mode);
+  if (! e)
+    __atomic_store_n(&my.manual, false, __ATOMIC_RELEASE);
+  return e;
+}
+
+// Close the files. If the fan is still in manual mode (e.g. the service failed
+// before ResetEC()) it is handed back to the driver first.
+Error* HwmonPwm_Close(HwmonPwm* self) {
+  Error* e = HwmonPwm_Restore(self);
+  HwmonFile_Close(&my.pwm);
+  HwmonFile_Close(&my.enable);
+  return e;
+}
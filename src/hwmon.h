@@ -0,0 +1,42 @@
+#ifndef NBFC_HWMON_H_
+#define NBFC_HWMON_H_
+
+#include "error.h"
+
+#include <stdbool.h>
+
+// A sysfs attribute (like fan1_input or pwm1) that is kept open.
+// Reads and writes use pread()/pwrite(), so an access costs a single syscall.
+typedef struct HwmonFile HwmonFile;
+struct HwmonFile {
+  char* path; // NULL if closed
+  int   fd;
+};
+
+// A pwmN file used as fan actuator. The first HwmonPwm_Write() puts the fan
+// into manual mode (pwmN_enable = 1), HwmonPwm_Restore() hands it back to the
+// driver. Opening the file alone doesn't change anything (e.g. --read-only).
+typedef struct HwmonPwm HwmonPwm;
+struct HwmonPwm {
+  HwmonFile pwm;
+  HwmonFile enable;   // path is NULL if there is no pwmN_enable
+  long      mode;     // Original value of pwmN_enable
+  bool      manual;   // pwmN_enable has been switched to manual by us, accessed atomically
+  long      value;    // Last value written to pwmN
+  bool      valid;    // `value` is known to be in pwmN
+};
+
+Error* Hwmon_ResolvePath(const char* spec, char* path, int size);
+Error* HwmonFile_Open(HwmonFile*, const char* spec, int flags);
+Error* HwmonFile_Read(const HwmonFile*, long* out);
+Error* HwmonFile_Write(const HwmonFile*, long value);
+void   HwmonFile_Close(HwmonFile*);
+
+Error* HwmonPwm_Open(HwmonPwm*, const char* spec);
+Error* HwmonPwm_Write(HwmonPwm*, long value);
+Error* HwmonPwm_WriteCritical(HwmonPwm*, long value);
+void   HwmonPwm_Invalidate(HwmonPwm*);
+Error* HwmonPwm_Restore(HwmonPwm*);
+Error* HwmonPwm_Close(HwmonPwm*);
+
+#endif
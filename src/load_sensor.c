@@ -0,0 +1,131 @@
+#include "load_sensor.h"
+
+#include "macros.h"
+
+#include <errno.h>  // EINVAL, EPROTO
+#include <fcntl.h>  // open, O_RDONLY, O_CLOEXEC
+#include <stdio.h>  // sscanf
+#include <string.h> // strstr
+#include <time.h>   // clock_gettime
+#include <unistd.h> // pread, close
+
+static const char LoadSensor_StatFile[]     = "/proc/stat";
+static const char LoadSensor_PressureFile[] = "/proc/pressure/cpu";
+
+static uint64_t LoadSensor_Now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+Error* LoadSensor_Open(LoadSensor* self, LoadSource source, int timespan) {
+  if (timespan <= 0)
+    return (errno = EINVAL), err_stdlib(0, "timespan");
+
+  const char* file;
+  switch (source) {
+    case LoadSource_Utilization: file = LoadSensor_StatFile;     break;
+    case LoadSource_Pressure:    file = LoadSensor_PressureFile; break;
+    default: return (errno = EINVAL), err_stdlib(0, "source");
+  }
+
+  my.fd = open(file, O_RDONLY | O_CLOEXEC);
+  if (my.fd < 0)
+    return err_stdlib(0, file);
+
+  my.source = source;
+  my.timespan = timespan;
+  my.failing = false;
+  LoadSensor_Reset(self);
+  return err_success();
+}
+
+// Read the cumulative counters.
+// For /proc/stat `busy` and `total` are jiffies summed over all CPUs.
+// For /proc/pressure/cpu `busy` is the "some" stall time in microseconds,
+// `total` is left at zero and the wall clock is used instead.
+static Error* LoadSensor_ReadCounters(LoadSensor* self, uint64_t* busy, uint64_t* total) {
+  char buf[512];
+
+  const ssize_t nread = pread(my.fd, buf, sizeof(buf) - 1, 0);
+  if (nread < 0)
+    return err_stdlib(0, "pread");
+  buf[nread] = '\0';
+
+  if (my.source == LoadSource_Utilization) {
+    // cpu  user nice system idle iowait irq softirq steal
+    unsigned long long v[8] = {0};
+    if (sscanf(buf, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+          &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) < 4)
+      return (errno = EPROTO), err_stdlib(0, LoadSensor_StatFile);
+
+    *total = 0;
+    for (range(int, i, 0, 8))
+      *total += v[i];
+    *busy = *total - v[3] - v[4];
+  }
+  else {
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    unsigned long long stall;
+    const char* s = strstr(buf, "total=");
+    if (strncmp(buf, "some ", 5) || !s || sscanf(s, "total=%llu", &stall) != 1)
+      return (errno = EPROTO), err_stdlib(0, LoadSensor_PressureFile);
+
+    *busy = stall;
+    *total = 0;
+  }
+
+  return err_success();
+}
+
+Error* LoadSensor_Update(LoadSensor* self) {
+  uint64_t busy, total;
+  const uint64_t now = LoadSensor_Now();
+
+  Error* e = LoadSensor_ReadCounters(self, &busy, &total);
+  if (e)
+    return e;
+
+  if (my.valid && now > my.time) {
+    const uint64_t elapsed = now - my.time;
+    const uint64_t d_busy  = busy - my.busy;
+    const uint64_t d_total = (my.source == LoadSource_Utilization) ? total - my.total : elapsed;
+
+    if (d_total) {
+      float load = 100.0f * d_busy / d_total;
+      if (load > 100.0f)
+        load = 100.0f;
+
+      // Exponential moving average with a time constant of `timespan`
+      float alpha = elapsed / (my.timespan * 1000.0f);
+      if (alpha > 1.0f)
+        alpha = 1.0f;
+      my.load += alpha * (load - my.load);
+    }
+  }
+
+  my.busy  = busy;
+  my.total = total;
+  my.time  = now;
+  my.valid = true;
+  return err_success();
+}
+
+float LoadSensor_GetLoad(const LoadSensor* self) {
+  return my.load;
+}
+
+// Forget the previous sample, e.g. after a resume from suspend
+void LoadSensor_Reset(LoadSensor* self) {
+  my.busy  = 0;
+  my.total = 0;
+  my.time  = 0;
+  my.load  = 0;
+  my.valid = false;
+}
+
+void LoadSensor_Close(LoadSensor* self) {
+  if (my.fd >= 0)
+    close(my.fd);
+  my.fd = -1;
+}
@@ -0,0 +1,34 @@
+#ifndef NBFC_LOAD_SENSOR_H_
+#define NBFC_LOAD_SENSOR_H_
+
+#include "error.h"
+#include "model_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Samples the system wide CPU load from /proc/stat or /proc/pressure/cpu.
+//
+// The file is kept open and re-read with pread(), so a sample costs a single
+// syscall. The load is smoothed by an exponential moving average (not a
+// sliding window) so that short bursts don't spin up the fans.
+typedef struct LoadSensor LoadSensor;
+struct LoadSensor {
+  LoadSource source;
+  int        fd;        // -1 if closed
+  int        timespan;  // Smoothing time constant in milliseconds
+  uint64_t   busy;      // Busy jiffies or stall microseconds of the last sample
+  uint64_t   total;     // Total jiffies of the last sample
+  uint64_t   time;      // Monotonic time of the last sample, microseconds
+  float      load;      // Smoothed load in percent
+  bool       valid;     // The fields above hold a previous sample
+  bool       failing;   // The last update failed (it is only logged once)
+};
+
+Error* LoadSensor_Open(LoadSensor*, LoadSource, int timespan);
+Error* LoadSensor_Update(LoadSensor*);
+float  LoadSensor_GetLoad(const LoadSensor*);
+void   LoadSensor_Reset(LoadSensor*);
+void   LoadSensor_Close(LoadSensor*);
+
+#endif
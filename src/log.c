@@ -5,9 +5,16 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
 #if ENABLE_SYSLOG
 #include <syslog.h>
 #endif
+#if LOG_ASYNC
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
 
 #define LOG_BUFFER_SIZE 4096
 
@@ -15,134 +22,288 @@ LogLevel Log_LogLevel = LogLevel_Info;
 
 #if ENABLE_SYSLOG
 static bool Log_UseSyslog = false;
+
+static const int Log_SyslogPriority[] = {
+  [LogLevel_Error] = LOG_ERR,
+  [LogLevel_Warn]  = LOG_WARNING,
+  [LogLevel_Info]  = LOG_INFO,
+  [LogLevel_Debug] = LOG_DEBUG,
+};
 #endif
 
-void Log_Init(bool use_syslog) {
-#if ENABLE_SYSLOG
-  if (use_syslog) {
-    openlog(Program_Name, LOG_PID | LOG_CONS, LOG_DAEMON);
-    Log_UseSyslog = true;
+static const char* const Log_LevelName[] = {
+  [LogLevel_Error] = "ERROR",
+  [LogLevel_Warn]  = "WARNING",
+  [LogLevel_Info]  = "INFO",
+  [LogLevel_Debug] = "DEBUG",
+};
+
+#if LOG_ASYNC
+// ============================================================================
+// Asynchronous logging
+//
+// Producers format their message into a slot of a bounded lock-free queue
+// (Vyukov's MPMC queue, used here with a single consumer). A writer thread
+// drains the queue and writes the messages in batches. If the queue is full
+// the message is dropped and counted, the caller never blocks.
+// ============================================================================
+
+#define LOG_QUEUE_SIZE 256  // Must be a power of two
+#define LOG_SLOT_SIZE  1024
+
+struct Log_Slot {
+  size_t   sequence;
+  LogLevel level;
+  int      length;
+  char     message[LOG_SLOT_SIZE];
+};
+typedef struct Log_Slot Log_Slot;
+
+static struct {
+  bool      running;
+  bool      stop;
+  size_t    head;          // Next slot to be claimed by a producer
+  size_t    tail;          // Next slot to be read by the writer
+  size_t    dropped;
+  sem_t     wakeup;
+  pthread_t thread;
+  Log_Slot  slots[LOG_QUEUE_SIZE];
+} Log_Queue;
+
+static bool Log_Enqueue(LogLevel level, const char* fmt, va_list args) {
+  size_t pos = __atomic_load_n(&Log_Queue.head, __ATOMIC_RELAXED);
+  Log_Slot* slot;
+
+  for (;;) {
+    slot = &Log_Queue.slots[pos & (LOG_QUEUE_SIZE - 1)];
+    size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    ptrdiff_t diff = (ptrdiff_t) sequence - (ptrdiff_t) pos;
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&Log_Queue.head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if (diff < 0) {
+      __atomic_fetch_add(&Log_Queue.dropped, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+    else
+      pos = __atomic_load_n(&Log_Queue.head, __ATOMIC_RELAXED);
   }
-#endif
+
+  int length = vsnprintf(slot->message, sizeof(slot->message), fmt, args);
+  if (length < 0)
+    length = 0;
+  else if (length >= LOG_SLOT_SIZE) {
+    length = LOG_SLOT_SIZE - 1;
+    memcpy(slot->message + length - 4, "...\n", 4);
+  }
+
+  slot->level = level;
+  slot->length = length;
+  __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+  sem_post(&Log_Queue.wakeup);
+  return true;
 }
 
-void Log_Close() {
-#if ENABLE_SYSLOG
-  if (Log_UseSyslog)
-    closelog();
-#endif
+static void Log_WriteStderr(const char* buf, size_t size) {
+  while (size) {
+    ssize_t n = write(STDERR_FILENO, buf, size);
+    if (n <= 0)
+      return;
+    buf += n;
+    size -= n;
+  }
 }
 
-void Log_Error(const char* fmt, ...) {
-  if (Log_LogLevel < LogLevel_Error)
-    return;
+// Write all queued messages. Only called by the writer thread or after it has stopped.
+static void Log_Drain() {
+  char batch[LOG_BUFFER_SIZE * 4];
+  size_t batch_size = 0;
+  static size_t dropped_reported = 0;
+
+  for (;;) {
+    Log_Slot* slot = &Log_Queue.slots[Log_Queue.tail & (LOG_QUEUE_SIZE - 1)];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != Log_Queue.tail + 1)
+      break;
 
 #if ENABLE_SYSLOG
-  if (Log_UseSyslog) {
-    va_list args;
-    va_start(args, fmt);
+    if (Log_UseSyslog)
+      syslog(Log_SyslogPriority[slot->level], "%.*s", slot->length, slot->message);
+#endif
 
-    char buf[LOG_BUFFER_SIZE];
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    syslog(LOG_ERR, "%s", buf);
+    const size_t needed = strlen(Program_Name) + 16 + slot->length;
+    if (batch_size + needed > sizeof(batch)) {
+      Log_WriteStderr(batch, batch_size);
+      batch_size = 0;
+    }
+
+    batch_size += snprintf(batch + batch_size, sizeof(batch) - batch_size, "%s: %s: %.*s",
+      Program_Name, Log_LevelName[slot->level], slot->length, slot->message);
 
-    va_end(args);
+    __atomic_store_n(&slot->sequence, Log_Queue.tail + LOG_QUEUE_SIZE, __ATOMIC_RELEASE);
+    Log_Queue.tail++;
   }
-  //else
+
+  const size_t dropped = __atomic_load_n(&Log_Queue.dropped, __ATOMIC_RELAXED);
+  if (dropped != dropped_reported) {
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "%s: WARNING: Log queue full, dropped %zu messages\n",
+      Program_Name, dropped - dropped_reported);
+#if ENABLE_SYSLOG
+    if (Log_UseSyslog)
+      syslog(LOG_WARNING, "Log queue full, dropped %zu messages", dropped - dropped_reported);
 #endif
-  {
-    va_list args;
-    va_start(args, fmt);
+    if (batch_size + len > sizeof(batch)) {
+      Log_WriteStderr(batch, batch_size);
+      batch_size = 0;
+    }
+    memcpy(batch + batch_size, msg, len);
+    batch_size += len;
+    dropped_reported = dropped;
+  }
 
-    fprintf(stderr, "%s: ERROR: ", Program_Name);
-    vfprintf(stderr, fmt, args);
+  Log_WriteStderr(batch, batch_size);
+}
+
+static void* Log_Writer(void* arg) {
+  (void) arg;
+
+  while (! __atomic_load_n(&Log_Queue.stop, __ATOMIC_ACQUIRE)) {
+    sem_wait(&Log_Queue.wakeup);
 
-    va_end(args);
+    // Consume all pending wakeups, one drain handles all of them
+    while (sem_trywait(&Log_Queue.wakeup) == 0);
+
+    Log_Drain();
   }
+
+  return NULL;
 }
 
-void Log_Warn(const char* fmt, ...) {
-  if (Log_LogLevel < LogLevel_Warn)
+void Log_StartAsync() {
+  if (Log_Queue.running)
     return;
 
+  for (size_t i = 0; i < LOG_QUEUE_SIZE; ++i)
+    Log_Queue.slots[i].sequence = i;
+  Log_Queue.head = 0;
+  Log_Queue.tail = 0;
+  Log_Queue.stop = false;
 
-#if ENABLE_SYSLOG
-  if (Log_UseSyslog) {
-    va_list args;
-    va_start(args, fmt);
+  if (sem_init(&Log_Queue.wakeup, 0, 0) == 0) {
+    if (pthread_create(&Log_Queue.thread, NULL, Log_Writer, NULL) == 0) {
+      __atomic_store_n(&Log_Queue.running, true, __ATOMIC_RELEASE);
+      return;
+    }
 
-    char buf[LOG_BUFFER_SIZE];
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    syslog(LOG_WARNING, "%s", buf);
+    sem_destroy(&Log_Queue.wakeup);
+  }
+
+  Log_Warn("Could not start log thread, logging synchronously\n");
+}
+
+static void Log_StopAsync() {
+  if (! Log_Queue.running)
+    return;
 
-    va_end(args);
+  __atomic_store_n(&Log_Queue.running, false, __ATOMIC_RELEASE);
+  __atomic_store_n(&Log_Queue.stop, true, __ATOMIC_RELEASE);
+  sem_post(&Log_Queue.wakeup);
+  pthread_join(Log_Queue.thread, NULL);
+  sem_destroy(&Log_Queue.wakeup);
+
+  // Messages that were enqueued while the thread was stopping
+  Log_Drain();
+}
+#else
+void Log_StartAsync() {
+}
+#endif
+
+void Log_Init(bool use_syslog) {
+#if ENABLE_SYSLOG
+  if (use_syslog) {
+    openlog(Program_Name, LOG_PID | LOG_CONS, LOG_DAEMON);
+    Log_UseSyslog = true;
   }
-  //else
 #endif
-  {
-    va_list args;
-    va_start(args, fmt);
+}
 
-    fprintf(stderr, "%s: WARNING: ", Program_Name);
-    vfprintf(stderr, fmt, args);
+void Log_Close() {
+#if LOG_ASYNC
+  Log_StopAsync();
+#endif
 
-    va_end(args);
-  }
+#if ENABLE_SYSLOG
+  if (Log_UseSyslog)
+    closelog();
+#endif
 }
 
-void Log_Info(const char* fmt, ...) {
-  if (Log_LogLevel < LogLevel_Info)
+static void Log_Write(LogLevel level, const char* fmt, va_list args) {
+#if LOG_ASYNC
+  if (__atomic_load_n(&Log_Queue.running, __ATOMIC_ACQUIRE)) {
+    Log_Enqueue(level, fmt, args);
     return;
+  }
+#endif
 
 #if ENABLE_SYSLOG
   if (Log_UseSyslog) {
-    va_list args;
-    va_start(args, fmt);
+    va_list args_copy;
+    va_copy(args_copy, args);
 
     char buf[LOG_BUFFER_SIZE];
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    syslog(LOG_INFO, "%s", buf);
+    vsnprintf(buf, sizeof(buf), fmt, args_copy);
+    syslog(Log_SyslogPriority[level], "%s", buf);
 
-    va_end(args);
+    va_end(args_copy);
   }
   //else
 #endif
   {
-    va_list args;
-    va_start(args, fmt);
-
-    fprintf(stderr, "%s: INFO: ", Program_Name);
+    fprintf(stderr, "%s: %s: ", Program_Name, Log_LevelName[level]);
     vfprintf(stderr, fmt, args);
-
-    va_end(args);
   }
+}
+
+void Log_Error(const char* fmt, ...) {
+  if (Log_LogLevel < LogLevel_Error)
+    return;
 
+  va_list args;
+  va_start(args, fmt);
+  Log_Write(LogLevel_Error, fmt, args);
+  va_end(args);
 }
 
-void Log_Debug(const char* fmt, ...) {
-  if (Log_LogLevel < LogLevel_Debug)
+void Log_Warn(const char* fmt, ...) {
+  if (Log_LogLevel < LogLevel_Warn)
     return;
 
-#if ENABLE_SYSLOG
-  if (Log_UseSyslog) {
-    va_list args;
-    va_start(args, fmt);
+  va_list args;
+  va_start(args, fmt);
+  Log_Write(LogLevel_Warn, fmt, args);
+  va_end(args);
+}
 
-    char buf[LOG_BUFFER_SIZE];
-    vsnprintf(buf, sizeof(buf), fmt, args);
-    syslog(LOG_DEBUG, "%s", buf);
+void Log_Info(const char* fmt, ...) {
+  if (Log_LogLevel < LogLevel_Info)
+    return;
 
-    va_end(args);
-  }
-  //else
-#endif
-  {
-    va_list args;
-    va_start(args, fmt);
+  va_list args;
+  va_start(args, fmt);
+  Log_Write(LogLevel_Info, fmt, args);
+  va_end(args);
+}
 
-    fprintf(stderr, "%s: DEBUG: ", Program_Name);
-    vfprintf(stderr, fmt, args);
+void (Log_Debug)(const char* fmt, ...) {
+  if (Log_LogLevel < LogLevel_Debug)
+    return;
 
-    va_end(args);
-  }
+  va_list args;
+  va_start(args, fmt);
+  Log_Write(LogLevel_Debug, fmt, args);
+  va_end(args);
 }
@@ -16,9 +16,14 @@ extern LogLevel Log_LogLevel;
 
 void Log_Init(bool);
 void Log_Close();
+void Log_StartAsync();
 void Log_Error(const char* fmt, ...);
 void Log_Warn(const char* fmt, ...);
 void Log_Info(const char* fmt, ...);
-void Log_Debug(const char* fmt, ...);
+void (Log_Debug)(const char* fmt, ...);
+
+// Don't evaluate the arguments if debug logging is disabled
+#define Log_Debug(...) \
+  ((Log_LogLevel >= LogLevel_Debug) ? Log_Debug(__VA_ARGS__) : (void) 0)
 
 #endif
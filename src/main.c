@@ -1,6 +1,7 @@
 #include "nbfc.h"
 #include "service.h"
 #include "service_config.h"
+#include "service_state.h"
 #include "server.h"
 #include "error.h"
 #include "file_utils.h"
@@ -13,6 +14,11 @@
 #include "help/nbfc_service.help.h"
 #include "sleep.h"
 #include "mkdir_p.h"
+#include "critical_watchdog.h"
+#include "realtime.h"
+#include "parse_number.h"
+#include "reexec.h"
+#include "memory.h"
 
 #include <errno.h>  // errno
 #include <string.h> // strerror
@@ -22,17 +28,34 @@
 #include <locale.h> // setlocale, LC_NUMERIC
 #include <getopt.h> // getopt_long
 #include <unistd.h> // fork, setsid, chdir, geteuid
-#include <sys/time.h> // gettimeofday
+#include <time.h>   // clock_gettime, clock_nanosleep
+#include <sched.h>  // SCHED_FIFO
+#include <stdint.h> // UINT32_MAX
+#include <limits.h> // INT_MAX
+#include <sys/timerfd.h> // timerfd_create, timerfd_settime
 
 EC_VTable* ec;
 
 static volatile bool quit = false;
+static int reexec_state_fd = -1;
+
+static int64_t timespec_diff_us(const struct timespec* a, const struct timespec* b) {
+  return (int64_t) (a->tv_sec - b->tv_sec) * 1000000 + (a->tv_nsec - b->tv_nsec) / 1000;
+}
 
 static void sig_handler(int sig) {
   if (sig == SIGTERM || sig == SIGINT)
     quit = true;
+  else if (sig == SIGHUP)
+    Reexec_Request();
 }
 
+enum {
+  Option_RealtimePolicy = 0x100,
+  Option_CPUAffinity,
+  Option_ReexecState,
+};
+
 static struct option cli_options[] = {
   {"help",                no_argument,       NULL, 'h'},
   {"version",             no_argument,       NULL, 'v'},
@@ -41,14 +64,20 @@ static struct option cli_options[] = {
   {"fork",                no_argument,       NULL, 'f'},
   {"debug",               no_argument,       NULL, 'd'},
   {"config-file",         required_argument, NULL, 'c'},
+  {"realtime",            required_argument, NULL, 'R'},
+  {"realtime-policy",     required_argument, NULL, Option_RealtimePolicy},
+  {"cpu-affinity",        required_argument, NULL, Option_CPUAffinity},
+  {"reexec-state",        required_argument, NULL, Option_ReexecState}, // Internal, see Reexec_Exec()
   {0,                     0,                 0,     0 },
 };
 
-static const char cli_options_str[] = "hve:rfds:c:";
+static const char cli_options_str[] = "hve:rfds:c:R:";
 
 static void parse_opts(int argc, char* const argv[]) {
   int o;
   int option_index;
+  const char* err;
+  Error* e;
   while ((o = getopt_long(argc, argv, cli_options_str, cli_options, &option_index)) != -1) {
     switch (o) {
     case 'e':
@@ -68,6 +97,34 @@ static void parse_opts(int argc, char* const argv[]) {
         exit(NBFC_EXIT_CMDLINE);
       }
       break;
+    case 'R':
+      options.realtime_priority = parse_number(optarg, 1, 99, &err);
+      if (err) {
+        Log_Error("%s: %s: %s\n", "-R|--realtime", optarg, err);
+        exit(NBFC_EXIT_CMDLINE);
+      }
+      break;
+    case Option_RealtimePolicy:
+      e = Realtime_ParsePolicy(optarg, &options.realtime_policy);
+      if (e) {
+        Log_Error("%s: %s: %s\n", "--realtime-policy", optarg, err_print_all(e));
+        exit(NBFC_EXIT_CMDLINE);
+      }
+      break;
+    case Option_CPUAffinity:
+      e = Realtime_ParseCPUSet(optarg, &options.cpu_affinity);
+      if (e) {
+        Log_Error("%s: %s: %s\n", "--cpu-affinity", optarg, err_print_all(e));
+        exit(NBFC_EXIT_CMDLINE);
+      }
+      break;
+    case Option_ReexecState:
+      reexec_state_fd = parse_number(optarg, 0, INT_MAX, &err);
+      if (err) {
+        Log_Error("%s: %s: %s\n", "--reexec-state", optarg, err);
+        exit(NBFC_EXIT_CMDLINE);
+      }
+      break;
     case 'v':  printf("nbfc-linux " NBFC_VERSION "\n"); exit(0);   break;
     case 'h':  printf(NBFC_SERVICE_HELP_TEXT, argv[0]); exit(0);   break;
     case 'r':  options.read_only      = 1;                         break;
@@ -82,6 +139,67 @@ static void parse_opts(int argc, char* const argv[]) {
   }
 }
 
+// Start the threads that don't survive fork() and exec()
+static void start_threads() {
+  Error* e;
+
+  if (! options.read_only) {
+    e = CriticalWatchdog_Start(&Service_Fans);
+    e_warn();
+  }
+
+  if (options.realtime_priority) {
+    // The server must not inherit the realtime priority, so it gets its own
+    // thread. It is stopped by Server_Close().
+    e = Server_StartThread();
+    if (e) {
+      Log_Error("%s\n", err_print_all(e));
+      exit(NBFC_EXIT_FAILURE);
+    }
+  }
+}
+
+// Replace the running binary by a new instance of it without stopping the
+// fan control. The EC is not reset, the socket and the EC stay open and the
+// state of the fans is passed on. Only returns if the exec failed.
+static void reexec(char* const argv[]) {
+  Error* e;
+  Reexec_State state = {0};
+
+  CriticalWatchdog_Stop();
+  Server_StopThread();
+
+  Service_WriteTargetFanSpeedsToState();
+  e = ServiceState_Write();
+  e_warn();
+
+  Service_GetReexecState(&state);
+  state.server_fd = Server_GetFD();
+
+  // The scheduling policy survives exec(), but the new binary has to start
+  // its threads with a normal priority
+  if (options.realtime_priority) {
+    e = Realtime_SetScheduler(SCHED_OTHER, 0);
+    e_warn();
+  }
+
+  // Flushes the log thread
+  Log_Close();
+
+  e = Reexec_Exec(&state, argv);
+
+  Log_Init(options.fork);
+  Log_StartAsync();
+  Log_Error("%s\n", err_print_all(e));
+  Reexec_Free(&state);
+  start_threads();
+
+  if (options.realtime_priority) {
+    e = Realtime_SetScheduler(options.realtime_policy, options.realtime_priority);
+    e_warn();
+  }
+}
+
 int main(int argc, char* const argv[])
 {
   Error* e;
@@ -94,8 +212,10 @@ int main(int argc, char* const argv[])
   signal(SIGTERM, sig_handler);
   signal(SIGUSR1, sig_handler);
   signal(SIGUSR2, sig_handler);
+  signal(SIGHUP,  sig_handler);
 
   options.embedded_controller_type = EmbeddedControllerType_Unset;
+  options.realtime_policy = SCHED_FIFO;
   snprintf(options.service_config, sizeof(options.service_config), "%s", NBFC_SERVICE_CONFIG);
   parse_opts(argc, argv);
 
@@ -146,10 +266,29 @@ int main(int argc, char* const argv[])
   if (options.read_only)
     Log_Info("Read-only mode enabled\n");
 
-  e = PID_Write(true);
+  e = Reexec_Init();
   if (e) {
-    Log_Error("%s\n", err_print_all(e));
-    return NBFC_EXIT_INIT;
+    e = err_string(e, "Live re-exec disabled");
+    e_warn();
+  }
+
+  if (reexec_state_fd >= 0) {
+    e = Reexec_Load(reexec_state_fd);
+    if (e) {
+      Log_Error("%s\n", err_print_all(e));
+      return NBFC_EXIT_INIT;
+    }
+
+    Log_Info("Continuing after re-exec\n");
+  }
+
+  // After a re-exec the PID file is ours already
+  if (! Reexec_Inherited) {
+    e = PID_Write(true);
+    if (e) {
+      Log_Error("%s\n", err_print_all(e));
+      return NBFC_EXIT_INIT;
+    }
   }
 
   atexit(PID_Cleanup);
@@ -162,7 +301,10 @@ int main(int argc, char* const argv[])
 
   atexit(Service_Cleanup);
 
-  e = Server_Init();
+  if (Reexec_Inherited)
+    e = Server_Adopt(Reexec_Inherited->server_fd);
+  else
+    e = Server_Init();
   if (e) {
     Log_Error("%s\n", err_print_all(e));
     return NBFC_EXIT_INIT;
@@ -170,6 +312,13 @@ int main(int argc, char* const argv[])
 
   atexit(Server_Close);
 
+  if (Reexec_Inherited) {
+    Reexec_Free(Reexec_Inherited);
+    Mem_Free(Reexec_Inherited);
+    Reexec_Inherited = NULL;
+    options.fork = false; // Already a daemon
+  }
+
   // We need to call Service_Loop once to catch and print errors early,
   // since we will fork and close STDERR later.
   e = Service_Loop();
@@ -215,14 +364,60 @@ int main(int argc, char* const argv[])
     }
   }
 
+  // Threads don't survive fork(), so they are started afterwards
+  Log_StartAsync();
+  start_threads();
+
+  if (options.realtime_priority) {
+    e = Realtime_LockMemory();
+    e_warn();
+
+    e = Realtime_SetScheduler(options.realtime_policy, options.realtime_priority);
+    if (e)
+      e_warn();
+    else
+      Log_Info("Control loop runs with %s priority %d\n",
+        options.realtime_policy == SCHED_RR ? "SCHED_RR" : "SCHED_FIFO", options.realtime_priority);
+  }
+
+  if (options.cpu_affinity.set) {
+    e = Realtime_SetAffinity(&options.cpu_affinity);
+    e_warn();
+  }
+
+  // Ticks are scheduled on CLOCK_BOOTTIME, which keeps running during suspend,
+  // so the first tick after a resume is due immediately.
+  int timer_fd = -1;
+  if (! options.realtime_priority) {
+    timer_fd = timerfd_create(CLOCK_BOOTTIME, TFD_CLOEXEC);
+    if (timer_fd < 0)
+      Log_Warn("timerfd_create(): %s\n", strerror(errno));
+    else
+      Server_SetWakeFD(timer_fd);
+  }
+
   int failures = 0;
+  struct timespec next;
+  clock_gettime(CLOCK_BOOTTIME, &next);
 
   while (!quit) {
+    if (Reexec_Requested()) {
+      reexec(argv);
+      clock_gettime(CLOCK_BOOTTIME, &next);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    const int64_t lateness = timespec_diff_us(&now, &next);
+    Service_SetTickLateness(lateness < 0 ? 0 : lateness > UINT32_MAX ? UINT32_MAX : lateness);
+
     // ========================================================================
     // Run the service loop.
     // This does the main work of the service.
     // ========================================================================
+    Service_Lock();
     e = Service_Loop();
+    Service_Unlock();
     if (! e) {
       failures = 0;
     }
@@ -233,24 +428,45 @@ int main(int argc, char* const argv[])
         return NBFC_EXIT_FAILURE;
       }
       sleep_ms(10);
+      clock_gettime(CLOCK_BOOTTIME, &next);
       continue;
     }
 
+    // Schedule the next tick. If we are more than a whole interval behind
+    // (e.g. after suspend) start a new schedule instead of catching up.
+    const int interval = Service_GetTickInterval();
+    if (lateness > interval * 1000)
+      next = now;
+    next.tv_sec  += interval / 1000;
+    next.tv_nsec += (interval % 1000) * 1000000L;
+    if (next.tv_nsec >= 1000000000L) {
+      next.tv_sec++;
+      next.tv_nsec -= 1000000000L;
+    }
+
     // ========================================================================
-    // Run the server loop for Service_Model_Config.EcPollInterval miliseconds.
+    // In realtime mode the server has its own thread, just sleep.
+    // Otherwise run the server loop until the next tick is due.
     // ========================================================================
-    struct timeval start, current;
-    gettimeofday(&start, NULL);
+    if (options.realtime_priority) {
+      while (!quit && !Reexec_Requested() && clock_nanosleep(CLOCK_BOOTTIME, TIMER_ABSTIME, &next, NULL) == EINTR);
+      continue;
+    }
+
+    if (timer_fd >= 0) {
+      const struct itimerspec timer = { .it_value = next };
+      if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer, NULL) < 0)
+        Log_Warn("timerfd_settime(): %s\n", strerror(errno));
+    }
 
-    while (!quit) {
-      gettimeofday(&current, NULL);
-      int elapsed = (current.tv_sec - start.tv_sec) * 1000 + (current.tv_usec - start.tv_usec) / 1000;
-      int timeout = Service_Model_Config.EcPollInterval - elapsed;
+    while (!quit && !Reexec_Requested()) {
+      clock_gettime(CLOCK_BOOTTIME, &now);
+      const int64_t remaining = timespec_diff_us(&next, &now);
 
-      if (timeout <= 0)
+      if (remaining <= 0)
         break;
 
-      e = Server_Loop(timeout);
+      e = Server_Loop(timer_fd >= 0 ? -1 : (remaining + 999) / 1000);
       e_warn();
     }
   }
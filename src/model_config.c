@@ -149,6 +149,23 @@ static Error* TemperatureAlgorithmType_FromJson(TemperatureAlgorithmType* out, c
   return e;
 }
 
+LoadSource LoadSource_FromString(const char* s) {
+  if (!strcmp(s, "Utilization")) return LoadSource_Utilization;
+  if (!strcmp(s, "Pressure"))    return LoadSource_Pressure;
+  return LoadSource_Unset;
+}
+
+static Error* LoadSource_FromJson(LoadSource* out, const nx_json* json) {
+  const char* s; // NOLINT
+  Error* e = nx_json_get_str(&s, json);
+  if (e) return e;
+  LoadSource l = LoadSource_FromString(s);
+  if (l == LoadSource_Unset)
+    return err_stringf(0, "Invalid value for %s: %s", "LoadSource", s);
+  *out = l;
+  return e;
+}
+
 static Error* EmbeddedControllerType_FromJson(EmbeddedControllerType* out, const nx_json* json) {
   const char* s; // NOLINT
   Error* e = nx_json_get_str(&s, json);
@@ -248,6 +265,15 @@ const char* TemperatureAlgorithmType_ToString(TemperatureAlgorithmType t) {
   return NULL;
 }
 
+const char* LoadSource_ToString(LoadSource l) {
+  switch (l) {
+  case LoadSource_Utilization: return "Utilization";
+  case LoadSource_Pressure:    return "Pressure";
+  default: assert(!"Invalid value for LoadSource");
+  }
+  return NULL;
+}
+
 typedef Error* (FromJson_Callback)(void*, const nx_json*);
 
 static Error* array_of_FromJson(FromJson_Callback callback, void** v_data, ssize_t* v_size, ssize_t size, const nx_json* json) {
@@ -339,7 +365,9 @@ void ModelConfig_Free(ModelConfig* c) {
   for_each_array(FanConfiguration*, f, c->FanConfigurations) {
     Mem_Free((char*) f->FanDisplayName);
     Mem_Free((char*) f->ReadAcpiMethod);
+    Mem_Free((char*) f->ReadHwmonFile);
     Mem_Free((char*) f->WriteAcpiMethod);
+    Mem_Free((char*) f->WriteHwmonFile);
     Mem_Free((char*) f->ResetAcpiMethod);
     Mem_Free(f->TemperatureThresholds.data);
     Mem_Free(f->FanSpeedPercentageOverrides.data);
@@ -539,10 +567,11 @@ Error* ModelConfig_Validate(Trace* trace, ModelConfig* c) {
       }
     }
 
-    // Ensure that one (and only one) of "WriteRegister" and "WriteAcpiMethod" is set
+    // Ensure that one (and only one) of "WriteRegister" and "WriteAcpiMethod" is set.
+    // They may be omitted if "WriteHwmonFile" is given.
     const int write_group = (FanConfiguration_IsSet_WriteRegister(f) + FanConfiguration_IsSet_WriteAcpiMethod(f));
-    if (write_group == 0) {
-      e = err_stringf(0, "Missing option: %s or %s", "WriteRegister", "WriteAcpiMethod");
+    if (write_group == 0 && ! FanConfiguration_IsSet_WriteHwmonFile(f)) {
+      e = err_stringf(0, "Missing option: %s, %s or %s", "WriteRegister", "WriteAcpiMethod", "WriteHwmonFile");
       goto err;
     }
     if (write_group > 1) {
@@ -550,10 +579,11 @@ Error* ModelConfig_Validate(Trace* trace, ModelConfig* c) {
       goto err;
     }
 
-    // Ensure that one (and only one) of "ReadRegister" and "ReadAcpiMethod" is set
+    // Ensure that one (and only one) of "ReadRegister" and "ReadAcpiMethod" is set.
+    // They may be omitted if "ReadHwmonFile" is given.
     const int read_group = (FanConfiguration_IsSet_ReadRegister(f) + FanConfiguration_IsSet_ReadAcpiMethod(f));
-    if (read_group == 0) {
-      e = err_stringf(0, "Missing option: %s or %s", "ReadRegister", "ReadAcpiMethod");
+    if (read_group == 0 && ! FanConfiguration_IsSet_ReadHwmonFile(f)) {
+      e = err_stringf(0, "Missing option: %s, %s or %s", "ReadRegister", "ReadAcpiMethod", "ReadHwmonFile");
       goto err;
     }
     if (read_group > 1) {
@@ -561,6 +591,18 @@ Error* ModelConfig_Validate(Trace* trace, ModelConfig* c) {
       goto err;
     }
 
+    if (FanConfiguration_IsSet_ReadHwmonFile(f)) {
+      if (! FanConfiguration_IsSet_MaxSpeedRpm(f)) {
+        e = err_stringf(0, "%s: %s", "MaxSpeedRpm", "Missing option");
+        goto err;
+      }
+
+      if (f->MinSpeedRpm >= f->MaxSpeedRpm) {
+        e = err_stringf(0, "%s must be greater than %s", "MaxSpeedRpm", "MinSpeedRpm");
+        goto err;
+      }
+    }
+
     if (f->MinSpeedValue == f->MaxSpeedValue) {
       e = err_stringf(0, "%s and %s cannot be the same", "MinSpeedValue", "MaxSpeedValue");
       goto err;
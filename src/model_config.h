@@ -47,11 +47,18 @@ enum NBFC_PACKED_ENUM TemperatureAlgorithmType_ {
   TemperatureAlgorithmType_Unset,
 };
 
+enum NBFC_PACKED_ENUM LoadSource_ {
+  LoadSource_Utilization,
+  LoadSource_Pressure,
+  LoadSource_Unset,
+};
+
 typedef enum RegisterWriteMode_        RegisterWriteMode;
 typedef enum RegisterWriteOccasion_    RegisterWriteOccasion;
 typedef enum OverrideTargetOperation_  OverrideTargetOperation;
 typedef enum EmbeddedControllerType_   EmbeddedControllerType;
 typedef enum TemperatureAlgorithmType_ TemperatureAlgorithmType;
+typedef enum LoadSource_               LoadSource;
 
 #else /* no packed enums */
 
@@ -60,6 +67,7 @@ typedef char                          RegisterWriteOccasion;
 typedef char                          OverrideTargetOperation;
 typedef char                          EmbeddedControllerType;
 typedef char                          TemperatureAlgorithmType;
+typedef char                          LoadSource;
 
 #endif /* packed enums */
 
@@ -72,6 +80,8 @@ EmbeddedControllerType    EmbeddedControllerType_FromString(const char*);
 const char*               EmbeddedControllerType_ToString(EmbeddedControllerType);
 TemperatureAlgorithmType  TemperatureAlgorithmType_FromString(const char*);
 const char*               TemperatureAlgorithmType_ToString(TemperatureAlgorithmType);
+LoadSource                LoadSource_FromString(const char*);
+const char*               LoadSource_ToString(LoadSource);
 
 Error* ModelConfig_Validate(Trace*, ModelConfig*);
 Error* ModelConfig_FromFile(ModelConfig*, const char*);
@@ -4,16 +4,23 @@
 #define NBFC_VERSION                     VERSION
 #define NBFC_MAX_FILE_SIZE               32768
 #define NBFC_TEMPERATURE_FILTER_TIMESPAN 6000 /*ms*/
+#define NBFC_LOAD_SENSOR_TIMESPAN        3000 /*ms, EMA time constant*/
 #define NBFC_MODEL_CONFIGS_DIR           DATADIR "/nbfc/configs"
 #define NBFC_MODEL_SUPPORT_FILE          DATADIR "/nbfc/model_support.json"
+#ifndef NBFC_MUTABLE_DIR // Overridden by test builds
 #define NBFC_MUTABLE_DIR                 "/var/lib/nbfc"
+#endif
 #define NBFC_STATE_FILE                  NBFC_MUTABLE_DIR "/state.json"
 #define NBFC_MODEL_CONFIGS_DIR_MUTABLE   NBFC_MUTABLE_DIR "/configs"
 #define NBFC_MODEL_SUPPORT_FILE_MUTABLE  NBFC_MUTABLE_DIR "/model_support.json"
+#define NBFC_MODEL_SUPPORT_INDEX         NBFC_MUTABLE_DIR "/model_support.idx"
+#define NBFC_UPDATE_MANIFEST             NBFC_MUTABLE_DIR "/update_manifest"
+#define NBFC_UPDATE_LISTING              NBFC_MUTABLE_DIR "/update_listing.json"
 #define NBFC_CONFIG_DIR                  SYSCONFDIR "/nbfc"
 #define NBFC_SERVICE_CONFIG              SYSCONFDIR "/nbfc/nbfc.json"
 #define NBFC_PID_FILE                    RUNSTATEDIR "/nbfc_service.pid"
 #define NBFC_SOCKET_PATH                 RUNSTATEDIR "/nbfc_service.socket"
+#define NBFC_FLIGHT_RECORDER_FILE        RUNSTATEDIR "/nbfc_service.flight"
 
 #define NBFC_EXIT_SUCCESS 0
 #define NBFC_EXIT_FAILURE 1
@@ -0,0 +1,74 @@
+#include "power_policy.h"
+
+#include "file_utils.h"
+
+#include <dirent.h>  // opendir, readdir, closedir
+#include <stdio.h>   // snprintf
+#include <string.h>  // strcmp, strcspn
+#include <linux/limits.h> // PATH_MAX
+
+static const char PowerPolicy_PowerSupplyDir[] = "/sys/class/power_supply";
+static const char PowerPolicy_PlatformProfile[] = "/sys/firmware/acpi/platform_profile";
+
+static bool PowerPolicy_ReadLine(const char* file, char* buf, int size) {
+  const ssize_t nread = slurp_file(buf, size, file);
+  if (nread < 0)
+    return false;
+
+  buf[strcspn(buf, "\n")] = '\0';
+  return true;
+}
+
+// Returns true if a mains power supply exists and none of them is online
+static bool PowerPolicy_OnBattery() {
+  DIR* dir = opendir(PowerPolicy_PowerSupplyDir);
+  if (! dir)
+    return false;
+
+  bool mains_found = false, mains_online = false;
+  struct dirent* entry;
+
+  while ((entry = readdir(dir))) {
+    char file[PATH_MAX], buf[32];
+
+    if (entry->d_name[0] == '.')
+      continue;
+
+    snprintf(file, sizeof(file), "%s/%s/type", PowerPolicy_PowerSupplyDir, entry->d_name);
+    if (! PowerPolicy_ReadLine(file, buf, sizeof(buf)) || strcmp(buf, "Mains"))
+      continue;
+
+    mains_found = true;
+
+    snprintf(file, sizeof(file), "%s/%s/online", PowerPolicy_PowerSupplyDir, entry->d_name);
+    if (PowerPolicy_ReadLine(file, buf, sizeof(buf)) && !strcmp(buf, "1"))
+      mains_online = true;
+  }
+
+  closedir(dir);
+  return mains_found && !mains_online;
+}
+
+static bool PowerPolicy_LowPowerProfile() {
+  char buf[32];
+
+  if (! PowerPolicy_ReadLine(PowerPolicy_PlatformProfile, buf, sizeof(buf)))
+    return false;
+
+  return !strcmp(buf, "low-power") || !strcmp(buf, "quiet");
+}
+
+PowerPolicy PowerPolicy_Detect() {
+  if (PowerPolicy_OnBattery() || PowerPolicy_LowPowerProfile())
+    return PowerPolicy_PowerSave;
+
+  return PowerPolicy_Full;
+}
+
+const char* PowerPolicy_ToString(PowerPolicy policy) {
+  switch (policy) {
+    case PowerPolicy_Full:      return "full";
+    case PowerPolicy_PowerSave: return "powersave";
+  }
+  return "unknown";
+}
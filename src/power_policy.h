@@ -0,0 +1,17 @@
+#ifndef NBFC_POWER_POLICY_H_
+#define NBFC_POWER_POLICY_H_
+
+#include <stdbool.h>
+
+#define POWER_POLICY_CHECK_INTERVAL 10000 /*ms*/
+
+enum PowerPolicy {
+  PowerPolicy_Full,      // On AC: full responsiveness
+  PowerPolicy_PowerSave, // On battery or low-power platform profile
+};
+typedef enum PowerPolicy PowerPolicy;
+
+PowerPolicy PowerPolicy_Detect();
+const char* PowerPolicy_ToString(PowerPolicy);
+
+#endif
@@ -0,0 +1,99 @@
+#include "realtime.h"
+
+#include <errno.h>       // errno, EINVAL
+#include <pthread.h>     // pthread_setschedparam
+#include <sched.h>       // SCHED_FIFO, SCHED_RR
+#include <stdlib.h>      // strtol
+#include <string.h>      // memset, strcmp
+#include <unistd.h>      // syscall
+#include <sys/mman.h>    // mlockall
+#include <sys/syscall.h> // SYS_sched_setaffinity
+
+#define REALTIME_PREFAULT_STACK (256 * 1024)
+
+// Parse a list of CPUs like "0,2-3"
+Error* Realtime_ParseCPUSet(const char* s, Realtime_CPUSet* out) {
+  memset(out, 0, sizeof(*out));
+
+  while (*s) {
+    char* end;
+    long first = strtol(s, &end, 10), last;
+    if (end == s)
+      goto invalid;
+
+    if (*end == '-') {
+      s = end + 1;
+      last = strtol(s, &end, 10);
+      if (end == s)
+        goto invalid;
+    }
+    else
+      last = first;
+
+    if (first < 0 || last >= REALTIME_MAX_CPUS || first > last)
+      goto invalid;
+
+    for (long cpu = first; cpu <= last; ++cpu)
+      out->bits[cpu / 64] |= UINT64_C(1) << (cpu % 64);
+
+    if (*end == ',')
+      ++end;
+    else if (*end)
+      goto invalid;
+    s = end;
+  }
+
+  out->set = true;
+  return err_success();
+
+invalid:
+  errno = EINVAL;
+  return err_stdlib(0, "Invalid CPU list");
+}
+
+Error* Realtime_ParsePolicy(const char* s, int* policy) {
+  if (! strcmp(s, "fifo"))
+    *policy = SCHED_FIFO;
+  else if (! strcmp(s, "rr"))
+    *policy = SCHED_RR;
+  else
+    return err_string(0, "Invalid scheduling policy. Choose from 'fifo', 'rr'");
+  return err_success();
+}
+
+// Touch the stack, so its pages are present before they are locked
+static void Realtime_PrefaultStack() {
+  volatile char stack[REALTIME_PREFAULT_STACK];
+  for (size_t i = 0; i < sizeof(stack); i += 4096)
+    stack[i] = 0;
+}
+
+// Lock all current and future pages of the process into memory
+Error* Realtime_LockMemory() {
+  if (mlockall(MCL_CURRENT|MCL_FUTURE) < 0)
+    return err_stdlib(0, "mlockall()");
+
+  Realtime_PrefaultStack();
+  return err_success();
+}
+
+// Set the scheduling policy of the calling thread. Threads created afterwards inherit it.
+Error* Realtime_SetScheduler(int policy, int priority) {
+  struct sched_param param = { .sched_priority = priority };
+
+  const int ret = pthread_setschedparam(pthread_self(), policy, &param);
+  if (ret) {
+    errno = ret;
+    return err_stdlib(0, "pthread_setschedparam()");
+  }
+
+  return err_success();
+}
+
+// Set the CPU affinity of the calling thread
+Error* Realtime_SetAffinity(const Realtime_CPUSet* cpus) {
+  if (syscall(SYS_sched_setaffinity, 0, sizeof(cpus->bits), cpus->bits) < 0)
+    return err_stdlib(0, "sched_setaffinity()");
+
+  return err_success();
+}
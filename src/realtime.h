@@ -0,0 +1,23 @@
+#ifndef NBFC_REALTIME_H_
+#define NBFC_REALTIME_H_
+
+#include "error.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define REALTIME_MAX_CPUS 1024
+
+struct Realtime_CPUSet {
+  uint64_t bits[REALTIME_MAX_CPUS / 64];
+  bool     set;
+};
+typedef struct Realtime_CPUSet Realtime_CPUSet;
+
+Error* Realtime_ParseCPUSet(const char*, Realtime_CPUSet*);
+Error* Realtime_ParsePolicy(const char*, int*);
+Error* Realtime_LockMemory();
+Error* Realtime_SetScheduler(int policy, int priority);
+Error* Realtime_SetAffinity(const Realtime_CPUSet*);
+
+#endif
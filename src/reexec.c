@@ -0,0 +1,437 @@
+#include "reexec.h"
+
+#include "nbfc.h"
+#include "log.h"
+#include "memory.h"
+#include "stack_memory.h"
+#include "nxjson_utils.h"
+#include "reverse_nxjson.h"
+
+#include <dirent.h>      // opendir, readdir, closedir
+#include <errno.h>       // errno, EFBIG
+#include <fcntl.h>       // fcntl, FD_CLOEXEC
+#include <inttypes.h>    // PRIx64
+#include <math.h>        // isnan, NAN
+#include <stdio.h>       // snprintf
+#include <stdlib.h>      // strtol, strtoull
+#include <string.h>      // strcmp, strncmp
+#include <unistd.h>      // readlink, execv, syscall, pread, write
+#include <sys/stat.h>    // fstat, struct stat
+#include <sys/syscall.h> // SYS_memfd_create
+#include <linux/limits.h> // PATH_MAX
+
+#define REEXEC_OPTION         "--reexec-state"
+#define REEXEC_MAX_STATE_SIZE (NBFC_MAX_FILE_SIZE * 4)
+
+Reexec_State* Reexec_Inherited = NULL;
+
+static char Reexec_Executable[PATH_MAX];
+static bool Reexec_Pending = false; // Accessed atomically
+
+// The files on stdin, stdout and stderr at startup. After fork() closed them
+// (--fork) the numbers 0-2 are reused by other files.
+static struct {
+  bool  open;
+  dev_t dev;
+  ino_t ino;
+} Reexec_Stdio[STDERR_FILENO + 1];
+
+// Remember the path of our binary. If it gets replaced by an update, the
+// re-exec runs the new one.
+// Has to be called before the service opens any files.
+Error* Reexec_Init() {
+  for (range(int, fd, 0, ARRAY_SSIZE(Reexec_Stdio))) {
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      Reexec_Stdio[fd].open = true;
+      Reexec_Stdio[fd].dev  = st.st_dev;
+      Reexec_Stdio[fd].ino  = st.st_ino;
+    }
+  }
+
+  const ssize_t len = readlink("/proc/self/exe", Reexec_Executable, sizeof(Reexec_Executable) - 1);
+  if (len < 0)
+    return err_stdlib(0, "/proc/self/exe");
+
+  Reexec_Executable[len] = '\0';
+  return err_success();
+}
+
+// Async-signal-safe
+void Reexec_Request() {
+  __atomic_store_n(&Reexec_Pending, true, __ATOMIC_RELEASE);
+}
+
+bool Reexec_Requested() {
+  return __atomic_load_n(&Reexec_Pending, __ATOMIC_ACQUIRE);
+}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+// JSON has no NaN, unknown values are left out
+static void Reexec_AddFloat(const char* key, nx_json* parent, float value) {
+  if (! isnan(value))
+    create_json_double(key, parent, value);
+}
+
+static Error* Reexec_Serialize(const Reexec_State* state, StringBuf* s) {
+  char hash[17];
+  nx_json root = {0};
+  nx_json* o = create_json_object(NULL, &root);
+  create_json_string("ConfigId", o, state->config_id);
+  snprintf(hash, sizeof(hash), "%016" PRIx64, state->config_hash);
+  create_json_string("ConfigHash", o, hash);
+  create_json_string("EmbeddedControllerType", o, EmbeddedControllerType_ToString(state->ec_type));
+  create_json_integer("ECFD", o, state->ec_fd);
+  create_json_integer("ServerFD", o, state->server_fd);
+  nx_json* fans = create_json_array("Fans", o);
+
+  for_each_array(const Reexec_Fan*, f, state->fans) {
+    nx_json* fan = create_json_object(NULL, fans);
+    create_json_integer("Threshold", fan, f->threshold);
+    create_json_bool("Critical", fan, f->critical);
+    create_json_integer("LastWrittenValue", fan, f->last_written_value);
+    Reexec_AddFloat("LastWrittenSpeed", fan, f->last_written_speed);
+    Reexec_AddFloat("CurrentSpeed", fan, f->current_speed);
+    Reexec_AddFloat("Temperature", fan, f->temperature);
+    Reexec_AddFloat("AppliedTemperature", fan, f->applied_temperature);
+    Reexec_AddFloat("LoadBias", fan, f->load_bias);
+    if (f->pwm_path)
+      create_json_string("PwmPath", fan, f->pwm_path);
+    create_json_integer("PwmMode", fan, f->pwm_mode);
+
+    nx_json* temperatures = create_json_array("Temperatures", fan);
+    for_each_array(const float*, t, f->temperatures)
+      create_json_double(NULL, temperatures, *t);
+  }
+
+  nx_json_to_string(o, s, 0);
+  nx_json_free(o);
+
+  // StringBuf truncates silently
+  if (s->size >= s->capacity - 1)
+    return (errno = EFBIG), err_stdlib(0, "Re-exec state");
+
+  return err_success();
+}
+
+static Error* Reexec_GetInteger(const nx_json* o, const char* key, long* out) {
+  const nx_json* v = nx_json_get(o, key);
+  if (! v)
+    return err_stringf(0, "Missing field: %s", key);
+  if (v->type != NX_JSON_INTEGER)
+    return err_stringf(0, "%s: Not an integer", key);
+  *out = v->val.i;
+  return err_success();
+}
+
+static float Reexec_GetFloat(const nx_json* o, const char* key) {
+  const nx_json* v = nx_json_get(o, key);
+  if (v && v->type == NX_JSON_DOUBLE)
+    return v->val.dbl;
+  if (v && v->type == NX_JSON_INTEGER)
+    return v->val.i;
+  return NAN;
+}
+
+static Error* Reexec_FanFromJson(Reexec_Fan* f, const nx_json* o) {
+  Error* e;
+  long value;
+
+  e = nx_json_get_object(o);
+  e_check();
+
+  e = Reexec_GetInteger(o, "Threshold", &value);
+  e_check();
+  f->threshold = value;
+
+  e = Reexec_GetInteger(o, "LastWrittenValue", &value);
+  e_check();
+  f->last_written_value = value;
+
+  e = Reexec_GetInteger(o, "PwmMode", &value);
+  e_check();
+  f->pwm_mode = value;
+
+  const nx_json* pwm_path = nx_json_get(o, "PwmPath");
+  if (pwm_path) {
+    const char* path;
+    e = nx_json_get_str(&path, pwm_path);
+    if (e)
+      return err_string(e, "PwmPath");
+    f->pwm_path = Mem_Strdup(path);
+  }
+
+  const nx_json* critical = nx_json_get(o, "Critical");
+  f->critical = (critical && critical->type == NX_JSON_BOOL && critical->val.i);
+
+  f->last_written_speed  = Reexec_GetFloat(o, "LastWrittenSpeed");
+  f->current_speed       = Reexec_GetFloat(o, "CurrentSpeed");
+  f->temperature         = Reexec_GetFloat(o, "Temperature");
+  f->applied_temperature = Reexec_GetFloat(o, "AppliedTemperature");
+  f->load_bias           = Reexec_GetFloat(o, "LoadBias");
+
+  const nx_json* temperatures = nx_json_get(o, "Temperatures");
+  if (! temperatures)
+    return err_string(0, "Missing field: Temperatures");
+
+  e = nx_json_get_array(temperatures);
+  if (e)
+    return err_string(e, "Temperatures");
+
+  f->temperatures.size = temperatures->val.children.length;
+  f->temperatures.data = Mem_Calloc(f->temperatures.size ? f->temperatures.size : 1, sizeof(float));
+
+  float* t = f->temperatures.data;
+  nx_json_for_each(c, temperatures) {
+    if (c->type == NX_JSON_DOUBLE)
+      *t = c->val.dbl;
+    else if (c->type == NX_JSON_INTEGER)
+      *t = c->val.i;
+    else
+      return err_string(0, "Temperatures: Not a number");
+    ++t;
+  }
+
+  return err_success();
+}
+
+static Error* Reexec_FromJson(Reexec_State* state, const nx_json* o) {
+  Error* e;
+  long value;
+  const char* s;
+
+  e = nx_json_get_object(o);
+  e_check();
+
+  const nx_json* config_id = nx_json_get(o, "ConfigId");
+  if (! config_id)
+    return err_string(0, "Missing field: ConfigId");
+  e = nx_json_get_str(&s, config_id);
+  if (e)
+    return err_string(e, "ConfigId");
+  state->config_id = Mem_Strdup(s);
+
+  // Written as a string, a JSON number can't hold 64 bits.
+  // Missing in the state of an older binary, which counts as changed.
+  const nx_json* config_hash = nx_json_get(o, "ConfigHash");
+  if (config_hash) {
+    e = nx_json_get_str(&s, config_hash);
+    if (e)
+      return err_string(e, "ConfigHash");
+    state->config_hash = strtoull(s, NULL, 16);
+  }
+
+  const nx_json* ec_type = nx_json_get(o, "EmbeddedControllerType");
+  if (! ec_type)
+    return err_string(0, "Missing field: EmbeddedControllerType");
+  e = nx_json_get_str(&s, ec_type);
+  if (e)
+    return err_string(e, "EmbeddedControllerType");
+  state->ec_type = EmbeddedControllerType_FromString(s);
+  if (state->ec_type == EmbeddedControllerType_Unset)
+    return err_stringf(0, "EmbeddedControllerType: Invalid value: %s", s);
+
+  e = Reexec_GetInteger(o, "ECFD", &value);
+  e_check();
+  state->ec_fd = value;
+
+  e = Reexec_GetInteger(o, "ServerFD", &value);
+  e_check();
+  state->server_fd = value;
+
+  const nx_json* fans = nx_json_get(o, "Fans");
+  if (! fans)
+    return err_string(0, "Missing field: Fans");
+  e = nx_json_get_array(fans);
+  if (e)
+    return err_string(e, "Fans");
+
+  state->fans.size = fans->val.children.length;
+  state->fans.data = Mem_Calloc(state->fans.size ? state->fans.size : 1, sizeof(Reexec_Fan));
+
+  int i = 0;
+  nx_json_for_each(fan, fans) {
+    e = Reexec_FanFromJson(&state->fans.data[i], fan);
+    if (e)
+      return err_stringf(e, "Fans[%d]", i);
+    ++i;
+  }
+
+  return err_success();
+}
+
+// ============================================================================
+// Re-exec
+// ============================================================================
+
+// Whether `fd` still refers to the stdin, stdout or stderr we started with
+static bool Reexec_IsStdio(int fd) {
+  struct stat st;
+
+  if (fd >= ARRAY_SSIZE(Reexec_Stdio) || ! Reexec_Stdio[fd].open || fstat(fd, &st) < 0)
+    return false;
+
+  return st.st_dev == Reexec_Stdio[fd].dev && st.st_ino == Reexec_Stdio[fd].ino;
+}
+
+// Only the file descriptors that are handed over (and the original stdio)
+// survive the exec
+static void Reexec_SetCloseOnExec(const int* keep, int n) {
+  DIR* dir = opendir("/proc/self/fd");
+  if (! dir) {
+    Log_Warn("%s: %s\n", "/proc/self/fd", strerror(errno));
+    return;
+  }
+
+  const int dir_fd = dirfd(dir);
+  struct dirent* entry;
+  while ((entry = readdir(dir))) {
+    if (entry->d_name[0] == '.')
+      continue;
+
+    const int fd = strtol(entry->d_name, NULL, 10);
+    if (fd == dir_fd || Reexec_IsStdio(fd))
+      continue;
+
+    bool kept = false;
+    for (range(int, i, 0, n))
+      if (keep[i] == fd)
+        kept = true;
+
+    if (! kept)
+      fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+  }
+
+  closedir(dir);
+}
+
+// Only returns on failure
+Error* Reexec_Exec(const Reexec_State* state, char* const argv[]) {
+  Error* e = NULL;
+  int memfd = -1;
+  char fd_arg[16];
+  int argc = 0;
+  char** new_argv = NULL;
+  StringBuf s = { Mem_Malloc(REEXEC_MAX_STATE_SIZE), 0, REEXEC_MAX_STATE_SIZE };
+  s.s[0] = '\0';
+
+  __atomic_store_n(&Reexec_Pending, false, __ATOMIC_RELEASE);
+
+  e = Reexec_Serialize(state, &s);
+  if (e)
+    goto error;
+
+  // Not close-on-exec, the new binary reads it
+  memfd = syscall(SYS_memfd_create, "nbfc_service_state", 0);
+  if (memfd < 0) {
+    e = err_stdlib(0, "memfd_create()");
+    goto error;
+  }
+
+  if (write(memfd, s.s, s.size) != s.size) {
+    e = err_stdlib(0, "write()");
+    goto error;
+  }
+
+  // Replace a previous --reexec-state FD by the new one
+  while (argv[argc])
+    ++argc;
+
+  new_argv = Mem_Calloc(argc + 3, sizeof(char*));
+  int n = 0;
+  for (range(int, i, 0, argc)) {
+    if (! strcmp(argv[i], REEXEC_OPTION)) {
+      ++i;
+      continue;
+    }
+    if (! strncmp(argv[i], REEXEC_OPTION "=", sizeof(REEXEC_OPTION)))
+      continue;
+    new_argv[n++] = argv[i];
+  }
+
+  snprintf(fd_arg, sizeof(fd_arg), "%d", memfd);
+  new_argv[n++] = REEXEC_OPTION;
+  new_argv[n++] = fd_arg;
+
+  const int keep[] = { state->ec_fd, state->server_fd, memfd };
+  Reexec_SetCloseOnExec(keep, ARRAY_SSIZE(keep));
+
+  Log_Info("Re-executing %s\n", Reexec_Executable);
+  execv(Reexec_Executable, new_argv);
+  e = err_stdlib(0, Reexec_Executable);
+
+error:
+  if (memfd >= 0)
+    close(memfd);
+  Mem_Free(new_argv);
+  Mem_Free(s.s);
+  return err_string(e, "Re-exec failed");
+}
+
+// Load the state handed over by Reexec_Exec() into `Reexec_Inherited`
+Error* Reexec_Load(int fd) {
+  Error* e = NULL;
+  char* buf = NULL;
+  char nxjson_memory[NBFC_MAX_FILE_SIZE];
+  const nx_json* js = NULL;
+  struct stat st;
+
+  if (fstat(fd, &st) < 0) {
+    e = err_stdlib(0, "fstat()");
+    goto end;
+  }
+
+  if (st.st_size > REEXEC_MAX_STATE_SIZE) {
+    errno = EFBIG;
+    e = err_stdlib(0, NULL);
+    goto end;
+  }
+
+  buf = Mem_Malloc(st.st_size + 1);
+  if (pread(fd, buf, st.st_size, 0) != st.st_size) {
+    e = err_stdlib(0, "pread()");
+    goto end;
+  }
+  buf[st.st_size] = '\0';
+
+  StackMemory_Init(nxjson_memory, sizeof(nxjson_memory));
+
+  js = nx_json_parse_utf8(buf);
+  if (! js) {
+    e = err_nxjson(0, NULL);
+    goto end;
+  }
+
+  Reexec_Inherited = Mem_Calloc(1, sizeof(Reexec_State));
+  e = Reexec_FromJson(Reexec_Inherited, js);
+
+end:
+  nx_json_free(js);
+  StackMemory_Destroy();
+  Mem_Free(buf);
+  close(fd);
+
+  if (e) {
+    if (Reexec_Inherited) {
+      Reexec_Free(Reexec_Inherited);
+      Mem_Free(Reexec_Inherited);
+      Reexec_Inherited = NULL;
+    }
+    return err_string(e, "Re-exec state");
+  }
+
+  return err_success();
+}
+
+void Reexec_Free(Reexec_State* state) {
+  for_each_array(Reexec_Fan*, f, state->fans) {
+    Mem_Free(f->temperatures.data);
+    Mem_Free(f->pwm_path);
+  }
+  Mem_Free(state->fans.data);
+  Mem_Free(state->config_id);
+  memset(state, 0, sizeof(*state));
+}
@@ -0,0 +1,57 @@
+#ifndef NBFC_REEXEC_H_
+#define NBFC_REEXEC_H_
+
+#include "error.h"
+#include "macros.h"
+#include "model_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Live re-exec of the service.
+ *
+ * The running service executes its binary again in the same process. The
+ * listening socket and the file descriptor of the embedded controller stay
+ * open, the in-memory state of the fans is passed to the new binary in a
+ * memfd. No ResetEC() happens in between.
+ */
+
+typedef struct Reexec_Fan Reexec_Fan;
+struct Reexec_Fan {
+  ssize_t         threshold;           // ThresholdManager.current
+  bool            critical;
+  int32_t         last_written_value;  // -1 if unknown
+  float           last_written_speed;
+  float           current_speed;
+  float           temperature;         // Filtered temperature
+  float           applied_temperature; // NAN if unknown
+  float           load_bias;
+  char*           pwm_path;            // pwmN written by the fan, NULL if none
+  long            pwm_mode;            // Original pwmN_enable, -1 if not in manual mode
+  array_of(float) temperatures;        // Content of the temperature filter, oldest first
+};
+declare_array_of(Reexec_Fan);
+
+typedef struct Reexec_State Reexec_State;
+struct Reexec_State {
+  char*                  config_id;
+  uint64_t               config_hash;  // Of the model config file, 0 if unknown
+  EmbeddedControllerType ec_type;
+  int                    ec_fd;        // -1 if the EC doesn't use a file descriptor
+  int                    server_fd;
+  array_of(Reexec_Fan)   fans;
+};
+
+// The state handed over by the previous binary, NULL if not re-executed
+extern Reexec_State* Reexec_Inherited;
+
+Error* Reexec_Init();
+void   Reexec_Request();
+bool   Reexec_Requested();
+Error* Reexec_Exec(const Reexec_State*, char* const argv[]);
+Error* Reexec_Load(int fd);
+void   Reexec_Free(Reexec_State*);
+
+#endif
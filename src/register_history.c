@@ -0,0 +1,213 @@
+#include "register_history.h"
+
+#include "macros.h"
+#include "memory.h"
+
+#include <stdio.h>    // snprintf
+#include <stdlib.h>   // getenv, mkstemp
+#include <string.h>   // memcpy, memset
+#include <unistd.h>   // ftruncate, close, unlink
+#include <sys/mman.h> // mmap, munmap
+
+#ifdef __SSE2__
+#include <emmintrin.h> // _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8
+#endif
+
+// A sample is encoded as a count byte followed by `count` (register, value) pairs.
+// If 255 or more registers changed, the count byte is 255 and all registers follow.
+#define RegisterHistory_FullSample 255
+
+void RegisterHistory_Init(RegisterHistory* self) {
+  my.size = 0;
+  my.data = NULL;
+  my.data_size = 0;
+  my.data_capacity = 0;
+  my.spill_fd = -1;
+  my.spill_failed = false;
+  memset(my.changed, 0, sizeof(my.changed));
+  memset(my.last_delta, 0, sizeof(my.last_delta));
+  memset(my.last_change, 0, sizeof(my.last_change));
+}
+
+void RegisterHistory_Close(RegisterHistory* self) {
+  if (my.spill_fd >= 0) {
+    munmap(my.data, my.data_capacity);
+    close(my.spill_fd);
+  }
+  else
+    Mem_Free(my.data);
+
+  RegisterHistory_Init(self);
+}
+
+static Error* RegisterHistory_Spill(RegisterHistory* self, size_t capacity) {
+  if (my.spill_fd < 0) {
+    char file[1024];
+    const char* tmpdir = getenv("TMPDIR");
+    snprintf(file, sizeof(file), "%s/ec_probe-XXXXXX", tmpdir ? tmpdir : "/tmp");
+
+    const int fd = mkstemp(file);
+    if (fd < 0)
+      return err_stdlib(0, file);
+    unlink(file);
+
+    if (ftruncate(fd, capacity) < 0) {
+      close(fd);
+      return err_stdlib(0, "ftruncate()");
+    }
+
+    uint8_t* data = mmap(NULL, capacity, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return err_stdlib(0, "mmap()");
+    }
+
+    memcpy(data, my.data, my.data_size);
+    Mem_Free(my.data);
+    my.data = data;
+    my.spill_fd = fd;
+  }
+  else {
+    if (ftruncate(my.spill_fd, capacity) < 0)
+      return err_stdlib(0, "ftruncate()");
+
+    uint8_t* data = mmap(NULL, capacity, PROT_READ|PROT_WRITE, MAP_SHARED, my.spill_fd, 0);
+    if (data == MAP_FAILED)
+      return err_stdlib(0, "mmap()");
+
+    munmap(my.data, my.data_capacity);
+    my.data = data;
+  }
+
+  my.data_capacity = capacity;
+  return err_success();
+}
+
+static Error* RegisterHistory_Reserve(RegisterHistory* self, size_t size) {
+  if (my.data_size + size <= my.data_capacity)
+    return err_success();
+
+  size_t capacity = max(my.data_capacity * 2, 4096);
+  while (capacity < my.data_size + size)
+    capacity *= 2;
+
+  if (capacity > RegisterHistory_SpillSize && !my.spill_failed) {
+    Error* e = RegisterHistory_Spill(self, capacity);
+    if (! e || my.spill_fd >= 0)
+      return e;
+
+    // Keep the history in memory if no temporary file can be created
+    Log_Warn("Could not create temporary file for register history: %s\n", err_print_all(e));
+    my.spill_failed = true;
+  }
+
+  my.data = Mem_Realloc(my.data, capacity);
+  my.data_capacity = capacity;
+  return err_success();
+}
+
+// Set a bit in `mask` for every register that differs between `a` and `b`.
+// Returns the number of differing registers.
+int RegisterBuf_Diff(const RegisterBuf* a, const RegisterBuf* b, RegisterMask mask) {
+  int count = 0;
+
+  for (int word = 0; word < RegisterMask_Words; ++word) {
+    uint64_t bits = 0;
+
+#ifdef __SSE2__
+    for (int i = 0; i < 4; ++i) {
+      const __m128i x = _mm_loadu_si128((const __m128i*) (*a + word * 64 + i * 16));
+      const __m128i y = _mm_loadu_si128((const __m128i*) (*b + word * 64 + i * 16));
+      const uint16_t equal = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+      bits |= (uint64_t) (uint16_t) ~equal << (i * 16);
+    }
+#else
+    for (int i = 0; i < 64; ++i)
+      bits |= (uint64_t) ((*a)[word * 64 + i] != (*b)[word * 64 + i]) << i;
+#endif
+
+    mask[word] = bits;
+    count += __builtin_popcountll(bits);
+  }
+
+  return count;
+}
+
+Error* RegisterHistory_Add(RegisterHistory* self, const RegisterBuf* regs) {
+  static const RegisterBuf zero = {0};
+  const RegisterBuf* previous = my.size ? RegisterHistory_Recent(self, 0) : &zero;
+
+  RegisterMask delta;
+  const int n_changed = RegisterBuf_Diff(regs, previous, delta);
+
+  Error* e;
+  if (n_changed >= RegisterHistory_FullSample) {
+    e = RegisterHistory_Reserve(self, 1 + RegistersSize);
+    e_check();
+    my.data[my.data_size++] = RegisterHistory_FullSample;
+    memcpy(my.data + my.data_size, regs, RegistersSize);
+    my.data_size += RegistersSize;
+  }
+  else {
+    e = RegisterHistory_Reserve(self, 1 + 2 * n_changed);
+    e_check();
+    my.data[my.data_size++] = n_changed;
+    for_each_register_in_mask(register_, delta) {
+      my.data[my.data_size++] = register_;
+      my.data[my.data_size++] = (*regs)[register_];
+    }
+  }
+
+  // The first sample is compared against zero, it does not count as a change
+  if (my.size) {
+    for (int word = 0; word < RegisterMask_Words; ++word) {
+      my.changed[word] |= delta[word];
+      my.last_delta[word] = delta[word];
+    }
+
+    for_each_register_in_mask(register_, delta)
+      my.last_change[register_] = my.size;
+  }
+
+  memcpy(my.recent[my.size % RegisterHistory_RecentSize], regs, RegistersSize);
+  my.size++;
+  return err_success();
+}
+
+// Return the sample `n` positions before the last one.
+// `n` must be less than `min(size, RegisterHistory_RecentSize)`.
+const RegisterBuf* RegisterHistory_Recent(const RegisterHistory* self, int n) {
+  return &my.recent[(my.size - 1 - n) % RegisterHistory_RecentSize];
+}
+
+void RegisterHistory_IterInit(RegisterHistory_Iter* self, const RegisterHistory* history) {
+  my.history = history;
+  my.pos = 0;
+  my.index = -1;
+  memset(my.regs, 0, RegistersSize);
+}
+
+// Advance to the next sample. Returns false if there are no more samples.
+bool RegisterHistory_IterNext(RegisterHistory_Iter* self) {
+  const uint8_t* data = my.history->data;
+
+  if (my.index + 1 >= my.history->size)
+    return false;
+
+  const int n = data[my.pos++];
+  if (n == RegisterHistory_FullSample) {
+    RegisterBuf_Diff((const RegisterBuf*) (data + my.pos), &my.regs, my.delta);
+    memcpy(my.regs, data + my.pos, RegistersSize);
+    my.pos += RegistersSize;
+  }
+  else {
+    memset(my.delta, 0, sizeof(my.delta));
+    for (int i = 0; i < n; ++i, my.pos += 2) {
+      my.regs[data[my.pos]] = data[my.pos + 1];
+      my.delta[data[my.pos] / 64] |= 1ULL << (data[my.pos] % 64);
+    }
+  }
+
+  my.index++;
+  return true;
+}
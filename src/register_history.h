@@ -0,0 +1,85 @@
+#ifndef REGISTER_HISTORY_H_
+#define REGISTER_HISTORY_H_
+
+#include "error.h"
+
+#include <stdbool.h> // bool
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint8_t
+
+#define RegistersSize 256
+typedef uint8_t RegisterBuf[RegistersSize];
+
+// One bit per register
+#define RegisterMask_Words (RegistersSize / 64)
+typedef uint64_t RegisterMask[RegisterMask_Words];
+
+#define RegisterMask_Test(MASK, REGISTER) \
+  (((MASK)[(REGISTER) / 64] >> ((REGISTER) % 64)) & 1)
+
+// Return the first register set in `mask` that is not below `register_`, or `RegistersSize`
+static inline int RegisterMask_Next(const uint64_t* mask, int register_) {
+  for (int word = register_ / 64; word < RegisterMask_Words; ++word) {
+    uint64_t bits = mask[word];
+    if (word == register_ / 64)
+      bits &= ~0ULL << (register_ % 64);
+    if (bits)
+      return word * 64 + __builtin_ctzll(bits);
+  }
+
+  return RegistersSize;
+}
+
+#define for_each_register_in_mask(VAR, MASK) \
+  for (int VAR = RegisterMask_Next(MASK, 0); VAR < RegistersSize; VAR = RegisterMask_Next(MASK, VAR + 1))
+
+// Number of most recent samples that are kept uncompressed
+#define RegisterHistory_RecentSize 32
+
+// Delta stream size at which the history is moved into a memory mapped file
+#define RegisterHistory_SpillSize  (1024 * 1024)
+
+/*
+ * Growable history of register readings.
+ *
+ * Every sample is stored as the list of registers that changed since the
+ * previous sample, so a session costs roughly `samples + 2 * changes` bytes.
+ * Once the delta stream grows beyond `RegisterHistory_SpillSize` it is moved
+ * into an unlinked temporary file which is mapped into memory.
+ *
+ * Which registers changed (and when they last changed) is tracked as samples
+ * arrive, so rendering does not have to look at older samples.
+ */
+struct RegisterHistory {
+  int         size;                                 // Number of samples
+  RegisterBuf recent[RegisterHistory_RecentSize];   // Ring buffer of the last samples
+  uint8_t*    data;                                 // Delta stream
+  size_t      data_size;
+  size_t      data_capacity;
+  int         spill_fd;                             // -1 if the stream is held in memory
+  bool        spill_failed;
+  RegisterMask changed;                             // Registers that changed at least once
+  RegisterMask last_delta;                          // Registers that changed with the last sample
+  int         last_change[RegistersSize];           // Index of the sample of the last change
+};
+typedef struct RegisterHistory RegisterHistory;
+
+struct RegisterHistory_Iter {
+  const RegisterHistory* history;
+  size_t                 pos;
+  int                    index;                     // Index of the sample in `regs`
+  RegisterBuf            regs;
+  RegisterMask           delta;                     // Registers that changed with this sample
+};
+typedef struct RegisterHistory_Iter RegisterHistory_Iter;
+
+int                RegisterBuf_Diff(const RegisterBuf*, const RegisterBuf*, RegisterMask);
+void               RegisterHistory_Init(RegisterHistory*);
+void               RegisterHistory_Close(RegisterHistory*);
+Error*             RegisterHistory_Add(RegisterHistory*, const RegisterBuf*);
+const RegisterBuf* RegisterHistory_Recent(const RegisterHistory*, int);
+
+void               RegisterHistory_IterInit(RegisterHistory_Iter*, const RegisterHistory*);
+bool               RegisterHistory_IterNext(RegisterHistory_Iter*);
+
+#endif
@@ -22,6 +22,7 @@
 #include <sys/un.h>     // sockaddr_un
 #include <fcntl.h>      // fcntl
 #include <poll.h>       // poll, POLLIN
+#include <pthread.h>    // pthread_create, pthread_join
 
 #define SERVER_MAX_MESSAGE_SIZE 256 // Max size for incoming messages
 
@@ -39,6 +40,11 @@ static struct sockaddr_un Server_Address;
 static array_of(Client)   Server_Clients = {0};
 static struct pollfd*     Server_PollFDs = NULL;
 static size_t             Server_PollFDSize = 0;
+static pthread_t          Server_Thread;
+static bool               Server_ThreadRunning = false;
+static bool               Server_ThreadStop = false; // Accessed atomically
+static int                Server_WakePipe[2] = {-1, -1}; // Wakes up the server thread
+static int                Server_WakeFD = -1;       // Makes Server_Loop() return when readable
 
 /* Command "set-fan-speed"
  *
@@ -135,6 +141,8 @@ static Error* Server_Command_Status(int socket, const nx_json* json) {
   create_json_integer("PID", o, getpid());
   create_json_string("SelectedConfigId", o, service_config.SelectedConfigId);
   create_json_bool("ReadOnly", o, options.read_only);
+  create_json_string("PowerPolicy", o, Service_GetPowerPolicy());
+  create_json_double("WakeupsPerMinute", o, Service_GetWakeupsPerMinute());
   nx_json* fans = create_json_array("Fans", o);
 
   for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
@@ -155,6 +163,12 @@ static Error* Server_Command_Status(int socket, const nx_json* json) {
   return e;
 }
 
+static void Server_InitAddress() {
+  memset(&Server_Address, 0, sizeof(Server_Address));
+  Server_Address.sun_family = AF_UNIX;
+  snprintf(Server_Address.sun_path, sizeof(Server_Address.sun_path), NBFC_SOCKET_PATH);
+}
+
 /* Initialize server.
  *
  * Call socket(), bind() and listen().
@@ -164,9 +178,7 @@ static Error* Server_Command_Status(int socket, const nx_json* json) {
 Error* Server_Init() {
   Error* e = NULL;
 
-  memset(&Server_Address, 0, sizeof(Server_Address));
-  Server_Address.sun_family = AF_UNIX;
-  snprintf(Server_Address.sun_path, sizeof(Server_Address.sun_path), NBFC_SOCKET_PATH);
+  Server_InitAddress();
 
   if ((Server_FD = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
     e = err_stdlib(0, "socket()");
@@ -195,6 +207,26 @@ error:
   return e;
 }
 
+// Use a socket that is already listening, e.g. one inherited by a re-exec
+Error* Server_Adopt(int fd) {
+  int listening = 0;
+  socklen_t len = sizeof(listening);
+
+  if (getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &listening, &len) < 0)
+    return err_stdlib(0, "getsockopt()");
+
+  if (! listening)
+    return err_string(0, "Inherited socket is not listening");
+
+  Server_InitAddress();
+  Server_FD = fd;
+  return err_success();
+}
+
+int Server_GetFD() {
+  return Server_FD;
+}
+
 // Return a new `Client` structure
 static Client* Server_AllocateClient() {
   // Try to use an existing client that is inactive
@@ -389,7 +421,7 @@ end:
 // Hadle incoming connections and process clients
 Error* Server_Loop(int timeout) {
   const size_t num_clients = Server_GetNumberOfActiveClients();
-  const size_t needed_fdsize = num_clients + 1;
+  const size_t needed_fdsize = num_clients + 2;
 
   Log_Debug("Server_Loop(timeout=%d): num clients: %d\n", timeout, num_clients);
 
@@ -403,8 +435,12 @@ Error* Server_Loop(int timeout) {
   Server_PollFDs[0].fd = Server_FD;
   Server_PollFDs[0].events = POLLIN;
 
+  // Add the wake file descriptor (ignored by poll() if -1)
+  Server_PollFDs[1].fd = Server_WakeFD;
+  Server_PollFDs[1].events = POLLIN;
+
   // Add clients to Server_PollFDs
-  size_t idx = 1;
+  size_t idx = 2;
   for_each_array(Client*, client, Server_Clients) {
     if (client->active) {
       Server_PollFDs[idx].fd = client->fd;
@@ -422,6 +458,10 @@ Error* Server_Loop(int timeout) {
       return err_success();
   }
 
+  // Wakeups by the wake file descriptor are counted by their handler
+  if (poll_count > !!(Server_PollFDs[1].revents & POLLIN))
+    Service_CountWakeup();
+
   // We have an incoming connection ...
   if (Server_PollFDs[0].revents & POLLIN) {
     Error* e = Server_AcceptClient();
@@ -430,13 +470,15 @@ Error* Server_Loop(int timeout) {
   }
 
   // Check for activity on client file descriptors ...
-  for (idx = 1; idx < needed_fdsize; ++idx) {
+  for (idx = 2; idx < needed_fdsize; ++idx) {
     if (Server_PollFDs[idx].revents & POLLIN) {
       Client* client = Server_FindClientByFileDescriptor(Server_PollFDs[idx].fd);
       if (client == NULL)
         Log_Warn("No client with fd=%d found\n", Server_PollFDs[idx].fd);
       else {
+        Service_Lock();
         Server_HandleClient(client);
+        Service_Unlock();
       }
     }
   }
@@ -444,7 +486,80 @@ Error* Server_Loop(int timeout) {
   return err_success();
 }
 
+// The thread blocks in poll() until a client connects or Server_StopThread()
+// writes to the wake pipe, so it doesn't cause periodic wakeups.
+static void* Server_ThreadMain(void* arg) {
+  (void) arg;
+
+  while (! __atomic_load_n(&Server_ThreadStop, __ATOMIC_ACQUIRE)) {
+    Error* e = Server_Loop(-1);
+    e_warn();
+  }
+
+  return NULL;
+}
+
+// Server_Loop() returns as soon as `fd` becomes readable. It is not read.
+void Server_SetWakeFD(int fd) {
+  Server_WakeFD = fd;
+}
+
+static void Server_CloseWakePipe() {
+  Server_SetWakeFD(-1);
+
+  for (int i = 0; i < 2; ++i) {
+    if (Server_WakePipe[i] != -1) {
+      close(Server_WakePipe[i]);
+      Server_WakePipe[i] = -1;
+    }
+  }
+}
+
+// Run the server in its own thread with normal priority.
+// Used when the control loop runs with a realtime priority.
+Error* Server_StartThread() {
+  pthread_attr_t attr;
+  struct sched_param param = { .sched_priority = 0 };
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_OTHER);
+  pthread_attr_setschedparam(&attr, &param);
+
+  if (pipe(Server_WakePipe) < 0) {
+    pthread_attr_destroy(&attr);
+    return err_stdlib(0, "pipe()");
+  }
+  Server_SetWakeFD(Server_WakePipe[0]);
+
+  Server_ThreadStop = false;
+  const int ret = pthread_create(&Server_Thread, &attr, Server_ThreadMain, NULL);
+  pthread_attr_destroy(&attr);
+
+  if (ret) {
+    Server_CloseWakePipe();
+    errno = ret;
+    return err_stdlib(0, "pthread_create()");
+  }
+
+  Server_ThreadRunning = true;
+  return err_success();
+}
+
+void Server_StopThread() {
+  if (! Server_ThreadRunning)
+    return;
+
+  __atomic_store_n(&Server_ThreadStop, true, __ATOMIC_RELEASE);
+  if (write(Server_WakePipe[1], "", 1) < 0)
+    Log_Warn("Server: write(): %s\n", strerror(errno));
+  pthread_join(Server_Thread, NULL);
+  Server_ThreadRunning = false;
+  Server_CloseWakePipe();
+}
+
 void Server_Close() {
+  Server_StopThread();
+
   if (Server_FD != -1) {
     close(Server_FD);
     unlink(NBFC_SOCKET_PATH);
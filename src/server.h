@@ -4,7 +4,12 @@
 #include "error.h"
 
 Error* Server_Init();
+Error* Server_Adopt(int);
+int    Server_GetFD();
 Error* Server_Loop(int);
+void   Server_SetWakeFD(int);
+Error* Server_StartThread();
+void   Server_StopThread();
 void   Server_Close();
 
 #endif
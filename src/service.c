@@ -4,6 +4,7 @@
 #include "ec_linux.h"
 #include "ec_sys_linux.h"
 #include "ec_debug.h"
+#include "ec_locked.h"
 #include "ec_dummy.h"
 #include "acpi_call.h"
 #include "fan.h"
@@ -16,9 +17,19 @@
 #include "memory.h"
 #include "macros.h"
 #include "model_config.h"
-
+#include "flight_recorder.h"
+#include "critical_watchdog.h"
+#include "power_policy.h"
+#include "load_sensor.h"
+#include "reexec.h"
+#include "file_utils.h"
+
+#include <fcntl.h>  // O_RDWR
 #include <stdio.h>  // snprintf
-#include <math.h>   // fabs
+#include <math.h>   // fabs, NAN
+#include <pthread.h> // pthread_mutex_t
+#include <string.h> // memset
+#include <time.h>   // clock_gettime
 #include <linux/limits.h> // PATH_MAX
 
 Service_Options options;
@@ -38,12 +49,54 @@ enum Service_Initialization {
 ModelConfig              Service_Model_Config;
 array_of(FanTemperatureControl) Service_Fans;
 static enum Service_Initialization Service_State;
-
-static Error* ApplyRegisterWriteConfigurations(bool);
+static FlightRecorder         Service_FlightRecorder;
+static LoadSensor             Service_LoadSensors[LoadSource_Unset]; // Indexed by LoadSource
+static FlightRecorder_Record* Service_FlightRecord;
+static EmbeddedControllerType Service_ECType;
+static uint64_t               Service_ModelConfigHash; // Of the model config file, 0 if unknown
+static uint32_t               Service_TickLateness;
+static pthread_mutex_t        Service_Mutex;
+static pthread_once_t         Service_MutexOnce = PTHREAD_ONCE_INIT;
+
+// The phases of Service_Loop() run at their own rates. This holds when each
+// phase is due next (monotonic clock, microseconds).
+static struct {
+  uint64_t read_speeds;
+  uint64_t register_writes;
+  uint64_t temperatures;
+  uint64_t write_speeds;
+  uint64_t power_policy;
+} Service_Schedule;
+static int Service_TickInterval; // Milliseconds, the shortest of the phase intervals
+
+#define SERVICE_SUSPEND_THRESHOLD 1000000 /*us*/
+
+// On battery the intervals are stretched by PowerSaveIntervalFactor
+static PowerPolicy Service_PowerPolicy;
+static float       Service_IntervalFactor;
+
+// CLOCK_BOOTTIME minus CLOCK_MONOTONIC (microseconds). It grows while the system is suspended.
+static int64_t Service_SuspendedTime;
+
+static struct {
+  uint64_t count;                // Accessed atomically
+  uint64_t window_start;
+  uint64_t window_count;
+  float    per_minute;
+  bool     have_rate;
+} Service_Wakeups;
+
+static Error* ApplyRegisterWriteConfigurations(bool, int*);
 static Error* ApplyRegisterWriteConfig(RegisterWriteConfiguration*);
 static Error* ResetRegisterWriteConfigurations();
 static Error* ResetRegisterWriteConfig(RegisterWriteConfiguration*);
 static void   ResetEC();
+static void   OpenLoadSensors();
+static void   UpdateLoadSensors();
+static void   RestoreReexecState(const Reexec_State*);
+static bool   ModelConfigUnchanged(const Reexec_State*);
+static uint64_t HashFile(const char*);
+static int64_t Service_GetSuspendedTime();
 static bool   IsAcpiCallUsed();
 static EmbeddedControllerType EmbeddedControllerType_By_EC(EC_VTable*);
 static EC_VTable* EC_By_EmbeddedControllerType(EmbeddedControllerType);
@@ -85,6 +138,7 @@ Error* Service_Init() {
   }
 
   Service_State = Initialized_2_Model_Config;
+  Service_ModelConfigHash = HashFile(path);
 
   Trace_Push(&trace, path);
   e = ModelConfig_Validate(&trace, &Service_Model_Config);
@@ -115,6 +169,17 @@ Error* Service_Init() {
     );
     if (e)
       goto error;
+
+    FanConfiguration* fc = &Service_Model_Config.FanConfigurations.data[i];
+    Fan* fan = &Service_Fans.data[i].Fan;
+    e = Fan_Open(fan);
+    if (e)
+      goto error;
+
+    if (fan->speedFile.path)
+      Log_Info("Fan #%d (%s) reads its speed from '%s'\n", (int) i, fc->FanDisplayName, fan->speedFile.path);
+    if (fan->pwm.pwm.path)
+      Log_Info("Fan #%d (%s) writes its speed to '%s'\n", (int) i, fc->FanDisplayName, fan->pwm.pwm.path);
   }
 
   for_enumerate_array(ssize_t, i, service_state.TargetFanSpeeds) {
@@ -130,7 +195,16 @@ Error* Service_Init() {
   }
 
   // Embedded controller ======================================================
-  if (options.embedded_controller_type != EmbeddedControllerType_Unset) {
+  if (Reexec_Inherited) {
+    // Keep using the controller of the previous binary
+    ec = EC_By_EmbeddedControllerType(Reexec_Inherited->ec_type);
+    EC_InheritedFD = Reexec_Inherited->ec_fd;
+    if (! ec) {
+      e = err_string(0, "Inherited EmbeddedControllerType is not available");
+      goto error;
+    }
+  }
+  else if (options.embedded_controller_type != EmbeddedControllerType_Unset) {
     // --embedded-controller given
     ec = EC_By_EmbeddedControllerType(options.embedded_controller_type);;
   }
@@ -143,9 +217,10 @@ Error* Service_Init() {
       goto error;
   }
 
-  EmbeddedControllerType t = EmbeddedControllerType_By_EC(ec);
-  Log_Info("Using '%s' as EmbeddedControllerType\n", EmbeddedControllerType_ToString(t));
+  Service_ECType = EmbeddedControllerType_By_EC(ec);
+  Log_Info("Using '%s' as EmbeddedControllerType\n", EmbeddedControllerType_ToString(Service_ECType));
   e = ec->Open();
+  EC_InheritedFD = -1;
   if (e)
     goto error;
 
@@ -158,6 +233,12 @@ Error* Service_Init() {
 #endif
   }
 
+  // The critical watchdog writes to the EC from its own thread
+  if (! options.read_only) {
+    EC_Locked_Controller = ec;
+    ec = &EC_Locked_VTable;
+  }
+
   Service_State = Initialized_5_Embedded_Controller;
 
   // ACPI Call ================================================================
@@ -170,8 +251,11 @@ Error* Service_Init() {
   }
 
   // Register Write configurations ============================================
-  if (! options.read_only) {
-    e = ApplyRegisterWriteConfigurations(true);
+  // After a re-exec with the same model config they are already in the EC
+  const bool registers_written = Reexec_Inherited && ModelConfigUnchanged(Reexec_Inherited);
+
+  if (! options.read_only && ! registers_written) {
+    e = ApplyRegisterWriteConfigurations(true, NULL);
     if (e)
       goto error;
   }
@@ -184,6 +268,38 @@ Error* Service_Init() {
 
   FanTemperatureControl_Log(&Service_Fans, &Service_Model_Config);
 
+  // Load sensors =============================================================
+  OpenLoadSensors();
+
+  // State of a re-executed service ===========================================
+  if (Reexec_Inherited)
+    RestoreReexecState(Reexec_Inherited);
+
+  // Schedule =================================================================
+  memset(&Service_Schedule, 0, sizeof(Service_Schedule));
+  memset(&Service_Wakeups, 0, sizeof(Service_Wakeups));
+  Service_SuspendedTime = Service_GetSuspendedTime();
+  Service_PowerPolicy = PowerPolicy_Full;
+  Service_IntervalFactor = 1;
+  Service_TickInterval = min(
+    min(Service_Model_Config.TemperaturePollInterval, Service_Model_Config.FanSpeedReadInterval),
+    min(Service_Model_Config.RegisterWriteInterval, Service_Model_Config.FanWriteInterval));
+
+  if (Service_TickInterval != Service_Model_Config.EcPollInterval)
+    Log_Info("Intervals: temperatures %d ms, fan speed reads %d ms, register writes %d ms, fan writes %d ms\n",
+      Service_Model_Config.TemperaturePollInterval,
+      Service_Model_Config.FanSpeedReadInterval,
+      Service_Model_Config.RegisterWriteInterval,
+      Service_Model_Config.FanWriteInterval);
+
+  // Flight recorder ==========================================================
+  Service_FlightRecord = Mem_Calloc(1, FlightRecorder_RecordSize(Service_Fans.size));
+  e = FlightRecorder_Open(&Service_FlightRecorder, NBFC_FLIGHT_RECORDER_FILE, Service_Fans.size);
+  if (e) {
+    e = err_string(e, "Flight recorder disabled");
+    e_warn();
+  }
+
   return err_success();
 
 error:
@@ -191,42 +307,299 @@ error:
   return e;
 }
 
+// The control loop may run with a realtime priority while the server thread
+// doesn't, so the mutex uses priority inheritance.
+static void Service_InitMutex() {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+  pthread_mutex_init(&Service_Mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+// Serialize access to the service state between the control loop and the server
+void Service_Lock() {
+  pthread_once(&Service_MutexOnce, Service_InitMutex);
+  pthread_mutex_lock(&Service_Mutex);
+}
+
+void Service_Unlock() {
+  pthread_mutex_unlock(&Service_Mutex);
+}
+
+// How late the next tick started, recorded in the flight recorder
+void Service_SetTickLateness(uint32_t us) {
+  Service_TickLateness = us;
+}
+
+// How often Service_Loop() has to be called
+int Service_GetTickInterval() {
+  return Service_TickInterval * Service_IntervalFactor;
+}
+
+const char* Service_GetPowerPolicy() {
+  return PowerPolicy_ToString(Service_PowerPolicy);
+}
+
+// Count a wakeup of the service (a tick or a client request)
+void Service_CountWakeup() {
+  __atomic_add_fetch(&Service_Wakeups.count, 1, __ATOMIC_RELAXED);
+}
+
+// Wakeups per minute, averaged over the last minute
+float Service_GetWakeupsPerMinute() {
+  if (Service_Wakeups.have_rate)
+    return Service_Wakeups.per_minute;
+
+  // Less than a minute has passed, extrapolate
+  const uint64_t elapsed = FlightRecorder_Now() - Service_Wakeups.window_start;
+  const uint64_t count = __atomic_load_n(&Service_Wakeups.count, __ATOMIC_RELAXED) - Service_Wakeups.window_count;
+  return elapsed ? count * 60e6 / elapsed : 0;
+}
+
+static void Service_UpdateWakeups(uint64_t now) {
+  const uint64_t count = __atomic_load_n(&Service_Wakeups.count, __ATOMIC_RELAXED);
+
+  if (! Service_Wakeups.window_start) {
+    Service_Wakeups.window_start = now;
+    Service_Wakeups.window_count = count;
+  }
+  else if (now - Service_Wakeups.window_start >= 60000000) {
+    Service_Wakeups.per_minute = (count - Service_Wakeups.window_count) * 60e6 / (now - Service_Wakeups.window_start);
+    Service_Wakeups.have_rate = true;
+    Service_Wakeups.window_start = now;
+    Service_Wakeups.window_count = count;
+  }
+}
+
+static int64_t Service_GetSuspendedTime() {
+  struct timespec boottime, monotonic;
+  clock_gettime(CLOCK_BOOTTIME, &boottime);
+  clock_gettime(CLOCK_MONOTONIC, &monotonic);
+  return (int64_t) (boottime.tv_sec - monotonic.tv_sec) * 1000000
+    + (boottime.tv_nsec - monotonic.tv_nsec) / 1000;
+}
+
+// Returns true if the system has been suspended since the last call
+static bool Service_CheckResume() {
+  const int64_t suspended = Service_GetSuspendedTime();
+  const int64_t delta = suspended - Service_SuspendedTime;
+  Service_SuspendedTime = suspended;
+
+  if (delta < SERVICE_SUSPEND_THRESHOLD)
+    return false;
+
+  Log_Info("Resumed after %.1f seconds of suspend, re-initializing\n", delta / 1e6);
+  return true;
+}
+
+// The EC may have lost its registers and the temperatures are outdated:
+// run all phases now, re-apply the register writes, write all fans and
+// start the temperature filters from scratch.
+static void Service_PrepareResync() {
+  memset(&Service_Schedule, 0, sizeof(Service_Schedule));
+
+  for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
+    TemperatureFilter_Reset(&ftc->TemperatureFilter);
+    ftc->AppliedTemperature = NAN;
+    ftc->Fan.lastWrittenValue = -1;
+  }
+
+  for (range(int, i, 0, LoadSource_Unset))
+    LoadSensor_Reset(&Service_LoadSensors[i]);
+}
+
+static void Service_UpdatePowerPolicy() {
+  const PowerPolicy policy = PowerPolicy_Detect();
+  if (policy == Service_PowerPolicy)
+    return;
+
+  Service_PowerPolicy = policy;
+  Service_IntervalFactor = (policy == PowerPolicy_PowerSave) ? service_config.PowerSaveIntervalFactor : 1;
+
+  // The temperatures are sampled less often now
+  for_each_array(FanTemperatureControl*, ftc, Service_Fans)
+    TemperatureFilter_SetSampleInterval(&ftc->TemperatureFilter,
+      Service_Model_Config.TemperaturePollInterval * Service_IntervalFactor);
+
+  Log_Info("Power policy: %s\n", PowerPolicy_ToString(policy));
+}
+
+// Returns true if a phase with a period of `period` microseconds is due at `now`
+// and schedules its next run. Ticks may start slightly early or late, so phases
+// due within half a tick are run.
+static bool Service_DueEvery(uint64_t* next, uint64_t period, uint64_t now) {
+  const uint64_t tolerance = Service_GetTickInterval() * 1000 / 2;
+
+  if (now + tolerance < *next)
+    return false;
+
+  *next += period;
+  if (*next <= now + tolerance)
+    *next = now + period;
+
+  return true;
+}
+
+// Same for an `interval` in milliseconds, which is stretched by the power policy
+static bool Service_Due(uint64_t* next, int interval, uint64_t now) {
+  return Service_DueEvery(next, interval * Service_IntervalFactor * 1000, now);
+}
+
 Error* Service_Loop() {
   Error* e = err_success();
+  FlightRecorder_Record* record = Service_FlightRecord;
+  const uint64_t start = FlightRecorder_Now();
+  uint64_t phase_start = start;
+  int ec_writes = 0;
 
-  bool re_init_required = false;
-  for_each_array(FanTemperatureControl*, f, Service_Fans) {
-    e = Fan_UpdateCurrentSpeed(&f->Fan);
-    if (e)
-      goto error;
+  record->flags = 0;
+  memset(record->duration, 0, sizeof(record->duration));
+
+  Service_CountWakeup();
+  Service_UpdateWakeups(start);
+
+  const bool resumed = Service_CheckResume();
+  if (resumed) {
+    record->flags |= FlightRecorder_Resume;
+    Service_PrepareResync();
+  }
+
+  // Not stretched in power save, or leaving it would take longer
+  if (Service_DueEvery(&Service_Schedule.power_policy, POWER_POLICY_CHECK_INTERVAL * 1000, start))
+    Service_UpdatePowerPolicy();
+
+  const bool power_save = (Service_PowerPolicy == PowerPolicy_PowerSave);
+  if (power_save)
+    record->flags |= FlightRecorder_PowerSave;
 
-    // Re-init if current fan speeds are off by more than 15%
-    if (fabs(Fan_GetCurrentSpeed(&f->Fan) - Fan_GetTargetSpeed(&f->Fan)) > 15) {
-      re_init_required = true;
-      Log_Debug("re_init_required = 1;\n");
+#define Service_EndPhase(PHASE) do {                          \
+    const uint64_t now = FlightRecorder_Now();                \
+    record->duration[FlightRecorder_Phase_ ## PHASE] = now - phase_start; \
+    phase_start = now;                                        \
+  } while (0)
+
+  bool re_init_required = resumed;
+  if (Service_Due(&Service_Schedule.read_speeds, Service_Model_Config.FanSpeedReadInterval, start)) {
+    for_each_array(FanTemperatureControl*, f, Service_Fans) {
+      e = Fan_UpdateCurrentSpeed(&f->Fan);
+      if (e)
+        goto error;
+
+      // The RPM of a ReadHwmonFile doesn't map linearly to the written value,
+      // so its deviation from the target says nothing about the EC state
+      if (f->Fan.speedFile.path)
+        continue;
+
+      // Re-init if current fan speeds are off by more than 15%. Compare with
+      // what is in the EC, a lower target may still be held back in power save.
+      const float written_speed = (f->Fan.lastWrittenValue >= 0)
+        ? f->Fan.lastWrittenSpeed
+        : Fan_GetTargetSpeed(&f->Fan);
+
+      if (fabs(Fan_GetCurrentSpeed(&f->Fan) - written_speed) > 15) {
+        re_init_required = true;
+        Log_Debug("re_init_required = 1;\n");
+      }
     }
   }
 
-  if (! options.read_only) {
-    e = ApplyRegisterWriteConfigurations(re_init_required);
+  Service_EndPhase(ReadSpeeds);
+
+  if (re_init_required)
+    record->flags |= FlightRecorder_ReInit;
+
+  const bool registers_due = Service_Due(&Service_Schedule.register_writes, Service_Model_Config.RegisterWriteInterval, start);
+  if (! options.read_only && (registers_due || re_init_required)) {
+    e = ApplyRegisterWriteConfigurations(re_init_required, &ec_writes);
     if (e)
       goto error;
   }
 
-  for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
-    e = FanTemperatureControl_UpdateFanTemperature(ftc);
-    if (e)
-      goto error;
+  Service_EndPhase(RegisterWrites);
+
+  if (Service_Due(&Service_Schedule.temperatures, Service_Model_Config.TemperaturePollInterval, start)) {
+    UpdateLoadSensors();
+
+    for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
+      e = FanTemperatureControl_UpdateFanTemperature(ftc);
+      if (e)
+        goto error;
+
+      if (ftc->LoadFeedforward > 0)
+        FanTemperatureControl_SetLoad(ftc, LoadSensor_GetLoad(&Service_LoadSensors[ftc->LoadSource]));
+
+      // In power save mode small temperature changes are ignored, except near the critical temperature
+      float temperature = ftc->PredictedTemperature;
+      if (power_save
+          && fabs(temperature - ftc->AppliedTemperature) < service_config.PowerSaveHysteresis
+          && temperature < ftc->Fan.criticalTemperature - ftc->Fan.criticalTemperatureOffset)
+        temperature = ftc->AppliedTemperature;
+
+      ftc->AppliedTemperature = temperature;
+      Fan_SetTemperature(&ftc->Fan, ftc->Temperature, temperature);
+
+      // The watchdog has already set the fan to 100%, keep it there
+      if (CriticalWatchdog_IsCritical(ftc - Service_Fans.data))
+        ftc->Fan.isCritical = true;
+    }
+  }
+
+  Service_EndPhase(Temperatures);
+
+  // Fan speeds are written when they change, and periodically in case the
+  // firmware has overwritten them.
+  const bool refresh = Service_Due(&Service_Schedule.write_speeds, Service_Model_Config.FanWriteInterval, start);
+  if (! options.read_only) {
+    for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
+      if (! refresh && ! re_init_required) {
+        if (! Fan_NeedsFlush(&ftc->Fan))
+          continue;
+
+        // In power save mode lower speeds are coalesced into the next refresh
+        if (power_save && ftc->Fan.lastWrittenValue >= 0
+            && Fan_GetTargetSpeed(&ftc->Fan) < ftc->Fan.lastWrittenSpeed)
+          continue;
+      }
 
-    Fan_SetTemperature(&ftc->Fan, ftc->Temperature);
-    if (! options.read_only) {
       e = Fan_ECFlush(&ftc->Fan);
       if (e)
         goto error;
+      ec_writes++;
     }
   }
 
+  Service_EndPhase(WriteSpeeds);
+
+#undef Service_EndPhase
+
 error:
+  if (e)
+    record->flags |= FlightRecorder_Error;
+
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  record->timestamp = (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+  record->total = FlightRecorder_Now() - start;
+  record->lateness = Service_TickLateness;
+  record->ec_writes = ec_writes;
+  record->fans = Service_Fans.size;
+
+  for_enumerate_array(int, i, Service_Fans) {
+    const FanTemperatureControl* ftc = &Service_Fans.data[i];
+    FlightRecorder_Fan* fan = &record->fan[i];
+    fan->raw_temperature = ftc->RawTemperature;
+    fan->temperature     = ftc->Temperature;
+    fan->predicted_temperature = ftc->PredictedTemperature;
+    fan->load_bias       = ftc->LoadBias;
+    fan->target_speed    = Fan_GetTargetSpeed(&ftc->Fan);
+    fan->current_speed   = Fan_GetCurrentSpeed(&ftc->Fan);
+    fan->threshold       = ftc->Fan.threshMan.current;
+    fan->mode            = ftc->Fan.mode;
+    fan->critical        = ftc->Fan.isCritical;
+  }
+
+  FlightRecorder_Write(&Service_FlightRecorder, record);
   return e;
 }
 
@@ -264,6 +637,197 @@ static EC_VTable* EC_By_EmbeddedControllerType(EmbeddedControllerType t) {
   }
 }
 
+// Open the load sensors used by the fans' LoadFeedforward.
+// If CPU pressure information isn't available, fall back to the CPU utilization.
+static void OpenLoadSensors() {
+  Error* e;
+
+  for (range(int, i, 0, LoadSource_Unset))
+    Service_LoadSensors[i].fd = -1;
+
+  for_each_array(FanTemperatureControl*, ftc, Service_Fans) {
+    if (ftc->LoadFeedforward <= 0)
+      continue;
+
+    LoadSensor* sensor = &Service_LoadSensors[ftc->LoadSource];
+    if (sensor->fd >= 0)
+      continue;
+
+    e = LoadSensor_Open(sensor, ftc->LoadSource, NBFC_LOAD_SENSOR_TIMESPAN);
+    if (e && ftc->LoadSource == LoadSource_Pressure) {
+      e = err_string(e, "Falling back to CPU utilization");
+      e_warn();
+      ftc->LoadSource = LoadSource_Utilization;
+      sensor = &Service_LoadSensors[LoadSource_Utilization];
+      e = (sensor->fd >= 0) ? err_success() : LoadSensor_Open(sensor, LoadSource_Utilization, NBFC_LOAD_SENSOR_TIMESPAN);
+    }
+
+    if (e) {
+      e_warn();
+      ftc->LoadFeedforward = 0;
+    }
+  }
+}
+
+// A failing sensor is logged once when it fails and once when it recovers,
+// not on every poll
+static void UpdateLoadSensors() {
+  Error* e;
+
+  for (range(int, i, 0, LoadSource_Unset)) {
+    LoadSensor* sensor = &Service_LoadSensors[i];
+    if (sensor->fd < 0)
+      continue;
+
+    e = LoadSensor_Update(sensor);
+    if (e && ! sensor->failing) {
+      e = err_stringf(e, "LoadSource %s", LoadSource_ToString(i));
+      e_warn();
+    }
+    else if (! e && sensor->failing)
+      Log_Info("LoadSource %s: Working again\n", LoadSource_ToString(i));
+
+    sensor->failing = (e != NULL);
+  }
+}
+
+// Collect the state that is handed over to a re-executed service.
+// The caller frees it with Reexec_Free().
+void Service_GetReexecState(Reexec_State* state) {
+  state->config_id = Mem_Strdup(service_config.SelectedConfigId);
+  state->config_hash = Service_ModelConfigHash;
+  state->ec_type = Service_ECType;
+  state->ec_fd = ec->GetFD();
+  state->fans.size = Service_Fans.size;
+  state->fans.data = Mem_Calloc(Service_Fans.size, sizeof(Reexec_Fan));
+
+  for_enumerate_array(int, i, Service_Fans) {
+    const FanTemperatureControl* ftc = &Service_Fans.data[i];
+    const TemperatureFilter* filter = &ftc->TemperatureFilter;
+    const Fan* fan = &ftc->Fan;
+    Reexec_Fan* f = &state->fans.data[i];
+
+    f->threshold           = fan->threshMan.current;
+    f->critical            = fan->isCritical;
+    f->last_written_value  = fan->lastWrittenValue;
+    f->last_written_speed  = fan->lastWrittenSpeed;
+    f->current_speed       = fan->currentSpeed;
+    f->temperature         = ftc->Temperature;
+    f->applied_temperature = ftc->AppliedTemperature;
+    f->load_bias           = ftc->LoadBias;
+    f->pwm_path            = fan->pwm.pwm.path ? Mem_Strdup(fan->pwm.pwm.path) : NULL;
+    f->pwm_mode            = fan->pwm.manual ? fan->pwm.mode : -1;
+
+    // Oldest first
+    const ssize_t n      = filter->buffer_is_full ? filter->ring_buffer.size : filter->index;
+    const ssize_t oldest = filter->buffer_is_full ? filter->index : 0;
+    f->temperatures.size = n;
+    f->temperatures.data = Mem_Calloc(n ? n : 1, sizeof(float));
+    for (range(ssize_t, j, 0, n))
+      f->temperatures.data[j] = filter->ring_buffer.data[(oldest + j) % filter->ring_buffer.size];
+  }
+}
+
+// The previous binary may have switched pwmN_enable to manual. The original
+// mode is taken over by the fan that still writes the same pwmN, even if the
+// model config has changed. Otherwise the pwmN is handed back to the driver.
+static void RestoreReexecPwmModes(const Reexec_State* state) {
+  for_each_array(const Reexec_Fan*, f, state->fans) {
+    if (! f->pwm_path || f->pwm_mode < 0)
+      continue;
+
+    HwmonPwm* pwm = NULL;
+    for_each_array(FanTemperatureControl*, ftc, Service_Fans)
+      if (ftc->Fan.pwm.enable.path && ! strcmp(ftc->Fan.pwm.pwm.path, f->pwm_path))
+        pwm = &ftc->Fan.pwm;
+
+    if (pwm && ! options.read_only) {
+      pwm->mode   = f->pwm_mode;
+      pwm->manual = true;
+      continue;
+    }
+
+    char enable[PATH_MAX];
+    HwmonFile file;
+    snprintf(enable, sizeof(enable), "%s_enable", f->pwm_path);
+    Error* e = HwmonFile_Open(&file, enable, O_RDWR);
+    if (! e) {
+      e = HwmonFile_Write(&file, f->pwm_mode);
+      HwmonFile_Close(&file);
+    }
+    e_warn();
+  }
+}
+
+// FNV-1a of the file content, 0 if it can't be read
+static uint64_t HashFile(const char* file) {
+  char content[NBFC_MAX_FILE_SIZE];
+  const ssize_t size = slurp_file(content, sizeof(content), file);
+  if (size < 0)
+    return 0;
+
+  uint64_t hash = 14695981039346656037ULL;
+  for (range(ssize_t, i, 0, size))
+    hash = (hash ^ (unsigned char) content[i]) * 1099511628211ULL;
+  return hash;
+}
+
+// The same id may refer to an edited file, so the content is compared too
+static bool ModelConfigUnchanged(const Reexec_State* state) {
+  return Service_ModelConfigHash
+    && state->config_hash == Service_ModelConfigHash
+    && ! strcmp(state->config_id, service_config.SelectedConfigId);
+}
+
+// Continue where the previous binary stopped. The state is only used if the
+// model config is still the same.
+static void RestoreReexecState(const Reexec_State* state) {
+  RestoreReexecPwmModes(state);
+
+  if (! ModelConfigUnchanged(state) || state->fans.size != Service_Fans.size) {
+    Log_Info("Model config has changed, not restoring the fan state\n");
+    return;
+  }
+
+  for_enumerate_array(int, i, Service_Fans) {
+    FanTemperatureControl* ftc = &Service_Fans.data[i];
+    const Reexec_Fan* f = &state->fans.data[i];
+    Fan* fan = &ftc->Fan;
+
+    // Only the last temperatures fit if the filter has become smaller
+    const ssize_t skip = max(0, f->temperatures.size - ftc->TemperatureFilter.ring_buffer.size);
+    for (range(ssize_t, j, skip, f->temperatures.size))
+      TemperatureFilter_FilterTemperature(&ftc->TemperatureFilter, f->temperatures.data[j]);
+
+    ftc->Temperature        = f->temperature;
+    ftc->AppliedTemperature = f->applied_temperature;
+
+    if (! isnan(f->load_bias)) {
+      ftc->LoadBias = f->load_bias;
+      Fan_SetLoadBias(fan, f->load_bias);
+    }
+
+    if (f->threshold >= 0 && f->threshold < fan->threshMan.thresholds.size)
+      fan->threshMan.current = f->threshold;
+
+    if (fan->mode == Fan_ModeAuto)
+      Fan_SetAutoSpeed(fan);
+
+    fan->isCritical       = f->critical;
+    fan->currentSpeed     = f->current_speed;
+    fan->lastWrittenValue = f->last_written_value;
+    fan->lastWrittenSpeed = f->last_written_speed;
+
+    // The mode of pwmN_enable has been taken over by RestoreReexecPwmModes()
+    if (fan->pwm.pwm.path) {
+      fan->pwm.value = f->last_written_value;
+      fan->pwm.valid = (f->last_written_value >= 0);
+    }
+  }
+
+  Log_Info("Restored the fan state of the previous binary\n");
+}
+
 static void ResetEC() {
   Error* e;
   bool failed = false;
@@ -356,11 +920,14 @@ static Error* ApplyRegisterWriteConfig(RegisterWriteConfiguration* cfg) {
   }
 }
 
-static Error* ApplyRegisterWriteConfigurations(bool initializing) {
+// `writes` (optional) is incremented for each applied configuration
+static Error* ApplyRegisterWriteConfigurations(bool initializing, int* writes) {
   for_each_array(RegisterWriteConfiguration*, cfg, Service_Model_Config.RegisterWriteConfigurations) {
     if (initializing || cfg->WriteOccasion == RegisterWriteOccasion_OnWriteFanSpeed) {
        Error* e = ApplyRegisterWriteConfig(cfg);
        e_check();
+       if (writes)
+         ++*writes;
     }
   }
   return err_success();
@@ -405,10 +972,17 @@ void Service_WriteTargetFanSpeedsToState() {
 }
 
 void Service_Cleanup() {
+  CriticalWatchdog_Stop();
+
   switch (Service_State) {
     case Initialized_6_Temperature_Filter:
+      FlightRecorder_Close(&Service_FlightRecorder);
+      Mem_Free(Service_FlightRecord);
+      Service_FlightRecord = NULL;
       for_each_array(FanTemperatureControl*, ftc, Service_Fans)
         TemperatureFilter_Close(&ftc->TemperatureFilter);
+      for (range(int, i, 0, LoadSource_Unset))
+        LoadSensor_Close(&Service_LoadSensors[i]);
       /* fall through */
     case Initialized_5_Embedded_Controller:
       if (! options.read_only)
@@ -416,6 +990,8 @@ void Service_Cleanup() {
       ec->Close();
       /* fall through */
     case Initialized_4_Fans:
+      for_each_array(FanTemperatureControl*, ftc, Service_Fans)
+        Fan_Close(&ftc->Fan);
       Mem_Free(Service_Fans.data);
       /* fall through */
     case Initialized_3_Sensors:
@@ -6,9 +6,12 @@
 #include "fan.h"
 #include "fan_temperature_control.h"
 #include "model_config.h"
+#include "realtime.h"
+#include "reexec.h"
 #include "temperature_filter.h"
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <linux/limits.h>
 
 typedef struct Service_Options Service_Options;
@@ -17,6 +20,9 @@ struct Service_Options {
   bool                   fork;
   bool                   read_only;
   bool                   debug;
+  int                    realtime_priority; // 0 if disabled
+  int                    realtime_policy;   // SCHED_FIFO or SCHED_RR
+  Realtime_CPUSet        cpu_affinity;
   char                   service_config[PATH_MAX];
 };
 
@@ -28,5 +34,13 @@ Error* Service_Init();
 Error* Service_Loop();
 void   Service_Cleanup();
 void   Service_WriteTargetFanSpeedsToState();
+void   Service_GetReexecState(Reexec_State*);
+void   Service_Lock();
+void   Service_Unlock();
+void   Service_SetTickLateness(uint32_t);
+int    Service_GetTickInterval();
+const char* Service_GetPowerPolicy();
+void   Service_CountWakeup();
+float  Service_GetWakeupsPerMinute();
 
 #endif
@@ -100,6 +100,12 @@ Error* ServiceConfig_Write(const char* file) {
       create_json_double(NULL, fanspeeds, *f);
   }
 
+  if (ServiceConfig_IsSet_PowerSaveIntervalFactor(&service_config))
+    create_json_double("PowerSaveIntervalFactor", o, service_config.PowerSaveIntervalFactor);
+
+  if (ServiceConfig_IsSet_PowerSaveHysteresis(&service_config))
+    create_json_double("PowerSaveHysteresis", o, service_config.PowerSaveHysteresis);
+
   if (service_config.FanTemperatureSources.size) {
     nx_json* fan_temperature_sources = create_json_array("FanTemperatureSources", o);
 
@@ -117,6 +123,15 @@ Error* ServiceConfig_Write(const char* file) {
           create_json_string(NULL, sensors, *sensor);
         }
       }
+
+      if (FanTemperatureSourceConfig_IsSet_LoadSource(ftsc))
+        create_json_string("LoadSource", fan_temperature_source, LoadSource_ToString(ftsc->LoadSource));
+
+      if (FanTemperatureSourceConfig_IsSet_LoadFeedforward(ftsc))
+        create_json_double("LoadFeedforward", fan_temperature_source, ftsc->LoadFeedforward);
+
+      if (FanTemperatureSourceConfig_IsSet_LoadThreshold(ftsc))
+        create_json_double("LoadThreshold", fan_temperature_source, ftsc->LoadThreshold);
     }
   }
 
@@ -13,9 +13,12 @@ Error* TemperatureFilter_Init(TemperatureFilter* self, int poll_interval, int ti
     return (errno = EINVAL), err_stdlib(0, "timespan");
 
   my.index = 0;
+  my.sum = 0;
   my.ring_buffer.size = timespan / poll_interval + !!(timespan % poll_interval);
   my.ring_buffer.data = (float*) Mem_Calloc(my.ring_buffer.size, sizeof(float));
   my.buffer_is_full = false;
+  my.poll_interval = poll_interval;
+  my.sample_interval = poll_interval;
   return err_success();
 }
 
@@ -32,6 +35,56 @@ float TemperatureFilter_FilterTemperature(TemperatureFilter* self, float tempera
   return my.sum / (my.buffer_is_full ? my.ring_buffer.size : my.index);
 }
 
+// The samples are taken less often than every poll_interval if the service
+// stretches its intervals (power save). Samples taken before the change are
+// treated as if they had the new spacing.
+void TemperatureFilter_SetSampleInterval(TemperatureFilter* self, float interval) {
+  my.sample_interval = interval;
+}
+
+// Least-squares slope of the temperatures in the ring, in degrees per second
+float TemperatureFilter_GetSlope(const TemperatureFilter* self) {
+  const ssize_t n = my.buffer_is_full ? my.ring_buffer.size : my.index;
+  const ssize_t oldest = my.buffer_is_full ? my.index : 0;
+
+  if (n < 2)
+    return 0;
+
+  // x = 0 .. n-1, from the oldest to the newest sample
+  const double mean_x = (n - 1) / 2.0;
+  const double mean_y = my.sum / n;
+  double sxy = 0, sxx = 0;
+
+  for (ssize_t i = 0; i < n; ++i) {
+    const double dx = i - mean_x;
+    sxy += dx * (my.ring_buffer.data[(oldest + i) % my.ring_buffer.size] - mean_y);
+    sxx += dx * dx;
+  }
+
+  return sxy / sxx * 1000.0 / my.sample_interval;
+}
+
+// Extrapolate a rising temperature `horizon` milliseconds ahead.
+// A falling trend is ignored, so fans don't slow down before it gets cooler.
+float TemperatureFilter_Predict(const TemperatureFilter* self, float temperature, int horizon) {
+  if (horizon <= 0)
+    return temperature;
+
+  const float slope = TemperatureFilter_GetSlope(self);
+  if (slope <= 0)
+    return temperature;
+
+  return temperature + slope * horizon / 1000.0f;
+}
+
+// Forget all previous temperatures
+void TemperatureFilter_Reset(TemperatureFilter* self) {
+  memset(my.ring_buffer.data, 0, my.ring_buffer.size * sizeof(float));
+  my.sum = 0;
+  my.index = 0;
+  my.buffer_is_full = false;
+}
+
 void TemperatureFilter_Close(TemperatureFilter* self) {
   Mem_Free(my.ring_buffer.data);
   memset(self, 0, sizeof(*self));
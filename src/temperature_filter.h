@@ -13,10 +13,16 @@ struct TemperatureFilter {
   array_of(float) ring_buffer;
   ssize_t         index;
   bool            buffer_is_full;
+  int             poll_interval;
+  float           sample_interval; // Milliseconds between two samples
 };
 
 Error* TemperatureFilter_Init(TemperatureFilter*, int poll_interval, int timespan);
 float  TemperatureFilter_FilterTemperature(TemperatureFilter*, float temperature);
+void   TemperatureFilter_SetSampleInterval(TemperatureFilter*, float interval);
+float  TemperatureFilter_GetSlope(const TemperatureFilter*);
+float  TemperatureFilter_Predict(const TemperatureFilter*, float temperature, int horizon);
+void   TemperatureFilter_Reset(TemperatureFilter*);
 void   TemperatureFilter_Close(TemperatureFilter*);
 
 #endif
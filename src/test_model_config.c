@@ -1,15 +1,20 @@
 #define _XOPEN_SOURCE 500 /* unistd.h: export pwrite()/pread(), string.h: export strdup */
+#define _DEFAULT_SOURCE   /* fcntl.h: O_CLOEXEC */
 
 #include <string.h>
 #include <locale.h>
 #include <getopt.h>
 #include <limits.h>
+#include <math.h>
+#include <stdio.h>
 
 #include "ec.h"
 #include "nbfc.h"
+#include "parse_number.h"
 #include "log.c"
 #include "error.c"
 #include "file_utils.c"
+#include "hwmon.c"
 #include "trace.c"
 #include "memory.c"
 #include "nxjson.c"
@@ -17,31 +22,46 @@
 #include "program_name.c"
 #include "fan.c"
 #include "temperature_threshold_manager.c"
+#include "temperature_filter.c"
 #include "stack_memory.c"
 
 EC_VTable* ec;
 
 int test_model_config(const char*);
+static int replay_trace(const char*, ModelConfig*);
 
 static struct option long_options[] = {
-  {"verbose", no_argument, 0, 'v'},
-  {0,         0,           0,  0 },
+  {"verbose", no_argument,       0, 'v'},
+  {"replay",  required_argument, 0, 'r'},
+  {"horizon", required_argument, 0, 'H'},
+  {0,         0,                 0,  0 },
 };
 
-static const char options_str[] = "v";
+static const char options_str[] = "vr:H:";
 
 static struct {
-  int verbose;
-} options = {0};
+  int         verbose;
+  const char* replay;
+  int         horizon;
+} options = {0, NULL, 3000};
 
 int main(int argc, char** argv) {
   Program_Name_Set(argv[0]);
   setlocale(LC_NUMERIC, "C"); // for json floats
 
   int o, option_index;
+  const char* err;
   while ((o = getopt_long(argc, argv, options_str, long_options, &option_index)) != -1) {
     switch (o) {
     case 'v': options.verbose = 1; break;
+    case 'r': options.replay = optarg; break;
+    case 'H':
+      options.horizon = parse_number(optarg, 0, INT_MAX, &err);
+      if (err) {
+        Log_Error("-H|--horizon: %s\n", err);
+        return NBFC_EXIT_CMDLINE;
+      }
+      break;
     default:  return NBFC_EXIT_CMDLINE;
     }
   }
@@ -112,7 +132,7 @@ int test_model_config(const char* file) {
     seen_0_speed   = false;
     seen_100_speed = false;
     for (int temp = 0; temp <= 100; ++temp) {
-      Fan_SetTemperature(&fan, temp);
+      Fan_SetTemperature(&fan, temp, temp);
       float speed = Fan_GetTargetSpeed(&fan);
       if (options.verbose)
         Log_Info("[%ld]: temp = %3d, speed = %f\n", i, temp, speed);
@@ -135,7 +155,7 @@ int test_model_config(const char* file) {
     seen_0_speed   = false;
     seen_100_speed = false;
     for (int temp = 100; temp >= 0; --temp) {
-      Fan_SetTemperature(&fan, temp);
+      Fan_SetTemperature(&fan, temp, temp);
       float speed = Fan_GetTargetSpeed(&fan);
       if (options.verbose)
         Log_Info("[%ld]: temp = %3d, speed = %f\n", i, temp, speed);
@@ -156,7 +176,184 @@ int test_model_config(const char* file) {
     }
   }
 
+  if (options.replay)
+    ret = replay_trace(options.replay, &model_config);
+
 end:
   ModelConfig_Free(&model_config);
   return ret;
 }
+
+/*
+ * Replay the raw temperatures of a trace recorded with `nbfc dump --csv`
+ * through the temperature filter and the thresholds of the model config,
+ * once without and once with temperature prediction.
+ *
+ * The trace doesn't tell how the temperature would have reacted to other
+ * fan speeds, so the result is compared against an ideal fan that follows
+ * the raw temperature without delay:
+ *   writes      Number of fan speed changes (EC writes)
+ *   lag         Integral of (ideal speed - speed) while below ideal, in %*s
+ *   peak        Highest raw temperature while the fan was below ideal
+ */
+
+#define REPLAY_MAX_LINE 8192
+
+typedef struct {
+  int    writes;
+  double lag;
+  float  peak;
+} Replay_Result;
+
+typedef struct {
+  double* time;        // Seconds
+  float*  temperature;
+  int     size;
+} Replay_Trace;
+
+static int replay_find_column(char* header, const char* name) {
+  int column = 0;
+  for (char* tok = strtok(header, ",\n"); tok; tok = strtok(NULL, ",\n"), ++column)
+    if (! strcmp(tok, name))
+      return column;
+  return -1;
+}
+
+static bool replay_load(const char* file, int fan, Replay_Trace* trace) {
+  char line[REPLAY_MAX_LINE], header[REPLAY_MAX_LINE], name[64];
+  int capacity = 0;
+
+  FILE* fh = fopen(file, "r");
+  if (! fh) {
+    Log_Error("%s: %s\n", file, strerror(errno));
+    return false;
+  }
+
+  if (! fgets(line, sizeof(line), fh)) {
+    Log_Error("%s: Empty file\n", file);
+    fclose(fh);
+    return false;
+  }
+
+  snprintf(name, sizeof(name), "fan%d_raw_temperature", fan);
+  memcpy(header, line, sizeof(line));
+  const int time_column = replay_find_column(header, "timestamp");
+  memcpy(header, line, sizeof(line));
+  const int temp_column = replay_find_column(header, name);
+
+  if (time_column < 0 || temp_column < 0) {
+    Log_Error("%s: Missing column 'timestamp' or '%s'\n", file, name);
+    fclose(fh);
+    return false;
+  }
+
+  memset(trace, 0, sizeof(*trace));
+
+  while (fgets(line, sizeof(line), fh)) {
+    double time = NAN;
+    float temperature = NAN;
+    int column = 0;
+
+    for (char* tok = strtok(line, ",\n"); tok; tok = strtok(NULL, ",\n"), ++column) {
+      if (column == time_column)
+        time = strtod(tok, NULL);
+      else if (column == temp_column)
+        temperature = strtof(tok, NULL);
+    }
+
+    if (isnan(time) || isnan(temperature))
+      continue;
+
+    if (trace->size == capacity) {
+      capacity = capacity ? capacity * 2 : 1024;
+      trace->time = Mem_Realloc(trace->time, capacity * sizeof(double));
+      trace->temperature = Mem_Realloc(trace->temperature, capacity * sizeof(float));
+    }
+
+    trace->time[trace->size] = time;
+    trace->temperature[trace->size] = temperature;
+    trace->size++;
+  }
+
+  fclose(fh);
+  return true;
+}
+
+static Replay_Result replay_run(const Replay_Trace* trace, FanConfiguration* cfg, ModelConfig* model_config, int poll_interval, int horizon) {
+  Error* e;
+  Replay_Result result = {0, 0, -INFINITY};
+  TemperatureFilter filter;
+  Fan fan, ideal;
+
+  e = Fan_Init(&fan, cfg, model_config);
+  e_die();
+  e = Fan_Init(&ideal, cfg, model_config);
+  e_die();
+  e = TemperatureFilter_Init(&filter, poll_interval, NBFC_TEMPERATURE_FILTER_TIMESPAN);
+  e_die();
+
+  float last_speed = -1;
+
+  for (int i = 0; i < trace->size; ++i) {
+    const float raw = trace->temperature[i];
+    const float filtered = TemperatureFilter_FilterTemperature(&filter, raw);
+
+    Fan_SetTemperature(&fan, filtered, TemperatureFilter_Predict(&filter, filtered, horizon));
+    Fan_SetTemperature(&ideal, raw, raw);
+
+    const float speed = Fan_GetTargetSpeed(&fan);
+    const float ideal_speed = Fan_GetTargetSpeed(&ideal);
+
+    if (speed != last_speed) {
+      result.writes++;
+      last_speed = speed;
+    }
+
+    if (speed < ideal_speed) {
+      if (i + 1 < trace->size)
+        result.lag += (ideal_speed - speed) * (trace->time[i + 1] - trace->time[i]);
+      result.peak = max(result.peak, raw);
+    }
+  }
+
+  TemperatureFilter_Close(&filter);
+  return result;
+}
+
+static int replay_trace(const char* file, ModelConfig* model_config) {
+  for_enumerate_array(int, i, model_config->FanConfigurations) {
+    Replay_Trace trace;
+
+    if (! replay_load(file, i, &trace))
+      return 1;
+
+    if (trace.size < 2) {
+      Log_Error("%s: Fan #%d: Not enough samples\n", file, i);
+      Mem_Free(trace.time);
+      Mem_Free(trace.temperature);
+      return 1;
+    }
+
+    const int poll_interval = max(1, (int) round(
+      (trace.time[trace.size - 1] - trace.time[0]) * 1000 / (trace.size - 1)));
+
+    printf("Fan #%d: %d samples, %d ms apart\n", i, trace.size, poll_interval);
+    printf("  %-12s  %6s  %10s  %8s\n", "horizon", "writes", "lag (%*s)", "peak");
+
+    const int horizons[] = { 0, options.horizon };
+    for (int h = 0; h < (int) ARRAY_SIZE(horizons); ++h) {
+      const Replay_Result r = replay_run(&trace, &model_config->FanConfigurations.data[i],
+        model_config, poll_interval, horizons[h]);
+
+      if (isinf(r.peak))
+        printf("  %9d ms  %6d  %10.1f  %8s\n", horizons[h], r.writes, r.lag, "-");
+      else
+        printf("  %9d ms  %6d  %10.1f  %6.2f°C\n", horizons[h], r.writes, r.lag, r.peak);
+    }
+
+    Mem_Free(trace.time);
+    Mem_Free(trace.temperature);
+  }
+
+  return 0;
+}
@@ -0,0 +1,239 @@
+#!/usr/bin/python3
+
+'''
+Test `nbfc update` against a local HTTP server that stands in for the GitHub API.
+
+A test build of `nbfc` is compiled into a temporary directory. It keeps its
+state below that directory instead of /var/lib/nbfc, takes the URLs from the
+environment and doesn't need root.
+
+Usage: test-update.py [path/to/nbfc-source]
+'''
+
+import io
+import os
+import sys
+import json
+import atexit
+import shutil
+import tarfile
+import tempfile
+import hashlib
+import threading
+import subprocess
+from urllib.parse import quote, unquote
+from http.server import HTTPServer, BaseHTTPRequestHandler
+
+SOURCE_DIR = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), '..')
+TEMP_DIR = tempfile.mkdtemp(prefix='nbfc-test-update.')
+atexit.register(shutil.rmtree, TEMP_DIR, ignore_errors=True)
+
+NBFC = TEMP_DIR + '/nbfc'
+MUTABLE_DIR = TEMP_DIR + '/var/lib/nbfc'
+CONFIGS_DIR = MUTABLE_DIR + '/configs'
+MANIFEST = MUTABLE_DIR + '/update_manifest'
+
+def build_nbfc():
+    subprocess.run([
+        os.environ.get('CC', 'cc'),
+        '-DNBFC_UPDATE_TEST',
+        '-DNBFC_MUTABLE_DIR="%s"' % MUTABLE_DIR,
+        '-DSYSCONFDIR="%s/etc"' % TEMP_DIR,
+        '-DDATADIR="%s/share"' % TEMP_DIR,
+        '-DRUNSTATEDIR="%s/run"' % TEMP_DIR,
+        '-DVERSION="test"',
+        os.path.join(SOURCE_DIR, 'src/client.c'),
+        '-o', NBFC,
+        '-ldl', '-lpthread'
+    ], check=True)
+
+def git_sha1(content):
+    return hashlib.sha1(b'blob %d\0' % len(content) + content).hexdigest()
+
+class Repository:
+    def __init__(self):
+        self.files = {}
+        self.model_support = b'{"Test Model 1": "Test Config 1"}'
+        self.requests = []
+
+    def set_file(self, name, content):
+        self.files[name] = content.encode('utf-8')
+
+    def downloads(self):
+        return sorted(unquote(r[len('/raw/'):]) for r, status in self.requests if r.startswith('/raw/'))
+
+    def status(self, path):
+        return [status for r, status in self.requests if r == path]
+
+    def archive(self):
+        # Mimic the layout of GitHub's tarballs, including a pax global header
+        buf = io.BytesIO()
+        with tarfile.open(fileobj=buf, mode='w:gz', format=tarfile.PAX_FORMAT,
+                          pax_headers={'comment': '0123456789abcdef'}) as tar:
+            def add(name, content=None):
+                info = tarfile.TarInfo(name)
+                if content is None:
+                    info.type = tarfile.DIRTYPE
+                    tar.addfile(info)
+                else:
+                    info.size = len(content)
+                    tar.addfile(info, io.BytesIO(content))
+
+            add('configs-main')
+            add('configs-main/README.md', b'README')
+            add('configs-main/1.0')
+            add('configs-main/1.0/model_support.json', self.model_support)
+            add('configs-main/1.0/configs')
+            for name, content in self.files.items():
+                add('configs-main/1.0/configs/' + name, content)
+        return buf.getvalue()
+
+REPOSITORY = Repository()
+
+class Handler(BaseHTTPRequestHandler):
+    def log_message(self, *args):
+        pass
+
+    def send(self, code, content=b'', headers={}):
+        self.send_response(code)
+        for key, value in headers.items():
+            self.send_header(key, value)
+        self.send_header('Content-Length', str(len(content)))
+        self.end_headers()
+        self.wfile.write(content)
+
+    def send_cached(self, content):
+        etag = '"%s"' % hashlib.sha1(content).hexdigest()
+        if self.headers.get('If-None-Match') == etag:
+            self.send(304, headers={'ETag': etag})
+        else:
+            self.send(200, content, headers={'ETag': etag})
+
+    def send_response(self, code, *args):
+        REPOSITORY.requests.append((self.path, code))
+        super().send_response(code, *args)
+
+    def do_GET(self):
+        host = 'http://%s:%d' % self.server.server_address
+
+        if self.path == '/contents':
+            listing = [{
+                'name': name,
+                'sha': git_sha1(content),
+                'download_url': '%s/raw/%s' % (host, quote(name))
+            } for name, content in REPOSITORY.files.items()]
+            self.send_cached(json.dumps(listing).encode('utf-8'))
+        elif self.path == '/model_support.json':
+            self.send_cached(REPOSITORY.model_support)
+        elif self.path == '/archive.tar.gz':
+            self.send(200, REPOSITORY.archive())
+        elif self.path.startswith('/raw/'):
+            name = unquote(self.path[len('/raw/'):])
+            if name in REPOSITORY.files:
+                self.send(200, REPOSITORY.files[name])
+            else:
+                self.send(404)
+        else:
+            self.send(404)
+
+def run_update(*args):
+    REPOSITORY.requests = []
+    env = dict(os.environ)
+    env['NBFC_UPDATE_CONTENTS_URL'] = '%s/contents' % URL
+    env['NBFC_UPDATE_MODEL_SUPPORT_URL'] = '%s/model_support.json' % URL
+    env['NBFC_UPDATE_ARCHIVE_URL'] = '%s/archive.tar.gz' % URL
+    result = subprocess.run([NBFC, 'update', *args], env=env, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise Exception('nbfc update failed: %s' % result.stderr)
+    return result.stderr
+
+def extracted(output):
+    return sorted(line.split('Extracted ', 1)[1] for line in output.splitlines() if 'Extracted ' in line)
+
+def read_file(path):
+    with open(path, 'rb') as fh:
+        return fh.read()
+
+def expect(what, got, expected):
+    if got != expected:
+        raise Exception('%s: Expected: %s, Got: %s' % (what, expected, got))
+    print('OK: %s' % what)
+
+build_nbfc()
+os.makedirs(CONFIGS_DIR)
+os.makedirs(TEMP_DIR + '/share/nbfc/configs')
+
+server = HTTPServer(('127.0.0.1', 0), Handler)
+URL = 'http://127.0.0.1:%d' % server.server_address[1]
+threading.Thread(target=server.serve_forever, daemon=True).start()
+
+for i in range(20):
+    REPOSITORY.set_file('Test Config %d.json' % i, '{"NotebookModel": "Test Config %d"}' % i)
+
+# Initial update downloads all files
+run_update('-q')
+expect('initial download', len(REPOSITORY.downloads()), 20)
+expect('manifest written', os.path.exists(MANIFEST), True)
+with open(MANIFEST, 'r') as fh:
+    expect('manifest entries', len(fh.readlines()), 20)
+
+# Nothing changed
+output = run_update('-q')
+expect('no downloads', REPOSITORY.downloads(), [])
+expect('summary', 'New files: 0   Files changed: 0' in output, True)
+expect('listing not modified', REPOSITORY.status('/contents'), [304])
+expect('model support not modified', REPOSITORY.status('/model_support.json'), [304])
+
+# Model support database changed
+REPOSITORY.model_support = b'{"Test Model 2": "Test Config 2"}'
+run_update('-q')
+expect('model support modified', REPOSITORY.status('/model_support.json'), [200])
+expect('model support written', read_file(MUTABLE_DIR + '/model_support.json'), REPOSITORY.model_support)
+
+# One remote file changed
+REPOSITORY.set_file('Test Config 3.json', '{"NotebookModel": "Changed"}')
+run_update('-q')
+expect('changed remote file', REPOSITORY.downloads(), ['Test Config 3.json'])
+
+# One local file changed (size and mtime differ from the manifest)
+with open(CONFIGS_DIR + '/Test Config 5.json', 'w') as fh:
+    fh.write('{"NotebookModel": "Locally modified"}')
+run_update('-q')
+expect('changed local file', REPOSITORY.downloads(), ['Test Config 5.json'])
+
+# Duplicate paths in the manifest
+with open(MANIFEST, 'r') as fh:
+    lines = fh.readlines()
+with open(MANIFEST, 'w') as fh:
+    fh.writelines(lines[:1] + lines)
+run_update('-q')
+expect('duplicate manifest entries', REPOSITORY.downloads(), [])
+with open(MANIFEST, 'r') as fh:
+    expect('duplicates dropped', len(fh.readlines()), 20)
+
+# Broken manifest is ignored
+with open(MANIFEST, 'w') as fh:
+    fh.write('garbage\n')
+run_update('-q')
+expect('broken manifest', REPOSITORY.downloads(), [])
+
+# Archive mode: Nothing changed
+output = run_update('-a')
+expect('archive: nothing extracted', extracted(output), [])
+expect('archive: only one request', [r for r, status in REPOSITORY.requests], ['/archive.tar.gz'])
+
+# Archive mode: Changed and new files (including a name that needs a pax header)
+long_name = 'Test Config With A Very Long Name ' + 'X' * 100 + '.json'
+REPOSITORY.set_file('Test Config 7.json', '{"NotebookModel": "Changed in archive"}')
+REPOSITORY.set_file(long_name, '{"NotebookModel": "Long"}')
+REPOSITORY.model_support = b'{"Test Model 3": "Test Config 3"}'
+output = run_update('-a')
+expect('archive: extracted', extracted(output), sorted([long_name, 'Test Config 7.json']))
+expect('archive: content', read_file(CONFIGS_DIR + '/' + long_name), REPOSITORY.files[long_name])
+expect('archive: model support', read_file(MUTABLE_DIR + '/model_support.json'), REPOSITORY.model_support)
+
+# Listing mode agrees with the archive mode
+run_update('-q')
+expect('listing after archive', REPOSITORY.downloads(), [])
+
+server.shutdown()